@@ -56,6 +56,16 @@
 /* Application specific configuration options. */
 #include "FreeRTOSConfig.h"
 
+/* Must be defaulted before portable.h is included, the port uses it to select
+ * between its single core and SMP implementations. */
+#ifndef configNUMBER_OF_CORES
+    #define configNUMBER_OF_CORES    1
+#endif
+
+#ifndef configUSE_CORE_AFFINITY
+    #define configUSE_CORE_AFFINITY    0
+#endif
+
 /* Basic FreeRTOS definitions. */
 #include "projdefs.h"
 
@@ -1209,6 +1219,12 @@ typedef struct xSTATIC_TCB
     #if ( configUSE_POSIX_ERRNO == 1 )
         int iDummy22;
     #endif
+    #if ( configNUMBER_OF_CORES > 1 )
+        BaseType_t xDummy23[ 2 ];
+        #if ( configUSE_CORE_AFFINITY == 1 )
+            UBaseType_t uxDummy24;
+        #endif
+    #endif
 } StaticTask_t;
 
 /*
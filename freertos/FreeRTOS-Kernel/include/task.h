@@ -170,6 +170,13 @@ typedef enum
  */
 #define tskIDLE_PRIORITY    ( ( UBaseType_t ) 0U )
 
+/**
+ * Defines affinity to all available cores.
+ *
+ * \ingroup TaskUtils
+ */
+#define tskNO_AFFINITY      ( ( UBaseType_t ) -1 )
+
 /**
  * task. h
  *
@@ -1073,6 +1080,58 @@ void vTaskGetInfo( TaskHandle_t xTask,
 void vTaskPrioritySet( TaskHandle_t xTask,
                        UBaseType_t uxNewPriority ) PRIVILEGED_FUNCTION;
 
+#if ( ( configNUMBER_OF_CORES > 1 ) && ( configUSE_CORE_AFFINITY == 1 ) )
+
+/**
+ * task. h
+ * <pre>
+ * void vTaskCoreAffinitySet( const TaskHandle_t xTask, UBaseType_t uxCoreAffinityMask );
+ * </pre>
+ *
+ * configNUMBER_OF_CORES must be greater than 1 and configUSE_CORE_AFFINITY
+ * must be defined as 1 for this function to be available.
+ *
+ * Sets the core affinity mask for a task, i.e. the cores on which a task can
+ * run.  Bit n of the mask set to 1 allows the task to run on core n.  If the
+ * task is currently running on a core that is no longer allowed, that core is
+ * made to yield.
+ *
+ * @param xTask The handle of the task to set the core affinity mask for.
+ * Passing NULL will set the core affinity mask for the calling task.
+ *
+ * @param uxCoreAffinityMask A bitwise value that indicates the cores on which
+ * the task can run, or tskNO_AFFINITY to allow it to run on any core.
+ *
+ * Example usage:
+ * <pre>
+ * // Pin the calling task to core 1.
+ * vTaskCoreAffinitySet( NULL, ( 1 << 1 ) );
+ * </pre>
+ * \defgroup vTaskCoreAffinitySet vTaskCoreAffinitySet
+ * \ingroup TaskCtrl
+ */
+    void vTaskCoreAffinitySet( const TaskHandle_t xTask,
+                               UBaseType_t uxCoreAffinityMask ) PRIVILEGED_FUNCTION;
+
+/**
+ * task. h
+ * <pre>
+ * UBaseType_t vTaskCoreAffinityGet( const TaskHandle_t xTask );
+ * </pre>
+ *
+ * Gets the core affinity mask for a task.
+ *
+ * @param xTask The handle of the task to get the core affinity mask for.
+ * Passing NULL will get the core affinity mask for the calling task.
+ *
+ * @return The core affinity mask.
+ * \defgroup vTaskCoreAffinityGet vTaskCoreAffinityGet
+ * \ingroup TaskCtrl
+ */
+    UBaseType_t vTaskCoreAffinityGet( const TaskHandle_t xTask ) PRIVILEGED_FUNCTION;
+
+#endif
+
 /**
  * task. h
  * <pre>
@@ -1644,6 +1703,26 @@ configSTACK_DEPTH_TYPE uxTaskGetStackHighWaterMark2( TaskHandle_t xTask ) PRIVIL
     void vApplicationGetIdleTaskMemory( StaticTask_t ** ppxIdleTaskTCBBuffer,
                                                StackType_t ** ppxIdleTaskStackBuffer,
                                                uint32_t * pulIdleTaskStackSize ); /*lint !e526 Symbol not defined as it is an application callback. */
+
+    #if ( configNUMBER_OF_CORES > 1 )
+        /**
+         * task.h
+         * <pre>void vApplicationGetPassiveIdleTaskMemory( StaticTask_t ** ppxIdleTaskTCBBuffer, StackType_t ** ppxIdleTaskStackBuffer, uint32_t *pulIdleTaskStackSize, BaseType_t xPassiveIdleTaskIndex ) </pre>
+         *
+         * This function is used to provide statically allocated blocks of memory to FreeRTOS to hold the
+         * idle tasks of cores 1 to configNUMBER_OF_CORES - 1 (the passive idle tasks).  The idle task of
+         * core 0 still uses vApplicationGetIdleTaskMemory().
+         *
+         * @param ppxIdleTaskTCBBuffer A handle to a statically allocated TCB buffer
+         * @param ppxIdleTaskStackBuffer A handle to a statically allocated Stack buffer for the idle task
+         * @param pulIdleTaskStackSize A pointer to the number of elements that will fit in the allocated stack buffer
+         * @param xPassiveIdleTaskIndex The index of the passive idle task, 0 for core 1
+         */
+        void vApplicationGetPassiveIdleTaskMemory( StaticTask_t ** ppxIdleTaskTCBBuffer,
+                                                   StackType_t ** ppxIdleTaskStackBuffer,
+                                                   uint32_t * pulIdleTaskStackSize,
+                                                   BaseType_t xPassiveIdleTaskIndex ); /*lint !e526 Symbol not defined as it is an application callback. */
+    #endif
 #endif
 
 /**
@@ -2946,7 +3025,34 @@ void vTaskRemoveFromUnorderedEventList( ListItem_t * pxEventListItem,
  * Sets the pointer to the current TCB to the TCB of the highest priority task
  * that is ready to run.
  */
-portDONT_DISCARD void vTaskSwitchContext( void ) PRIVILEGED_FUNCTION;
+#if ( configNUMBER_OF_CORES == 1 )
+    portDONT_DISCARD void vTaskSwitchContext( void ) PRIVILEGED_FUNCTION;
+#else
+    portDONT_DISCARD void vTaskSwitchContext( BaseType_t xCoreID ) PRIVILEGED_FUNCTION;
+
+/*
+ * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS ONLY
+ * INTENDED FOR USE WHEN IMPLEMENTING A PORT OF THE SCHEDULER.
+ *
+ * Called from the tick interrupt of cores other than core 0.  Only core 0
+ * increments the tick count; the other cores use this to time slice between
+ * ready tasks of equal priority.  Returns pdTRUE if a context switch is
+ * required on the calling core.
+ */
+    BaseType_t xTaskCheckForTimeSlice( void ) PRIVILEGED_FUNCTION;
+
+/*
+ * THESE FUNCTIONS MUST NOT BE USED FROM APPLICATION CODE.  THEY ARE ONLY
+ * INTENDED FOR USE WHEN IMPLEMENTING A PORT OF THE SCHEDULER.
+ *
+ * Critical sections that are safe across cores: the task level versions take
+ * the task lock and the ISR lock, the ISR versions take only the ISR lock.
+ */
+    void vTaskEnterCritical( void ) PRIVILEGED_FUNCTION;
+    void vTaskExitCritical( void ) PRIVILEGED_FUNCTION;
+    UBaseType_t vTaskEnterCriticalFromISR( void ) PRIVILEGED_FUNCTION;
+    void vTaskExitCriticalFromISR( UBaseType_t uxSavedInterruptStatus ) PRIVILEGED_FUNCTION;
+#endif
 
 /*
  * THESE FUNCTIONS MUST NOT BE USED FROM APPLICATION CODE.  THEY ARE USED BY
@@ -93,13 +93,55 @@
     extern uint32_t ulSetInterruptMaskFromISR( void ) __attribute__( ( naked ) );
     extern void vClearInterruptMaskFromISR( uint32_t ulMask )  __attribute__( ( naked ) );
 
-    #define portSET_INTERRUPT_MASK_FROM_ISR()         ulSetInterruptMaskFromISR()
-    #define portCLEAR_INTERRUPT_MASK_FROM_ISR( x )    vClearInterruptMaskFromISR( x )
+    #define portSET_INTERRUPT_MASK()                  ulSetInterruptMaskFromISR()
+    #define portCLEAR_INTERRUPT_MASK( x )             vClearInterruptMaskFromISR( x )
     #define portDISABLE_INTERRUPTS()                  __asm volatile ( " cpsid i " ::: "memory" )
     #define portENABLE_INTERRUPTS()                   __asm volatile ( " cpsie i " ::: "memory" )
-    #define portENTER_CRITICAL()                      vPortEnterCritical()
-    #define portEXIT_CRITICAL()                       vPortExitCritical()
 
+    #if ( configNUMBER_OF_CORES == 1 )
+        #define portSET_INTERRUPT_MASK_FROM_ISR()         ulSetInterruptMaskFromISR()
+        #define portCLEAR_INTERRUPT_MASK_FROM_ISR( x )    vClearInterruptMaskFromISR( x )
+        #define portENTER_CRITICAL()                      vPortEnterCritical()
+        #define portEXIT_CRITICAL()                       vPortExitCritical()
+    #else
+
+/* With more than one core the critical sections are implemented by the
+ * kernel on top of the two recursive locks below, the interrupt mask alone
+ * only protects the calling core. */
+        #define portSET_INTERRUPT_MASK_FROM_ISR()         vTaskEnterCriticalFromISR()
+        #define portCLEAR_INTERRUPT_MASK_FROM_ISR( x )    vTaskExitCriticalFromISR( x )
+        #define portENTER_CRITICAL()                      vTaskEnterCritical()
+        #define portEXIT_CRITICAL()                       vTaskExitCritical()
+    #endif
+
+/*-----------------------------------------------------------*/
+
+/* Multi-core (SMP) support. */
+    #if ( configNUMBER_OF_CORES > 1 )
+        /* SIO CPUID register, 0 on core 0 and 1 on core 1. */
+        #define portGET_CORE_ID()                        ( ( BaseType_t ) *( ( volatile uint32_t * ) 0xd0000000 ) )
+
+        extern void vPortYieldCore( BaseType_t xCoreID );
+        #define portYIELD_CORE( xCoreID )                vPortYieldCore( xCoreID )
+
+        /* Lock 0 serialises tasks (and keeps a core's scheduler suspended),
+         * lock 1 serialises interrupt level access.  Both are recursive per
+         * core and backed by one hardware spinlock each. */
+        #define portTASK_LOCK                            0
+        #define portISR_LOCK                             1
+        extern void vPortRecursiveLock( uint32_t ulLockNum,
+                                        BaseType_t xAcquire );
+        #define portGET_TASK_LOCK()                      vPortRecursiveLock( portTASK_LOCK, pdTRUE )
+        #define portRELEASE_TASK_LOCK()                  vPortRecursiveLock( portTASK_LOCK, pdFALSE )
+        #define portGET_ISR_LOCK()                       vPortRecursiveLock( portISR_LOCK, pdTRUE )
+        #define portRELEASE_ISR_LOCK()                   vPortRecursiveLock( portISR_LOCK, pdFALSE )
+
+        extern UBaseType_t uxCriticalNestings[ configNUMBER_OF_CORES ];
+        #define portGET_CRITICAL_NESTING_COUNT()         ( uxCriticalNestings[ portGET_CORE_ID() ] )
+        #define portSET_CRITICAL_NESTING_COUNT( x )      ( uxCriticalNestings[ portGET_CORE_ID() ] = ( x ) )
+        #define portINCREMENT_CRITICAL_NESTING_COUNT()   ( uxCriticalNestings[ portGET_CORE_ID() ]++ )
+        #define portDECREMENT_CRITICAL_NESTING_COUNT()   ( uxCriticalNestings[ portGET_CORE_ID() ]-- )
+    #endif
 /*-----------------------------------------------------------*/
 
 /* Tickless idle/low power functionality. */
@@ -113,6 +113,46 @@
     #define configIDLE_TASK_NAME    "IDLE"
 #endif
 
+#if ( configNUMBER_OF_CORES > 1 )
+
+/* With more than one core the current task is held per core, and a task that
+ * is running on one core cannot be selected by another.  xTaskRunState holds
+ * the core a task is running on, or taskTASK_NOT_RUNNING. */
+    #define taskTASK_NOT_RUNNING          ( ( BaseType_t ) -1 )
+    #define taskTASK_IS_RUNNING( pxTCB )    ( ( pxTCB )->xTaskRunState != taskTASK_NOT_RUNNING )
+
+/* The idle tasks are treated as running at a priority below tskIDLE_PRIORITY
+ * when choosing which core to preempt, so an application task of priority 0
+ * is preferred over them. */
+    #define taskIS_IDLE_TASK( pxTCB )       ( ( pxTCB )->xIsIdle != pdFALSE )
+
+    #if ( configUSE_CORE_AFFINITY == 1 )
+        #define taskCAN_RUN_ON_CORE( pxTCB, xCoreID )    ( ( ( pxTCB )->uxCoreAffinityMask & ( ( UBaseType_t ) 1U << ( UBaseType_t ) ( xCoreID ) ) ) != 0U )
+    #else
+        #define taskCAN_RUN_ON_CORE( pxTCB, xCoreID )    ( pdTRUE )
+    #endif
+
+/* Reads of the current task from outside a critical section go through
+ * xTaskGetCurrentTaskHandle() so the core ID and the array index are read
+ * with interrupts masked.  Code that changes the current task indexes
+ * pxCurrentTCBs[] directly. */
+    #define pxCurrentTCB                    ( ( TCB_t * ) xTaskGetCurrentTaskHandle() )
+
+    #if ( configUSE_PORT_OPTIMISED_TASK_SELECTION != 0 )
+        #error configUSE_PORT_OPTIMISED_TASK_SELECTION must be 0 when configNUMBER_OF_CORES > 1
+    #endif
+
+    #if ( configUSE_TICKLESS_IDLE != 0 )
+        #error configUSE_TICKLESS_IDLE must be 0 when configNUMBER_OF_CORES > 1
+    #endif
+
+/* These keep one global value for the running task, which would need to be
+ * per core. */
+    #if ( configGENERATE_RUN_TIME_STATS == 1 ) || ( configUSE_POSIX_ERRNO == 1 ) || ( configUSE_NEWLIB_REENTRANT == 1 )
+        #error configGENERATE_RUN_TIME_STATS, configUSE_POSIX_ERRNO and configUSE_NEWLIB_REENTRANT are not supported when configNUMBER_OF_CORES > 1
+    #endif
+#endif /* configNUMBER_OF_CORES */
+
 #if ( configUSE_PORT_OPTIMISED_TASK_SELECTION == 0 )
 
 /* If configUSE_PORT_OPTIMISED_TASK_SELECTION is 0 then task selection is
@@ -327,6 +367,14 @@ typedef struct tskTaskControlBlock       /* The old naming convention is used to
     #if ( configUSE_POSIX_ERRNO == 1 )
         int iTaskErrno;
     #endif
+
+    #if ( configNUMBER_OF_CORES > 1 )
+        volatile BaseType_t xTaskRunState; /*< The core the task is running on, or taskTASK_NOT_RUNNING. */
+        BaseType_t xIsIdle;                /*< pdTRUE for the idle task of each core. */
+        #if ( configUSE_CORE_AFFINITY == 1 )
+            UBaseType_t uxCoreAffinityMask; /*< Bit n set if the task may run on core n. */
+        #endif
+    #endif
 } tskTCB;
 
 /* The old tskTCB name is maintained above then typedefed to the new TCB_t name
@@ -335,7 +383,11 @@ typedef tskTCB TCB_t;
 
 /*lint -save -e956 A manual analysis and inspection has been used to determine
  * which static variables must be declared volatile. */
-PRIVILEGED_DATA TCB_t * volatile pxCurrentTCB = NULL;
+#if ( configNUMBER_OF_CORES == 1 )
+    PRIVILEGED_DATA TCB_t * volatile pxCurrentTCB = NULL;
+#else
+    PRIVILEGED_DATA TCB_t * volatile pxCurrentTCBs[ configNUMBER_OF_CORES ]; /*< The task running on each core, indexed by portGET_CORE_ID(). */
+#endif
 
 /* Lists for ready and blocked tasks. --------------------
  * xDelayedTaskList1 and xDelayedTaskList2 could be moved to function scope but
@@ -373,11 +425,19 @@ PRIVILEGED_DATA static volatile TickType_t xTickCount = ( TickType_t ) configINI
 PRIVILEGED_DATA static volatile UBaseType_t uxTopReadyPriority = tskIDLE_PRIORITY;
 PRIVILEGED_DATA static volatile BaseType_t xSchedulerRunning = pdFALSE;
 PRIVILEGED_DATA static volatile TickType_t xPendedTicks = ( TickType_t ) 0U;
-PRIVILEGED_DATA static volatile BaseType_t xYieldPending = pdFALSE;
+#if ( configNUMBER_OF_CORES == 1 )
+    PRIVILEGED_DATA static volatile BaseType_t xYieldPending = pdFALSE;
+#else
+    PRIVILEGED_DATA static volatile BaseType_t xYieldPendings[ configNUMBER_OF_CORES ]; /*< A context switch is pending on the core. */
+#endif
 PRIVILEGED_DATA static volatile BaseType_t xNumOfOverflows = ( BaseType_t ) 0;
 PRIVILEGED_DATA static UBaseType_t uxTaskNumber = ( UBaseType_t ) 0U;
 PRIVILEGED_DATA static volatile TickType_t xNextTaskUnblockTime = ( TickType_t ) 0U; /* Initialised to portMAX_DELAY before the scheduler starts. */
-PRIVILEGED_DATA static TaskHandle_t xIdleTaskHandle = NULL;                          /*< Holds the handle of the idle task.  The idle task is created automatically when the scheduler is started. */
+#if ( configNUMBER_OF_CORES == 1 )
+    PRIVILEGED_DATA static TaskHandle_t xIdleTaskHandle = NULL;                      /*< Holds the handle of the idle task.  The idle task is created automatically when the scheduler is started. */
+#else
+    PRIVILEGED_DATA static TaskHandle_t xIdleTaskHandles[ configNUMBER_OF_CORES ];  /*< One idle task per core, each pinned to its core. */
+#endif
 
 /* Improve support for OpenOCD. The kernel tracks Ready tasks via priority lists.
  * For tracking the state of remote threads, OpenOCD uses uxTopUsedPriority
@@ -555,6 +615,44 @@ static void prvInitialiseNewTask( TaskFunction_t pxTaskCode,
  */
 static void prvAddNewTaskToReadyList( TCB_t * pxNewTCB ) PRIVILEGED_FUNCTION;
 
+#if ( configNUMBER_OF_CORES > 1 )
+
+/*
+ * Makes the highest priority ready task that is not running on another core,
+ * and that may run on xCoreID, the current task of xCoreID.  Called with both
+ * the task and ISR locks held.
+ */
+    static void prvSelectHighestPriorityTask( BaseType_t xCoreID ) PRIVILEGED_FUNCTION;
+
+/*
+ * Requests a context switch on xCoreID.  On the calling core this only sets
+ * xYieldPendings[], the caller yields (or returns pdTRUE from an ISR API); on
+ * the other core it interrupts it through the port.  Called from a critical
+ * section.
+ */
+    static void prvYieldCore( BaseType_t xCoreID ) PRIVILEGED_FUNCTION;
+
+/*
+ * pxTCB has just become ready: if it has a higher priority than the task
+ * running on one of the cores it may use, preempt the core running the
+ * lowest priority task.  Called from a critical section.
+ */
+    static void prvYieldForTask( const TCB_t * pxTCB ) PRIVILEGED_FUNCTION;
+
+/*
+ * Returns pdTRUE if another ready task of the same priority as the task
+ * running on xCoreID is waiting to run there (time slicing).
+ */
+    static BaseType_t prvTimeSliceRequired( BaseType_t xCoreID ) PRIVILEGED_FUNCTION;
+
+/*
+ * The idle task of the other cores.  The termination list is only cleaned up
+ * by the idle task of core 0.
+ */
+    static portTASK_FUNCTION_PROTO( prvPassiveIdleTask, pvParameters ) PRIVILEGED_FUNCTION;
+
+#endif /* configNUMBER_OF_CORES */
+
 /*
  * freertos_tasks_c_additions_init() should only be called if the user definable
  * macro FREERTOS_TASKS_C_ADDITIONS_INIT() is defined, as that is the only macro
@@ -1000,6 +1098,21 @@ static void prvInitialiseNewTask( TaskFunction_t pxTaskCode,
         }
     #endif
 
+    #if ( configNUMBER_OF_CORES > 1 )
+        {
+            /* New tasks may run on any core until vTaskCoreAffinitySet() is
+             * called.  The idle tasks are marked by vTaskStartScheduler(). */
+            pxNewTCB->xTaskRunState = taskTASK_NOT_RUNNING;
+            pxNewTCB->xIsIdle = pdFALSE;
+
+            #if ( configUSE_CORE_AFFINITY == 1 )
+                {
+                    pxNewTCB->uxCoreAffinityMask = tskNO_AFFINITY;
+                }
+            #endif
+        }
+    #endif
+
     /* Initialize the TCB stack to look as if the task was already running,
      * but had been interrupted by the scheduler.  The return address is set
      * to the start of the task function. Once the stack has been initialised
@@ -1065,6 +1178,63 @@ static void prvInitialiseNewTask( TaskFunction_t pxTaskCode,
 }
 /*-----------------------------------------------------------*/
 
+#if ( configNUMBER_OF_CORES > 1 )
+
+    static void prvAddNewTaskToReadyList( TCB_t * pxNewTCB )
+    {
+        /* Ensure interrupts and the other cores don't access the task lists
+         * while the lists are being updated. */
+        taskENTER_CRITICAL();
+        {
+            uxCurrentNumberOfTasks++;
+
+            if( uxCurrentNumberOfTasks == ( UBaseType_t ) 1 )
+            {
+                /* This is the first task to be created so do the preliminary
+                 * initialisation required.  The task each core starts with is
+                 * chosen by vTaskStartScheduler(). */
+                prvInitialiseTaskLists();
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            uxTaskNumber++;
+
+            #if ( configUSE_TRACE_FACILITY == 1 )
+                {
+                    /* Add a counter into the TCB for tracing only. */
+                    pxNewTCB->uxTCBNumber = uxTaskNumber;
+                }
+            #endif /* configUSE_TRACE_FACILITY */
+            traceTASK_CREATE( pxNewTCB );
+
+            prvAddTaskToReadyList( pxNewTCB );
+
+            portSETUP_TCB( pxNewTCB );
+
+            if( xSchedulerRunning != pdFALSE )
+            {
+                /* If the created task is of a higher priority than a task
+                 * running on a core it may use, it should run now.  A yield on
+                 * this core happens when the critical section is exited. */
+                #if ( configUSE_PREEMPTION == 1 )
+                    {
+                        prvYieldForTask( pxNewTCB );
+                    }
+                #endif
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        taskEXIT_CRITICAL();
+    }
+
+#else /* configNUMBER_OF_CORES */
+
 static void prvAddNewTaskToReadyList( TCB_t * pxNewTCB )
 {
     /* Ensure interrupts don't access the task lists while the lists are being
@@ -1147,6 +1317,8 @@ static void prvAddNewTaskToReadyList( TCB_t * pxNewTCB )
         mtCOVERAGE_TEST_MARKER();
     }
 }
+
+#endif /* configNUMBER_OF_CORES */
 /*-----------------------------------------------------------*/
 
 #if ( INCLUDE_vTaskDelete == 1 )
@@ -1187,7 +1359,11 @@ static void prvAddNewTaskToReadyList( TCB_t * pxNewTCB )
              * not return. */
             uxTaskNumber++;
 
-            if( pxTCB == pxCurrentTCB )
+            #if ( configNUMBER_OF_CORES > 1 )
+                if( taskTASK_IS_RUNNING( pxTCB ) )
+            #else
+                if( pxTCB == pxCurrentTCB )
+            #endif
             {
                 /* A task is deleting itself.  This cannot complete within the
                  * task itself, as a context switch to another task is required.
@@ -1210,7 +1386,21 @@ static void prvAddNewTaskToReadyList( TCB_t * pxNewTCB )
                  * after which it is not possible to yield away from this task -
                  * hence xYieldPending is used to latch that a context switch is
                  * required. */
-                portPRE_TASK_DELETE_HOOK( pxTCB, &xYieldPending );
+                #if ( configNUMBER_OF_CORES > 1 )
+                    {
+                        /* The task may be running on another core.  It is
+                         * only freed by the idle task once it has been
+                         * switched out there. */
+                        portPRE_TASK_DELETE_HOOK( pxTCB, &( xYieldPendings[ pxTCB->xTaskRunState ] ) );
+
+                        if( pxTCB->xTaskRunState != ( BaseType_t ) portGET_CORE_ID() )
+                        {
+                            prvYieldCore( pxTCB->xTaskRunState );
+                        }
+                    }
+                #else
+                    portPRE_TASK_DELETE_HOOK( pxTCB, &xYieldPending );
+                #endif
             }
             else
             {
@@ -1386,9 +1576,14 @@ static void prvAddNewTaskToReadyList( TCB_t * pxNewTCB )
 
         configASSERT( pxTCB );
 
-        if( pxTCB == pxCurrentTCB )
+        #if ( configNUMBER_OF_CORES > 1 )
+            if( taskTASK_IS_RUNNING( pxTCB ) )
+        #else
+            if( pxTCB == pxCurrentTCB )
+        #endif
         {
-            /* The task calling this function is querying its own state. */
+            /* The task calling this function is querying its own state, or
+             * the task is running on another core. */
             eReturn = eRunning;
         }
         else
@@ -1576,6 +1771,8 @@ static void prvAddNewTaskToReadyList( TCB_t * pxNewTCB )
 
             if( uxCurrentBasePriority != uxNewPriority )
             {
+                #if ( configNUMBER_OF_CORES == 1 )
+
                 /* The priority change may have readied a task of higher
                  * priority than the calling task. */
                 if( uxNewPriority > uxCurrentBasePriority )
@@ -1614,6 +1811,7 @@ static void prvAddNewTaskToReadyList( TCB_t * pxNewTCB )
                      * require a yield as the running task must be above the
                      * new priority of the task being modified. */
                 }
+                #endif /* configNUMBER_OF_CORES */
 
                 /* Remember the ready list the task might be referenced from
                  * before its uxPriority member is changed so the
@@ -1681,14 +1879,43 @@ static void prvAddNewTaskToReadyList( TCB_t * pxNewTCB )
                     mtCOVERAGE_TEST_MARKER();
                 }
 
-                if( xYieldRequired != pdFALSE )
-                {
-                    taskYIELD_IF_USING_PREEMPTION();
-                }
-                else
-                {
-                    mtCOVERAGE_TEST_MARKER();
-                }
+                #if ( configNUMBER_OF_CORES > 1 )
+                    {
+                        #if ( configUSE_PREEMPTION == 1 )
+                            {
+                                if( taskTASK_IS_RUNNING( pxTCB ) )
+                                {
+                                    /* Lowering the priority of a running task
+                                     * may let a ready task preempt it on its
+                                     * core. */
+                                    if( uxNewPriority < uxCurrentBasePriority )
+                                    {
+                                        prvYieldCore( pxTCB->xTaskRunState );
+                                    }
+                                }
+                                else if( ( uxNewPriority > uxCurrentBasePriority ) &&
+                                         ( listIS_CONTAINED_WITHIN( &( pxReadyTasksLists[ pxTCB->uxPriority ] ), &( pxTCB->xStateListItem ) ) != pdFALSE ) )
+                                {
+                                    prvYieldForTask( pxTCB );
+                                }
+                                else
+                                {
+                                    mtCOVERAGE_TEST_MARKER();
+                                }
+                            }
+                        #endif /* configUSE_PREEMPTION */
+                        ( void ) xYieldRequired;
+                    }
+                #else /* configNUMBER_OF_CORES */
+                    if( xYieldRequired != pdFALSE )
+                    {
+                        taskYIELD_IF_USING_PREEMPTION();
+                    }
+                    else
+                    {
+                        mtCOVERAGE_TEST_MARKER();
+                    }
+                #endif /* configNUMBER_OF_CORES */
 
                 /* Remove compiler warning about unused variables when the port
                  * optimised task selection is not being used. */
@@ -1753,6 +1980,20 @@ static void prvAddNewTaskToReadyList( TCB_t * pxNewTCB )
                     }
                 }
             #endif /* if ( configUSE_TASK_NOTIFICATIONS == 1 ) */
+
+            #if ( configNUMBER_OF_CORES > 1 )
+                {
+                    /* A task running on another core is switched out there. */
+                    if( taskTASK_IS_RUNNING( pxTCB ) && ( pxTCB->xTaskRunState != ( BaseType_t ) portGET_CORE_ID() ) )
+                    {
+                        prvYieldCore( pxTCB->xTaskRunState );
+                    }
+                    else
+                    {
+                        mtCOVERAGE_TEST_MARKER();
+                    }
+                }
+            #endif
         }
         taskEXIT_CRITICAL();
 
@@ -1781,6 +2022,8 @@ static void prvAddNewTaskToReadyList( TCB_t * pxNewTCB )
             }
             else
             {
+                #if ( configNUMBER_OF_CORES == 1 )
+
                 /* The scheduler is not running, but the task that was pointed
                  * to by pxCurrentTCB has just been suspended and pxCurrentTCB
                  * must be adjusted to point to a different task. */
@@ -1796,6 +2039,10 @@ static void prvAddNewTaskToReadyList( TCB_t * pxNewTCB )
                 {
                     vTaskSwitchContext();
                 }
+                #endif /* configNUMBER_OF_CORES */
+
+                /* With several cores the first task of each core is only
+                 * chosen by vTaskStartScheduler(). */
             }
         }
         else
@@ -1878,17 +2125,27 @@ static void prvAddNewTaskToReadyList( TCB_t * pxNewTCB )
                     prvAddTaskToReadyList( pxTCB );
 
                     /* A higher priority task may have just been resumed. */
-                    if( pxTCB->uxPriority >= pxCurrentTCB->uxPriority )
-                    {
-                        /* This yield may not cause the task just resumed to run,
-                         * but will leave the lists in the correct state for the
-                         * next yield. */
-                        taskYIELD_IF_USING_PREEMPTION();
-                    }
-                    else
-                    {
-                        mtCOVERAGE_TEST_MARKER();
-                    }
+                    #if ( configNUMBER_OF_CORES > 1 )
+                        {
+                            #if ( configUSE_PREEMPTION == 1 )
+                                {
+                                    prvYieldForTask( pxTCB );
+                                }
+                            #endif
+                        }
+                    #else
+                        if( pxTCB->uxPriority >= pxCurrentTCB->uxPriority )
+                        {
+                            /* This yield may not cause the task just resumed to run,
+                             * but will leave the lists in the correct state for the
+                             * next yield. */
+                            taskYIELD_IF_USING_PREEMPTION();
+                        }
+                        else
+                        {
+                            mtCOVERAGE_TEST_MARKER();
+                        }
+                    #endif /* configNUMBER_OF_CORES */
                 }
                 else
                 {
@@ -1946,6 +2203,25 @@ static void prvAddNewTaskToReadyList( TCB_t * pxNewTCB )
                 {
                     /* Ready lists can be accessed so move the task from the
                      * suspended list to the ready list directly. */
+                    #if ( configNUMBER_OF_CORES > 1 )
+                        {
+                            ( void ) uxListRemove( &( pxTCB->xStateListItem ) );
+                            prvAddTaskToReadyList( pxTCB );
+
+                            /* prvYieldForTask() marks the yield as pending on
+                             * this core, or interrupts the other one. */
+                            #if ( configUSE_PREEMPTION == 1 )
+                                {
+                                    prvYieldForTask( pxTCB );
+
+                                    if( xYieldPendings[ portGET_CORE_ID() ] != pdFALSE )
+                                    {
+                                        xYieldRequired = pdTRUE;
+                                    }
+                                }
+                            #endif
+                        }
+                    #else /* configNUMBER_OF_CORES */
                     if( pxTCB->uxPriority >= pxCurrentTCB->uxPriority )
                     {
                         xYieldRequired = pdTRUE;
@@ -1962,6 +2238,7 @@ static void prvAddNewTaskToReadyList( TCB_t * pxNewTCB )
 
                     ( void ) uxListRemove( &( pxTCB->xStateListItem ) );
                     prvAddTaskToReadyList( pxTCB );
+                    #endif /* configNUMBER_OF_CORES */
                 }
                 else
                 {
@@ -1984,12 +2261,106 @@ static void prvAddNewTaskToReadyList( TCB_t * pxNewTCB )
 #endif /* ( ( INCLUDE_xTaskResumeFromISR == 1 ) && ( INCLUDE_vTaskSuspend == 1 ) ) */
 /*-----------------------------------------------------------*/
 
+#if ( configNUMBER_OF_CORES > 1 )
+
+    static BaseType_t prvCreateIdleTasks( void )
+    {
+        BaseType_t xReturn = pdPASS;
+        BaseType_t xCoreID;
+        char cIdleName[ configMAX_TASK_NAME_LEN ];
+        UBaseType_t x;
+
+        /* The idle tasks are named IDLE0, IDLE1, ... */
+        for( x = ( UBaseType_t ) 0; x < ( UBaseType_t ) ( configMAX_TASK_NAME_LEN - 2 ); x++ )
+        {
+            cIdleName[ x ] = configIDLE_TASK_NAME[ x ];
+
+            if( cIdleName[ x ] == ( char ) 0x00 )
+            {
+                break;
+            }
+        }
+
+        cIdleName[ x + 1 ] = ( char ) 0x00;
+
+        for( xCoreID = ( BaseType_t ) 0; ( xCoreID < ( BaseType_t ) configNUMBER_OF_CORES ) && ( xReturn == pdPASS ); xCoreID++ )
+        {
+            /* Only the idle task of core 0 cleans up deleted tasks. */
+            TaskFunction_t pxIdleTaskFunction = ( xCoreID == 0 ) ? prvIdleTask : prvPassiveIdleTask;
+
+            cIdleName[ x ] = ( char ) ( '0' + xCoreID );
+
+            #if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+                {
+                    StaticTask_t * pxIdleTaskTCBBuffer = NULL;
+                    StackType_t * pxIdleTaskStackBuffer = NULL;
+                    uint32_t ulIdleTaskStackSize;
+
+                    if( xCoreID == 0 )
+                    {
+                        vApplicationGetIdleTaskMemory( &pxIdleTaskTCBBuffer, &pxIdleTaskStackBuffer, &ulIdleTaskStackSize );
+                    }
+                    else
+                    {
+                        vApplicationGetPassiveIdleTaskMemory( &pxIdleTaskTCBBuffer, &pxIdleTaskStackBuffer, &ulIdleTaskStackSize, xCoreID - 1 );
+                    }
+
+                    xIdleTaskHandles[ xCoreID ] = xTaskCreateStatic( pxIdleTaskFunction,
+                                                                     cIdleName,
+                                                                     ulIdleTaskStackSize,
+                                                                     ( void * ) NULL,
+                                                                     portPRIVILEGE_BIT,
+                                                                     pxIdleTaskStackBuffer,
+                                                                     pxIdleTaskTCBBuffer );
+
+                    xReturn = ( xIdleTaskHandles[ xCoreID ] != NULL ) ? pdPASS : pdFAIL;
+                }
+            #else /* if ( configSUPPORT_STATIC_ALLOCATION == 1 ) */
+                {
+                    xReturn = xTaskCreate( pxIdleTaskFunction,
+                                           cIdleName,
+                                           configMINIMAL_STACK_SIZE,
+                                           ( void * ) NULL,
+                                           portPRIVILEGE_BIT,
+                                           &( xIdleTaskHandles[ xCoreID ] ) );
+                }
+            #endif /* configSUPPORT_STATIC_ALLOCATION */
+
+            if( xReturn == pdPASS )
+            {
+                TCB_t * const pxIdleTCB = xIdleTaskHandles[ xCoreID ];
+
+                /* Each core always has its own idle task to fall back to. */
+                pxIdleTCB->xIsIdle = pdTRUE;
+
+                #if ( configUSE_CORE_AFFINITY == 1 )
+                    {
+                        pxIdleTCB->uxCoreAffinityMask = ( UBaseType_t ) 1U << ( UBaseType_t ) xCoreID;
+                    }
+                #endif
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+
+        return xReturn;
+    }
+
+#endif /* configNUMBER_OF_CORES */
+/*-----------------------------------------------------------*/
+
 void vTaskStartScheduler( void )
 {
     BaseType_t xReturn;
 
     /* Add the idle task at the lowest priority. */
-    #if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+    #if ( configNUMBER_OF_CORES > 1 )
+        {
+            xReturn = prvCreateIdleTasks();
+        }
+    #elif ( configSUPPORT_STATIC_ALLOCATION == 1 )
         {
             StaticTask_t * pxIdleTaskTCBBuffer = NULL;
             StackType_t * pxIdleTaskStackBuffer = NULL;
@@ -2058,6 +2429,19 @@ void vTaskStartScheduler( void )
          * starts to run. */
         portDISABLE_INTERRUPTS();
 
+        #if ( configNUMBER_OF_CORES > 1 )
+            {
+                BaseType_t xCoreID;
+
+                /* Choose the first task of each core.  The port starts the
+                 * other cores from xPortStartScheduler(). */
+                for( xCoreID = ( BaseType_t ) 0; xCoreID < ( BaseType_t ) configNUMBER_OF_CORES; xCoreID++ )
+                {
+                    prvSelectHighestPriorityTask( xCoreID );
+                }
+            }
+        #endif
+
         #if ( configUSE_NEWLIB_REENTRANT == 1 )
             {
                 /* Switch Newlib's _impure_ptr variable to point to the _reent
@@ -2104,7 +2488,11 @@ void vTaskStartScheduler( void )
 
     /* Prevent compiler warnings if INCLUDE_xTaskGetIdleTaskHandle is set to 0,
      * meaning xIdleTaskHandle is not used anywhere else. */
-    ( void ) xIdleTaskHandle;
+    #if ( configNUMBER_OF_CORES > 1 )
+        ( void ) xIdleTaskHandles;
+    #else
+        ( void ) xIdleTaskHandle;
+    #endif
 
     /* OpenOCD makes use of uxTopUsedPriority for thread debugging. Prevent uxTopUsedPriority
      * from getting optimized out as it is no longer used by the kernel. */
@@ -2123,6 +2511,36 @@ void vTaskEndScheduler( void )
 }
 /*----------------------------------------------------------*/
 
+#if ( configNUMBER_OF_CORES > 1 )
+
+    void vTaskSuspendAll( void )
+    {
+        UBaseType_t uxSavedInterruptStatus;
+
+        if( xSchedulerRunning != pdFALSE )
+        {
+            /* The task lock is held until xTaskResumeAll(), which keeps the
+             * other cores out of the kernel (their critical sections and
+             * context switches take the same lock).  The count itself is
+             * changed under the ISR lock so interrupts on the other cores see
+             * a consistent value. */
+            uxSavedInterruptStatus = portSET_INTERRUPT_MASK();
+            {
+                portGET_TASK_LOCK();
+                portGET_ISR_LOCK();
+                ++uxSchedulerSuspended;
+                portRELEASE_ISR_LOCK();
+            }
+            portCLEAR_INTERRUPT_MASK( uxSavedInterruptStatus );
+        }
+        else
+        {
+            ++uxSchedulerSuspended;
+        }
+    }
+
+#else /* configNUMBER_OF_CORES */
+
 void vTaskSuspendAll( void )
 {
     /* A critical section is not required as the variable is of type
@@ -2142,6 +2560,8 @@ void vTaskSuspendAll( void )
      * the above increment elsewhere. */
     portMEMORY_BARRIER();
 }
+
+#endif /* configNUMBER_OF_CORES */
 /*----------------------------------------------------------*/
 
 #if ( configUSE_TICKLESS_IDLE != 0 )
@@ -2223,8 +2643,23 @@ BaseType_t xTaskResumeAll( void )
      * tasks from this list into their appropriate ready list. */
     taskENTER_CRITICAL();
     {
+        #if ( configNUMBER_OF_CORES > 1 )
+            BaseType_t xCoreID = ( BaseType_t ) portGET_CORE_ID();
+        #endif
+
         --uxSchedulerSuspended;
 
+        #if ( configNUMBER_OF_CORES > 1 )
+            {
+                /* Release the task lock taken by vTaskSuspendAll().  The
+                 * critical section still holds it once more. */
+                if( xSchedulerRunning != pdFALSE )
+                {
+                    portRELEASE_TASK_LOCK();
+                }
+            }
+        #endif
+
         if( uxSchedulerSuspended == ( UBaseType_t ) pdFALSE )
         {
             if( uxCurrentNumberOfTasks > ( UBaseType_t ) 0U )
@@ -2240,14 +2675,24 @@ BaseType_t xTaskResumeAll( void )
 
                     /* If the moved task has a priority higher than the current
                      * task then a yield must be performed. */
-                    if( pxTCB->uxPriority >= pxCurrentTCB->uxPriority )
-                    {
-                        xYieldPending = pdTRUE;
-                    }
-                    else
-                    {
-                        mtCOVERAGE_TEST_MARKER();
-                    }
+                    #if ( configNUMBER_OF_CORES > 1 )
+                        {
+                            #if ( configUSE_PREEMPTION == 1 )
+                                {
+                                    prvYieldForTask( pxTCB );
+                                }
+                            #endif
+                        }
+                    #else
+                        if( pxTCB->uxPriority >= pxCurrentTCB->uxPriority )
+                        {
+                            xYieldPending = pdTRUE;
+                        }
+                        else
+                        {
+                            mtCOVERAGE_TEST_MARKER();
+                        }
+                    #endif /* configNUMBER_OF_CORES */
                 }
 
                 if( pxTCB != NULL )
@@ -2274,7 +2719,11 @@ BaseType_t xTaskResumeAll( void )
                         {
                             if( xTaskIncrementTick() != pdFALSE )
                             {
-                                xYieldPending = pdTRUE;
+                                #if ( configNUMBER_OF_CORES > 1 )
+                                    xYieldPendings[ xCoreID ] = pdTRUE;
+                                #else
+                                    xYieldPending = pdTRUE;
+                                #endif
                             }
                             else
                             {
@@ -2292,7 +2741,11 @@ BaseType_t xTaskResumeAll( void )
                     }
                 }
 
-                if( xYieldPending != pdFALSE )
+                #if ( configNUMBER_OF_CORES > 1 )
+                    if( xYieldPendings[ xCoreID ] != pdFALSE )
+                #else
+                    if( xYieldPending != pdFALSE )
+                #endif
                 {
                     #if ( configUSE_PREEMPTION != 0 )
                         {
@@ -2696,16 +3149,24 @@ BaseType_t xTaskCatchUpTicks( TickType_t xTicksToCatchUp )
                         /* Preemption is on, but a context switch should only be
                          *  performed if the unblocked task has a priority that is
                          *  equal to or higher than the currently executing task. */
-                        if( pxTCB->uxPriority > pxCurrentTCB->uxPriority )
-                        {
-                            /* Pend the yield to be performed when the scheduler
-                             * is unsuspended. */
-                            xYieldPending = pdTRUE;
-                        }
-                        else
-                        {
-                            mtCOVERAGE_TEST_MARKER();
-                        }
+                        #if ( configNUMBER_OF_CORES > 1 )
+                            taskENTER_CRITICAL();
+                            {
+                                prvYieldForTask( pxTCB );
+                            }
+                            taskEXIT_CRITICAL();
+                        #else
+                            if( pxTCB->uxPriority > pxCurrentTCB->uxPriority )
+                            {
+                                /* Pend the yield to be performed when the scheduler
+                                 * is unsuspended. */
+                                xYieldPending = pdTRUE;
+                            }
+                            else
+                            {
+                                mtCOVERAGE_TEST_MARKER();
+                            }
+                        #endif /* configNUMBER_OF_CORES */
                     }
                 #endif /* configUSE_PREEMPTION */
             }
@@ -2820,14 +3281,22 @@ BaseType_t xTaskIncrementTick( void )
                              * only be performed if the unblocked task has a
                              * priority that is equal to or higher than the
                              * currently executing task. */
-                            if( pxTCB->uxPriority >= pxCurrentTCB->uxPriority )
-                            {
-                                xSwitchRequired = pdTRUE;
-                            }
-                            else
-                            {
-                                mtCOVERAGE_TEST_MARKER();
-                            }
+                            #if ( configNUMBER_OF_CORES > 1 )
+                                {
+                                    /* Or higher than the task on the other
+                                     * core, which is interrupted instead. */
+                                    prvYieldForTask( pxTCB );
+                                }
+                            #else
+                                if( pxTCB->uxPriority >= pxCurrentTCB->uxPriority )
+                                {
+                                    xSwitchRequired = pdTRUE;
+                                }
+                                else
+                                {
+                                    mtCOVERAGE_TEST_MARKER();
+                                }
+                            #endif /* configNUMBER_OF_CORES */
                         }
                     #endif /* configUSE_PREEMPTION */
                 }
@@ -2837,7 +3306,21 @@ BaseType_t xTaskIncrementTick( void )
         /* Tasks of equal priority to the currently running task will share
          * processing time (time slice) if preemption is on, and the application
          * writer has not explicitly turned time slicing off. */
-        #if ( ( configUSE_PREEMPTION == 1 ) && ( configUSE_TIME_SLICING == 1 ) )
+        #if ( configNUMBER_OF_CORES > 1 )
+            {
+                /* Only the time slice of the calling core: the other cores
+                 * check theirs from their own tick, see
+                 * xTaskCheckForTimeSlice(). */
+                if( prvTimeSliceRequired( ( BaseType_t ) portGET_CORE_ID() ) != pdFALSE )
+                {
+                    xSwitchRequired = pdTRUE;
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+        #elif ( ( configUSE_PREEMPTION == 1 ) && ( configUSE_TIME_SLICING == 1 ) )
             {
                 if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ pxCurrentTCB->uxPriority ] ) ) > ( UBaseType_t ) 1 )
                 {
@@ -2867,7 +3350,11 @@ BaseType_t xTaskIncrementTick( void )
 
         #if ( configUSE_PREEMPTION == 1 )
             {
-                if( xYieldPending != pdFALSE )
+                #if ( configNUMBER_OF_CORES > 1 )
+                    if( xYieldPendings[ portGET_CORE_ID() ] != pdFALSE )
+                #else
+                    if( xYieldPending != pdFALSE )
+                #endif
                 {
                     xSwitchRequired = pdTRUE;
                 }
@@ -2895,6 +3382,36 @@ BaseType_t xTaskIncrementTick( void )
 }
 /*-----------------------------------------------------------*/
 
+#if ( configNUMBER_OF_CORES > 1 )
+
+    BaseType_t xTaskCheckForTimeSlice( void )
+    {
+        BaseType_t xSwitchRequired = pdFALSE;
+        const BaseType_t xCoreID = ( BaseType_t ) portGET_CORE_ID();
+
+        /* Called by the tick interrupt of the cores other than 0, with the
+         * ISR lock held.  The tick count and the delayed lists belong to core
+         * 0; here the core only shares its time between tasks of the same
+         * priority and picks up a yield it has missed.  While the scheduler is
+         * suspended the switch would only be held pending again. */
+        if( uxSchedulerSuspended == ( UBaseType_t ) pdFALSE )
+        {
+            if( ( prvTimeSliceRequired( xCoreID ) != pdFALSE ) || ( xYieldPendings[ xCoreID ] != pdFALSE ) )
+            {
+                xSwitchRequired = pdTRUE;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+
+        return xSwitchRequired;
+    }
+
+#endif /* configNUMBER_OF_CORES */
+/*-----------------------------------------------------------*/
+
 #if ( configUSE_APPLICATION_TASK_TAG == 1 )
 
     void vTaskSetApplicationTaskTag( TaskHandle_t xTask,
@@ -3007,6 +3524,234 @@ BaseType_t xTaskIncrementTick( void )
 #endif /* configUSE_APPLICATION_TASK_TAG */
 /*-----------------------------------------------------------*/
 
+#if ( configNUMBER_OF_CORES > 1 )
+
+    static void prvSelectHighestPriorityTask( BaseType_t xCoreID )
+    {
+        UBaseType_t uxCurrentPriority = uxTopReadyPriority;
+        BaseType_t xTaskScheduled = pdFALSE;
+        BaseType_t xDecrementTopPriority = pdTRUE;
+
+        /* The task leaving the core may be chosen again, here or by another
+         * core, from now on. */
+        if( pxCurrentTCBs[ xCoreID ] != NULL )
+        {
+            pxCurrentTCBs[ xCoreID ]->xTaskRunState = taskTASK_NOT_RUNNING;
+        }
+
+        while( xTaskScheduled == pdFALSE )
+        {
+            if( listLIST_IS_EMPTY( &( pxReadyTasksLists[ uxCurrentPriority ] ) ) == pdFALSE )
+            {
+                List_t * const pxReadyList = &( pxReadyTasksLists[ uxCurrentPriority ] );
+                const ListItem_t * const pxEndMarker = listGET_END_MARKER( pxReadyList );
+                ListItem_t * pxIterator;
+
+                /* uxTopReadyPriority is only lowered across empty lists, a
+                 * list whose tasks all run on other cores stays the top. */
+                xDecrementTopPriority = pdFALSE;
+
+                for( pxIterator = listGET_HEAD_ENTRY( pxReadyList ); pxIterator != pxEndMarker; pxIterator = listGET_NEXT( pxIterator ) )
+                {
+                    TCB_t * const pxTCB = listGET_LIST_ITEM_OWNER( pxIterator ); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+
+                    if( ( pxTCB->xTaskRunState == taskTASK_NOT_RUNNING ) && ( taskCAN_RUN_ON_CORE( pxTCB, xCoreID ) != pdFALSE ) )
+                    {
+                        pxTCB->xTaskRunState = xCoreID;
+                        pxCurrentTCBs[ xCoreID ] = pxTCB;
+                        xTaskScheduled = pdTRUE;
+
+                        /* Moving the chosen task to the end of its list gives
+                         * the tasks of the same priority an equal share of
+                         * the cores. */
+                        ( void ) uxListRemove( &( pxTCB->xStateListItem ) );
+                        vListInsertEnd( pxReadyList, &( pxTCB->xStateListItem ) );
+                        break;
+                    }
+                }
+            }
+            else if( xDecrementTopPriority != pdFALSE )
+            {
+                uxTopReadyPriority--;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            if( xTaskScheduled == pdFALSE )
+            {
+                /* The idle task of the core is always ready at the lowest
+                 * priority, so the search ends there. */
+                configASSERT( uxCurrentPriority > tskIDLE_PRIORITY );
+                uxCurrentPriority--;
+            }
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvYieldCore( BaseType_t xCoreID )
+    {
+        /* Only request once, the core clears xYieldPendings[] when it
+         * switches. */
+        if( xYieldPendings[ xCoreID ] == pdFALSE )
+        {
+            xYieldPendings[ xCoreID ] = pdTRUE;
+
+            if( xCoreID != ( BaseType_t ) portGET_CORE_ID() )
+            {
+                portYIELD_CORE( xCoreID );
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvYieldForTask( const TCB_t * pxTCB )
+    {
+        BaseType_t xLowestPriority = ( BaseType_t ) pxTCB->uxPriority;
+        BaseType_t xLowestPriorityCore = ( BaseType_t ) -1;
+        BaseType_t xCoreID;
+
+        if( xSchedulerRunning == pdFALSE )
+        {
+            /* The first task of each core is chosen when the scheduler
+             * starts. */
+            return;
+        }
+
+        /* Only a core running a task of strictly lower priority is preempted.
+         * The idle tasks count as priority -1. */
+        for( xCoreID = ( BaseType_t ) 0; xCoreID < ( BaseType_t ) configNUMBER_OF_CORES; xCoreID++ )
+        {
+            const TCB_t * const pxRunningTCB = pxCurrentTCBs[ xCoreID ];
+            BaseType_t xRunningPriority = ( BaseType_t ) pxRunningTCB->uxPriority;
+
+            if( taskIS_IDLE_TASK( pxRunningTCB ) )
+            {
+                xRunningPriority--;
+            }
+
+            if( ( xRunningPriority < xLowestPriority ) &&
+                ( xYieldPendings[ xCoreID ] == pdFALSE ) &&
+                ( taskCAN_RUN_ON_CORE( pxTCB, xCoreID ) != pdFALSE ) )
+            {
+                xLowestPriority = xRunningPriority;
+                xLowestPriorityCore = xCoreID;
+            }
+        }
+
+        if( xLowestPriorityCore >= ( BaseType_t ) 0 )
+        {
+            prvYieldCore( xLowestPriorityCore );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvTimeSliceRequired( BaseType_t xCoreID )
+    {
+        BaseType_t xReturn = pdFALSE;
+
+        #if ( ( configUSE_PREEMPTION == 1 ) && ( configUSE_TIME_SLICING == 1 ) )
+            {
+                const TCB_t * const pxRunningTCB = pxCurrentTCBs[ xCoreID ];
+                const List_t * const pxReadyList = &( pxReadyTasksLists[ pxRunningTCB->uxPriority ] );
+                const ListItem_t * const pxEndMarker = listGET_END_MARKER( pxReadyList );
+                const ListItem_t * pxIterator;
+
+                /* Unlike with one core, the other tasks of the list may be
+                 * running elsewhere or be pinned to another core. */
+                if( listCURRENT_LIST_LENGTH( pxReadyList ) > ( UBaseType_t ) 1 )
+                {
+                    for( pxIterator = listGET_HEAD_ENTRY( pxReadyList ); pxIterator != pxEndMarker; pxIterator = listGET_NEXT( pxIterator ) )
+                    {
+                        const TCB_t * const pxTCB = listGET_LIST_ITEM_OWNER( pxIterator ); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+
+                        if( ( pxTCB->xTaskRunState == taskTASK_NOT_RUNNING ) && ( taskCAN_RUN_ON_CORE( pxTCB, xCoreID ) != pdFALSE ) )
+                        {
+                            xReturn = pdTRUE;
+                            break;
+                        }
+                    }
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+        #else /* if ( ( configUSE_PREEMPTION == 1 ) && ( configUSE_TIME_SLICING == 1 ) ) */
+            {
+                ( void ) xCoreID;
+            }
+        #endif /* if ( ( configUSE_PREEMPTION == 1 ) && ( configUSE_TIME_SLICING == 1 ) ) */
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    void vTaskSwitchContext( BaseType_t xCoreID )
+    {
+        /* Called from the context switch interrupt of xCoreID with interrupts
+         * disabled.  The task lock is taken first: while another core has the
+         * scheduler suspended this waits, and if this core suspended it the
+         * switch is held pending as with one core. */
+        portGET_TASK_LOCK();
+        portGET_ISR_LOCK();
+        {
+            if( uxSchedulerSuspended != ( UBaseType_t ) pdFALSE )
+            {
+                /* The scheduler is currently suspended - do not allow a
+                 * context switch. */
+                xYieldPendings[ xCoreID ] = pdTRUE;
+            }
+            else
+            {
+                TCB_t * const pxPreviousTCB = pxCurrentTCBs[ xCoreID ];
+
+                xYieldPendings[ xCoreID ] = pdFALSE;
+                traceTASK_SWITCHED_OUT();
+
+                /* Check for stack overflow, if configured. */
+                taskCHECK_FOR_STACK_OVERFLOW();
+
+                prvSelectHighestPriorityTask( xCoreID );
+                traceTASK_SWITCHED_IN();
+
+                /* A task that is still ready but was switched out here (time
+                 * slice, affinity change) may preempt a lower priority task
+                 * on another core. */
+                #if ( configUSE_PREEMPTION == 1 )
+                    {
+                        if( ( pxPreviousTCB != pxCurrentTCBs[ xCoreID ] ) &&
+                            ( listIS_CONTAINED_WITHIN( &( pxReadyTasksLists[ pxPreviousTCB->uxPriority ] ), &( pxPreviousTCB->xStateListItem ) ) != pdFALSE ) )
+                        {
+                            prvYieldForTask( pxPreviousTCB );
+                        }
+                        else
+                        {
+                            mtCOVERAGE_TEST_MARKER();
+                        }
+                    }
+                #endif /* configUSE_PREEMPTION */
+            }
+        }
+        portRELEASE_ISR_LOCK();
+        portRELEASE_TASK_LOCK();
+    }
+
+#else /* configNUMBER_OF_CORES */
+
 void vTaskSwitchContext( void )
 {
     if( uxSchedulerSuspended != ( UBaseType_t ) pdFALSE )
@@ -3081,6 +3826,8 @@ void vTaskSwitchContext( void )
         #endif /* configUSE_NEWLIB_REENTRANT */
     }
 }
+
+#endif /* configNUMBER_OF_CORES */
 /*-----------------------------------------------------------*/
 
 void vTaskPlaceOnEventList( List_t * const pxEventList,
@@ -3210,6 +3957,28 @@ BaseType_t xTaskRemoveFromEventList( const List_t * const pxEventList )
         vListInsertEnd( &( xPendingReadyList ), &( pxUnblockedTCB->xEventListItem ) );
     }
 
+    #if ( configNUMBER_OF_CORES > 1 )
+        {
+            xReturn = pdFALSE;
+
+            /* A task held in the pending ready list is considered when the
+             * scheduler is resumed.  Otherwise return true only if this core
+             * must switch; another core is interrupted by prvYieldForTask(). */
+            #if ( configUSE_PREEMPTION == 1 )
+                {
+                    if( uxSchedulerSuspended == ( UBaseType_t ) pdFALSE )
+                    {
+                        prvYieldForTask( pxUnblockedTCB );
+
+                        if( xYieldPendings[ portGET_CORE_ID() ] != pdFALSE )
+                        {
+                            xReturn = pdTRUE;
+                        }
+                    }
+                }
+            #endif
+        }
+    #else /* configNUMBER_OF_CORES */
     if( pxUnblockedTCB->uxPriority > pxCurrentTCB->uxPriority )
     {
         /* Return true if the task removed from the event list has a higher
@@ -3225,6 +3994,7 @@ BaseType_t xTaskRemoveFromEventList( const List_t * const pxEventList )
     {
         xReturn = pdFALSE;
     }
+    #endif /* configNUMBER_OF_CORES */
 
     return xReturn;
 }
@@ -3268,6 +4038,21 @@ void vTaskRemoveFromUnorderedEventList( ListItem_t * pxEventListItem,
     ( void ) uxListRemove( &( pxUnblockedTCB->xStateListItem ) );
     prvAddTaskToReadyList( pxUnblockedTCB );
 
+    #if ( configNUMBER_OF_CORES > 1 )
+        {
+            /* The cores are chosen under the ISR lock.  A switch on this core
+             * is held pending until the scheduler is resumed. */
+            #if ( configUSE_PREEMPTION == 1 )
+                {
+                    taskENTER_CRITICAL();
+                    {
+                        prvYieldForTask( pxUnblockedTCB );
+                    }
+                    taskEXIT_CRITICAL();
+                }
+            #endif
+        }
+    #else /* configNUMBER_OF_CORES */
     if( pxUnblockedTCB->uxPriority > pxCurrentTCB->uxPriority )
     {
         /* The unblocked task has a priority above that of the calling task, so
@@ -3276,6 +4061,7 @@ void vTaskRemoveFromUnorderedEventList( ListItem_t * pxEventListItem,
          * occurs immediately that the scheduler is resumed (unsuspended). */
         xYieldPending = pdTRUE;
     }
+    #endif /* configNUMBER_OF_CORES */
 }
 /*-----------------------------------------------------------*/
 
@@ -3366,7 +4152,12 @@ BaseType_t xTaskCheckForTimeOut( TimeOut_t * const pxTimeOut,
 
 void vTaskMissedYield( void )
 {
-    xYieldPending = pdTRUE;
+    #if ( configNUMBER_OF_CORES > 1 )
+        /* Called from a critical section, so the core cannot change. */
+        xYieldPendings[ portGET_CORE_ID() ] = pdTRUE;
+    #else
+        xYieldPending = pdTRUE;
+    #endif
 }
 /*-----------------------------------------------------------*/
 
@@ -3459,8 +4250,10 @@ static portTASK_FUNCTION( prvIdleTask, pvParameters )
                  * A critical region is not required here as we are just reading from
                  * the list, and an occasional incorrect value will not matter.  If
                  * the ready list at the idle priority contains more than one task
-                 * then a task other than the idle task is ready to execute. */
-                if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ tskIDLE_PRIORITY ] ) ) > ( UBaseType_t ) 1 )
+                 * then a task other than the idle task is ready to execute.
+                 * With several cores the list also holds the idle task of each
+                 * core. */
+                if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ tskIDLE_PRIORITY ] ) ) > ( UBaseType_t ) configNUMBER_OF_CORES )
                 {
                     taskYIELD();
                 }
@@ -3537,6 +4330,40 @@ static portTASK_FUNCTION( prvIdleTask, pvParameters )
 }
 /*-----------------------------------------------------------*/
 
+#if ( configNUMBER_OF_CORES > 1 )
+
+    static portTASK_FUNCTION( prvPassiveIdleTask, pvParameters )
+    {
+        /* Stop warnings. */
+        ( void ) pvParameters;
+
+        for( ; ; )
+        {
+            #if ( configUSE_PREEMPTION == 0 )
+                {
+                    taskYIELD();
+                }
+            #endif /* configUSE_PREEMPTION */
+
+            #if ( ( configUSE_PREEMPTION == 1 ) && ( configIDLE_SHOULD_YIELD == 1 ) )
+                {
+                    /* See prvIdleTask(). */
+                    if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ tskIDLE_PRIORITY ] ) ) > ( UBaseType_t ) configNUMBER_OF_CORES )
+                    {
+                        taskYIELD();
+                    }
+                    else
+                    {
+                        mtCOVERAGE_TEST_MARKER();
+                    }
+                }
+            #endif /* ( ( configUSE_PREEMPTION == 1 ) && ( configIDLE_SHOULD_YIELD == 1 ) ) */
+        }
+    }
+
+#endif /* configNUMBER_OF_CORES */
+/*-----------------------------------------------------------*/
+
 #if ( configUSE_TICKLESS_IDLE != 0 )
 
     eSleepModeStatus eTaskConfirmSleepModeStatus( void )
@@ -3687,6 +4514,43 @@ static void prvCheckTasksWaitingTermination( void )
 
             /* uxDeletedTasksWaitingCleanUp is used to prevent taskENTER_CRITICAL()
              * being called too often in the idle task. */
+            #if ( configNUMBER_OF_CORES > 1 )
+                while( uxDeletedTasksWaitingCleanUp > ( UBaseType_t ) 0U )
+                {
+                    pxTCB = NULL;
+
+                    taskENTER_CRITICAL();
+                    {
+                        const ListItem_t * const pxEndMarker = listGET_END_MARKER( &xTasksWaitingTermination );
+                        ListItem_t * pxIterator;
+
+                        /* A task deleted while running on another core stays
+                         * in the list until that core has switched it out. */
+                        for( pxIterator = listGET_HEAD_ENTRY( &xTasksWaitingTermination ); pxIterator != pxEndMarker; pxIterator = listGET_NEXT( pxIterator ) )
+                        {
+                            TCB_t * const pxDeletedTCB = listGET_LIST_ITEM_OWNER( pxIterator ); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+
+                            if( pxDeletedTCB->xTaskRunState == taskTASK_NOT_RUNNING )
+                            {
+                                pxTCB = pxDeletedTCB;
+                                ( void ) uxListRemove( &( pxTCB->xStateListItem ) );
+                                --uxCurrentNumberOfTasks;
+                                --uxDeletedTasksWaitingCleanUp;
+                                break;
+                            }
+                        }
+                    }
+                    taskEXIT_CRITICAL();
+
+                    if( pxTCB == NULL )
+                    {
+                        /* Try again on the next pass of the idle task. */
+                        break;
+                    }
+
+                    prvDeleteTCB( pxTCB );
+                }
+            #else /* configNUMBER_OF_CORES */
             while( uxDeletedTasksWaitingCleanUp > ( UBaseType_t ) 0U )
             {
                 taskENTER_CRITICAL();
@@ -3700,6 +4564,7 @@ static void prvCheckTasksWaitingTermination( void )
 
                 prvDeleteTCB( pxTCB );
             }
+            #endif /* configNUMBER_OF_CORES */
         }
     #endif /* INCLUDE_vTaskDelete */
 }
@@ -4006,21 +4871,37 @@ static void prvResetNextTaskUnblockTime( void )
 }
 /*-----------------------------------------------------------*/
 
-#if ( ( INCLUDE_xTaskGetCurrentTaskHandle == 1 ) || ( configUSE_MUTEXES == 1 ) )
+#if ( ( INCLUDE_xTaskGetCurrentTaskHandle == 1 ) || ( configUSE_MUTEXES == 1 ) || ( configNUMBER_OF_CORES > 1 ) )
 
     TaskHandle_t xTaskGetCurrentTaskHandle( void )
     {
         TaskHandle_t xReturn;
 
-        /* A critical section is not required as this is not called from
-         * an interrupt and the current TCB will always be the same for any
-         * individual execution thread. */
-        xReturn = pxCurrentTCB;
+        #if ( configNUMBER_OF_CORES > 1 )
+            {
+                UBaseType_t uxSavedInterruptStatus;
+
+                /* The task could be switched to another core between reading
+                 * the core ID and indexing the array, so mask interrupts. */
+                uxSavedInterruptStatus = portSET_INTERRUPT_MASK();
+                {
+                    xReturn = pxCurrentTCBs[ portGET_CORE_ID() ];
+                }
+                portCLEAR_INTERRUPT_MASK( uxSavedInterruptStatus );
+            }
+        #else
+            {
+                /* A critical section is not required as this is not called from
+                 * an interrupt and the current TCB will always be the same for any
+                 * individual execution thread. */
+                xReturn = pxCurrentTCB;
+            }
+        #endif
 
         return xReturn;
     }
 
-#endif /* ( ( INCLUDE_xTaskGetCurrentTaskHandle == 1 ) || ( configUSE_MUTEXES == 1 ) ) */
+#endif /* ( ( INCLUDE_xTaskGetCurrentTaskHandle == 1 ) || ( configUSE_MUTEXES == 1 ) || ( configNUMBER_OF_CORES > 1 ) ) */
 /*-----------------------------------------------------------*/
 
 #if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
@@ -4307,6 +5188,21 @@ static void prvResetNextTaskUnblockTime( void )
                     {
                         mtCOVERAGE_TEST_MARKER();
                     }
+
+                    #if ( configNUMBER_OF_CORES > 1 )
+                        {
+                            /* The holder may be running on the other core with
+                             * the priority it no longer has. */
+                            if( taskTASK_IS_RUNNING( pxTCB ) && ( uxPriorityToUse < uxPriorityUsedOnEntry ) )
+                            {
+                                prvYieldCore( pxTCB->xTaskRunState );
+                            }
+                            else
+                            {
+                                mtCOVERAGE_TEST_MARKER();
+                            }
+                        }
+                    #endif
                 }
                 else
                 {
@@ -4390,6 +5286,219 @@ static void prvResetNextTaskUnblockTime( void )
 #endif /* portCRITICAL_NESTING_IN_TCB */
 /*-----------------------------------------------------------*/
 
+#if ( configNUMBER_OF_CORES > 1 )
+
+    void vTaskEnterCritical( void )
+    {
+        portDISABLE_INTERRUPTS();
+
+        if( xSchedulerRunning != pdFALSE )
+        {
+            /* The task lock keeps the other cores' tasks out, the ISR lock
+             * their interrupts.  Both are only taken by the outermost critical
+             * section of the core. */
+            if( portGET_CRITICAL_NESTING_COUNT() == 0U )
+            {
+                portGET_TASK_LOCK();
+                portGET_ISR_LOCK();
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            portINCREMENT_CRITICAL_NESTING_COUNT();
+
+            /* This is not the interrupt safe version of the enter critical
+             * function so  assert() if it is being called from an interrupt
+             * context.  Only API functions that end in "FromISR" can be used in an
+             * interrupt.  Only assert if the critical nesting count is 1 to
+             * protect against recursive calls if the assert function also uses a
+             * critical section. */
+            if( portGET_CRITICAL_NESTING_COUNT() == 1U )
+            {
+                portASSERT_IF_IN_ISR();
+            }
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    void vTaskExitCritical( void )
+    {
+        if( xSchedulerRunning != pdFALSE )
+        {
+            if( portGET_CRITICAL_NESTING_COUNT() > 0U )
+            {
+                portDECREMENT_CRITICAL_NESTING_COUNT();
+
+                if( portGET_CRITICAL_NESTING_COUNT() == 0U )
+                {
+                    /* A switch requested for this core inside the critical
+                     * section (prvYieldCore()) happens now. */
+                    const BaseType_t xYieldCurrentTask = xYieldPendings[ portGET_CORE_ID() ];
+
+                    portRELEASE_ISR_LOCK();
+                    portRELEASE_TASK_LOCK();
+                    portENABLE_INTERRUPTS();
+
+                    if( xYieldCurrentTask != pdFALSE )
+                    {
+                        portYIELD();
+                    }
+                    else
+                    {
+                        mtCOVERAGE_TEST_MARKER();
+                    }
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    UBaseType_t vTaskEnterCriticalFromISR( void )
+    {
+        UBaseType_t uxSavedInterruptStatus;
+
+        uxSavedInterruptStatus = portSET_INTERRUPT_MASK();
+
+        if( xSchedulerRunning != pdFALSE )
+        {
+            /* Interrupts only take the ISR lock.  While another core has the
+             * scheduler suspended they use the pending ready list, as with one
+             * core. */
+            if( portGET_CRITICAL_NESTING_COUNT() == 0U )
+            {
+                portGET_ISR_LOCK();
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            portINCREMENT_CRITICAL_NESTING_COUNT();
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        return uxSavedInterruptStatus;
+    }
+/*-----------------------------------------------------------*/
+
+    void vTaskExitCriticalFromISR( UBaseType_t uxSavedInterruptStatus )
+    {
+        if( xSchedulerRunning != pdFALSE )
+        {
+            if( portGET_CRITICAL_NESTING_COUNT() > 0U )
+            {
+                portDECREMENT_CRITICAL_NESTING_COUNT();
+
+                if( portGET_CRITICAL_NESTING_COUNT() == 0U )
+                {
+                    portRELEASE_ISR_LOCK();
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        portCLEAR_INTERRUPT_MASK( uxSavedInterruptStatus );
+    }
+
+#endif /* configNUMBER_OF_CORES */
+/*-----------------------------------------------------------*/
+
+#if ( ( configNUMBER_OF_CORES > 1 ) && ( configUSE_CORE_AFFINITY == 1 ) )
+
+    void vTaskCoreAffinitySet( const TaskHandle_t xTask,
+                               UBaseType_t uxCoreAffinityMask )
+    {
+        TCB_t * pxTCB;
+
+        taskENTER_CRITICAL();
+        {
+            pxTCB = prvGetTCBFromHandle( xTask );
+            pxTCB->uxCoreAffinityMask = uxCoreAffinityMask;
+
+            if( xSchedulerRunning != pdFALSE )
+            {
+                if( taskTASK_IS_RUNNING( pxTCB ) )
+                {
+                    /* Move the task off a core it may no longer use.  The
+                     * switch there readies it for the other cores. */
+                    if( taskCAN_RUN_ON_CORE( pxTCB, pxTCB->xTaskRunState ) == pdFALSE )
+                    {
+                        prvYieldCore( pxTCB->xTaskRunState );
+                    }
+                    else
+                    {
+                        mtCOVERAGE_TEST_MARKER();
+                    }
+                }
+                else if( listIS_CONTAINED_WITHIN( &( pxReadyTasksLists[ pxTCB->uxPriority ] ), &( pxTCB->xStateListItem ) ) != pdFALSE )
+                {
+                    /* The task may now preempt a core it could not use. */
+                    prvYieldForTask( pxTCB );
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        taskEXIT_CRITICAL();
+    }
+/*-----------------------------------------------------------*/
+
+    UBaseType_t vTaskCoreAffinityGet( const TaskHandle_t xTask )
+    {
+        const TCB_t * pxTCB;
+        UBaseType_t uxCoreAffinityMask;
+
+        taskENTER_CRITICAL();
+        {
+            pxTCB = prvGetTCBFromHandle( xTask );
+            uxCoreAffinityMask = pxTCB->uxCoreAffinityMask;
+        }
+        taskEXIT_CRITICAL();
+
+        return uxCoreAffinityMask;
+    }
+
+#endif /* ( ( configNUMBER_OF_CORES > 1 ) && ( configUSE_CORE_AFFINITY == 1 ) ) */
+/*-----------------------------------------------------------*/
+
 #if ( ( configUSE_TRACE_FACILITY == 1 ) && ( configUSE_STATS_FORMATTING_FUNCTIONS > 0 ) )
 
     static char * prvWriteNameToBuffer( char * pcBuffer,
@@ -4936,16 +6045,28 @@ TickType_t uxTaskResetEventItemValue( void )
                     }
                 #endif
 
-                if( pxTCB->uxPriority > pxCurrentTCB->uxPriority )
-                {
-                    /* The notified task has a priority above the currently
-                     * executing task so a yield is required. */
-                    taskYIELD_IF_USING_PREEMPTION();
-                }
-                else
-                {
-                    mtCOVERAGE_TEST_MARKER();
-                }
+                #if ( configNUMBER_OF_CORES > 1 )
+                    {
+                        /* A yield on this core happens when the critical
+                         * section is exited. */
+                        #if ( configUSE_PREEMPTION == 1 )
+                            {
+                                prvYieldForTask( pxTCB );
+                            }
+                        #endif
+                    }
+                #else
+                    if( pxTCB->uxPriority > pxCurrentTCB->uxPriority )
+                    {
+                        /* The notified task has a priority above the currently
+                         * executing task so a yield is required. */
+                        taskYIELD_IF_USING_PREEMPTION();
+                    }
+                    else
+                    {
+                        mtCOVERAGE_TEST_MARKER();
+                    }
+                #endif /* configNUMBER_OF_CORES */
             }
             else
             {
@@ -5071,6 +6192,25 @@ TickType_t uxTaskResetEventItemValue( void )
                     vListInsertEnd( &( xPendingReadyList ), &( pxTCB->xEventListItem ) );
                 }
 
+                #if ( configNUMBER_OF_CORES > 1 )
+                    {
+                        /* A task held in the pending ready list is considered
+                         * when the scheduler is resumed. */
+                        #if ( configUSE_PREEMPTION == 1 )
+                            {
+                                if( uxSchedulerSuspended == ( UBaseType_t ) pdFALSE )
+                                {
+                                    prvYieldForTask( pxTCB );
+
+                                    if( ( xYieldPendings[ portGET_CORE_ID() ] != pdFALSE ) && ( pxHigherPriorityTaskWoken != NULL ) )
+                                    {
+                                        *pxHigherPriorityTaskWoken = pdTRUE;
+                                    }
+                                }
+                            }
+                        #endif /* configUSE_PREEMPTION */
+                    }
+                #else /* configNUMBER_OF_CORES */
                 if( pxTCB->uxPriority > pxCurrentTCB->uxPriority )
                 {
                     /* The notified task has a priority above the currently
@@ -5089,6 +6229,7 @@ TickType_t uxTaskResetEventItemValue( void )
                 {
                     mtCOVERAGE_TEST_MARKER();
                 }
+                #endif /* configNUMBER_OF_CORES */
             }
         }
         portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
@@ -5162,6 +6303,25 @@ TickType_t uxTaskResetEventItemValue( void )
                     vListInsertEnd( &( xPendingReadyList ), &( pxTCB->xEventListItem ) );
                 }
 
+                #if ( configNUMBER_OF_CORES > 1 )
+                    {
+                        /* A task held in the pending ready list is considered
+                         * when the scheduler is resumed. */
+                        #if ( configUSE_PREEMPTION == 1 )
+                            {
+                                if( uxSchedulerSuspended == ( UBaseType_t ) pdFALSE )
+                                {
+                                    prvYieldForTask( pxTCB );
+
+                                    if( ( xYieldPendings[ portGET_CORE_ID() ] != pdFALSE ) && ( pxHigherPriorityTaskWoken != NULL ) )
+                                    {
+                                        *pxHigherPriorityTaskWoken = pdTRUE;
+                                    }
+                                }
+                            }
+                        #endif /* configUSE_PREEMPTION */
+                    }
+                #else /* configNUMBER_OF_CORES */
                 if( pxTCB->uxPriority > pxCurrentTCB->uxPriority )
                 {
                     /* The notified task has a priority above the currently
@@ -5180,6 +6340,7 @@ TickType_t uxTaskResetEventItemValue( void )
                 {
                     mtCOVERAGE_TEST_MARKER();
                 }
+                #endif /* configNUMBER_OF_CORES */
             }
         }
         portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
@@ -7,8 +7,24 @@
 #define xPortSysTickHandler     isr_systick
 
 #define configUSE_PREEMPTION                    1
+/* 1: mapa de bits das prioridades prontas + de Bruijn (port_select.h). Com
+ * as 5 prioridades daqui a seleção genérica empata com ele (select_bench);
+ * só compensa a partir de ~16 prioridades. */
 #define configUSE_PORT_OPTIMISED_TASK_SELECTION 0
+/* FREERTOS_SMP no CMake: o escalonador usa os dois núcleos do RP2040, com
+ * afinidade por tarefa (vTaskCoreAffinitySet). Cada núcleo tem seu SysTick,
+ * então o tickless fica desligado. */
+#ifdef FREERTOS_SMP
+#define configNUMBER_OF_CORES                   2
+#define configUSE_CORE_AFFINITY                 1
 #define configUSE_TICKLESS_IDLE                 0
+#else
+#define configNUMBER_OF_CORES                   1
+/* 2: a tarefa idle dorme até a próxima tarefa com um alarme do timer de 64
+ * bits do RP2040 (port.c, estatísticas em tickless.h). 1 é o tickless só com
+ * o SysTick, limitado a ~126 ms por sono. */
+#define configUSE_TICKLESS_IDLE                 2
+#endif
 #define configCPU_CLOCK_HZ                      133000000
 #define configTICK_RATE_HZ                      100
 #define configMAX_PRIORITIES                    5
@@ -31,9 +47,18 @@
 #define configMESSAGE_BUFFER_LENGTH_TYPE        size_t
 
 /* Memory allocation related definitions. */
+/* FREERTOS_STATIC no CMake: nada vem do heap, ver static_alloc.h */
+#ifdef FREERTOS_STATIC_ALLOCATION
+#define configSUPPORT_STATIC_ALLOCATION         1
+#define configSUPPORT_DYNAMIC_ALLOCATION        0
+#else
 #define configSUPPORT_STATIC_ALLOCATION         0
 #define configSUPPORT_DYNAMIC_ALLOCATION        1
-#define configAPPLICATION_ALLOCATED_HEAP        1
+#endif
+#define configAPPLICATION_ALLOCATED_HEAP        0
+/* Heaps tlsf e 4 (FREERTOS_HEAP no freertos/CMakeLists.txt); o heap_3 usa o
+ * malloc do newlib e ignora este valor */
+#define configTOTAL_HEAP_SIZE                   ( 64 * 1024 )
 
 /* Hook function related definitions. */
 #define configUSE_IDLE_HOOK                     0
@@ -81,4 +106,18 @@
 
 /* A header file that defines trace macro can be included here. */
 
+#if ( configUSE_PORT_OPTIMISED_TASK_SELECTION == 1 ) && !defined( __ASSEMBLER__ )
+#include "port_select.h"
+#endif
+
+/* Contadores de pvPortMalloc/vPortFree (heap_stats.c), com qualquer heap.
+ * Com o heap_3 são eles que o vPortGetHeapStats() devolve. */
+#ifndef __ASSEMBLER__
+extern volatile size_t xHeapStatsAllocations;
+extern volatile size_t xHeapStatsFrees;
+size_t xPortGetHeapOperations(void); /* alocações + liberações */
+#endif
+#define traceMALLOC( pvAddress, uiSize )    do { if( ( pvAddress ) != NULL ) { xHeapStatsAllocations++; } } while( 0 )
+#define traceFREE( pvAddress, uiSize )      do { xHeapStatsFrees++; } while( 0 )
+
 #endif /* FREERTOS_CONFIG_H */
@@ -0,0 +1,10 @@
+// heap_4.c com nomes próprios, para o heap_bench.c comparar os heaps no
+// mesmo programa
+#define pvPortMalloc heap4_malloc
+#define vPortFree heap4_free
+#define vPortInitialiseBlocks heap4_initialise_blocks
+#define xPortGetFreeHeapSize heap4_free_size
+#define xPortGetMinimumEverFreeHeapSize heap4_minimum_free_size
+#define vPortGetHeapStats heap4_stats
+
+#include "FreeRTOS-Kernel/portable/MemMang/heap_4.c"
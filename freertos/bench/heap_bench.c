@@ -0,0 +1,279 @@
+// Estressa no computador (não roda na Pico) os heaps do FreeRTOS que o
+// FREERTOS_HEAP do CMake escolhe: heap_3 (malloc da libc com o scheduler
+// suspenso; aqui, o malloc do computador), heap_4 (first fit em lista) e
+// heap_tlsf.c.
+//
+//   cc -O2 -Ibench/host -I. bench/heap_bench.c bench/heap_4_host.c bench/heap_tlsf_host.c -o heap_bench
+//   ./heap_bench
+//
+// Cada cenário mede a média e o percentil 99,9 do tempo de pvPortMalloc e
+// vPortFree e, no fim, a fragmentação (1 - maior bloco livre / total livre)
+// e os pedidos que falharam. O pior caso é o que importa num sistema de
+// tempo real; o p99,9 fica no lugar do máximo porque o máximo no computador
+// é dominado por preempção do sistema operacional. O malloc do computador
+// não é o newlib da Pico; ele entra só como referência.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+#include "heap_tlsf.h"
+
+void *heap4_malloc(size_t size);
+void heap4_free(void *pv);
+void heap4_stats(HeapStats_t *stats);
+void *tlsf_malloc(size_t size);
+void tlsf_free(void *pv);
+void tlsf_stats(HeapStats_t *stats);
+
+#define SLOTS 256
+// Blocos vivos no cenário aleatório (em média metade deles, ~20 KB)
+#define RANDOM_SLOTS 64
+#define MAX_SAMPLES 400000
+
+typedef struct {
+    const char *name;
+    void *(*alloc)(size_t size);
+    void (*free)(void *pv);
+    void (*stats)(HeapStats_t *stats); // NULL: sem estatísticas
+} heap_t;
+
+typedef struct {
+    float samples[MAX_SAMPLES];
+    uint32_t count;
+    double total_ns;
+} timing_t;
+
+typedef struct {
+    timing_t alloc, free;
+    uint32_t failures;
+} result_t;
+
+static void *slots[SLOTS];
+
+static uint32_t lcg_state;
+
+static uint32_t lcg(void) {
+    lcg_state = lcg_state * 1664525u + 1013904223u;
+    return lcg_state >> 8;
+}
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void add_sample(timing_t *t, double ns) {
+    if (t->count < MAX_SAMPLES) {
+        t->samples[t->count++] = (float)ns;
+        t->total_ns += ns;
+    }
+}
+
+static int compare_float(const void *a, const void *b) {
+    float x = *(const float *)a, y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(timing_t *t, double p) {
+    if (t->count == 0) {
+        return 0;
+    }
+    qsort(t->samples, t->count, sizeof(float), compare_float);
+    return t->samples[(uint32_t)((t->count - 1) * p)];
+}
+
+static void timed_alloc(const heap_t *heap, result_t *r, int slot, size_t size) {
+    double start = now_ns();
+    void *p = heap->alloc(size);
+    double elapsed = now_ns() - start;
+
+    if (p == NULL) {
+        r->failures++;
+        return;
+    }
+    memset(p, 0xa5, size < 64 ? size : 64);
+    slots[slot] = p;
+    add_sample(&r->alloc, elapsed);
+}
+
+static void timed_free(const heap_t *heap, result_t *r, int slot) {
+    double start = now_ns();
+    heap->free(slots[slot]);
+    double elapsed = now_ns() - start;
+
+    slots[slot] = NULL;
+    add_sample(&r->free, elapsed);
+}
+
+static void free_all(const heap_t *heap) {
+    for (int i = 0; i < SLOTS; i++) {
+        heap->free(slots[i]);
+        slots[i] = NULL;
+    }
+}
+
+// Tamanhos parecidos com os do firmware: listas e filas pequenas, TCBs,
+// a estrutura de ~2 KB por requisição e, de vez em quando, uma pilha
+static size_t firmware_size(void) {
+    uint32_t r = lcg() % 100;
+    if (r < 50) {
+        return 16 + lcg() % 112;
+    }
+    if (r < 80) {
+        return 128 + lcg() % 384;
+    }
+    if (r < 97) {
+        return 2048;
+    }
+    return 1024 * (2 + lcg() % 7);
+}
+
+// Alocações e liberações aleatórias com até RANDOM_SLOTS blocos vivos
+static void scenario_random(const heap_t *heap, result_t *r) {
+    for (int i = 0; i < 200000; i++) {
+        int slot = (int)(lcg() % RANDOM_SLOTS);
+        if (slots[slot] != NULL) {
+            timed_free(heap, r, slot);
+        } else {
+            timed_alloc(heap, r, slot, firmware_size());
+        }
+    }
+}
+
+// Heap picado: blocos pequenos alternados com buracos, depois o ciclo da
+// requisição (aloca e libera 2 KB). O first fit anda por todos os buracos.
+static void scenario_fragmented(const heap_t *heap, result_t *r) {
+    for (int i = 0; i < SLOTS - 1; i++) {
+        timed_alloc(heap, r, i, 48 + (i % 4) * 8);
+    }
+    for (int i = 0; i < SLOTS - 1; i += 2) {
+        timed_free(heap, r, i);
+    }
+    for (int i = 0; i < 100000; i++) {
+        timed_alloc(heap, r, SLOTS - 1, 2048);
+        if (slots[SLOTS - 1] != NULL) {
+            timed_free(heap, r, SLOTS - 1);
+        }
+    }
+}
+
+static void report(const heap_t *heap, result_t *r) {
+    printf("  %-10s malloc %6.1f ns (p99,9 %7.1f)  free %6.1f ns (p99,9 %7.1f)  falhas %4lu", heap->name,
+           r->alloc.total_ns / (r->alloc.count ? r->alloc.count : 1), percentile(&r->alloc, 0.999),
+           r->free.total_ns / (r->free.count ? r->free.count : 1), percentile(&r->free, 0.999),
+           (unsigned long)r->failures);
+
+    if (heap->stats != NULL) {
+        HeapStats_t stats;
+        heap->stats(&stats);
+        uint32_t fragmentation = stats.xAvailableHeapSpaceInBytes
+                                     ? (uint32_t)(1000 - (uint64_t)stats.xSizeOfLargestFreeBlockInBytes * 1000 /
+                                                             stats.xAvailableHeapSpaceInBytes)
+                                     : 0;
+        printf("  fragmentacao %4.1f%%  blocos livres %4zu", fragmentation / 10.0, stats.xNumberOfFreeBlocks);
+    }
+    printf("\n");
+}
+
+static void run(const char *name, void (*scenario)(const heap_t *, result_t *), const heap_t *heaps, int count) {
+    printf("%s\n", name);
+    static result_t r;
+
+    for (int i = 0; i < count; i++) {
+        memset(&r, 0, sizeof(r));
+        lcg_state = 12345;
+        scenario(&heaps[i], &r);
+        report(&heaps[i], &r);
+
+        // Os heaps 4 e tlsf continuam entre os cenários: libera tudo para o
+        // próximo começar com um bloco só
+        free_all(&heaps[i]);
+    }
+}
+
+// Confere a TLSF: padrão em cada bloco vivo, sem sobreposição, e tudo
+// livre de novo em um bloco só no fim
+static int check_tlsf(void) {
+    static uint8_t pattern[SLOTS];
+    static size_t sizes[SLOTS];
+
+    lcg_state = 777;
+    for (int i = 0; i < 100000; i++) {
+        int slot = (int)(lcg() % SLOTS);
+        if (slots[slot] != NULL) {
+            for (size_t j = 0; j < sizes[slot]; j++) {
+                if (((uint8_t *)slots[slot])[j] != pattern[slot]) {
+                    printf("ERRO: bloco %d sobrescrito\n", slot);
+                    return 1;
+                }
+            }
+            tlsf_free(slots[slot]);
+            slots[slot] = NULL;
+        } else {
+            sizes[slot] = firmware_size();
+            slots[slot] = tlsf_malloc(sizes[slot]);
+            if (slots[slot] != NULL) {
+                if (((uintptr_t)slots[slot] & portBYTE_ALIGNMENT_MASK) != 0) {
+                    printf("ERRO: bloco desalinhado\n");
+                    return 1;
+                }
+                pattern[slot] = (uint8_t)lcg();
+                memset(slots[slot], pattern[slot], sizes[slot]);
+            }
+        }
+    }
+    for (int i = 0; i < SLOTS; i++) {
+        tlsf_free(slots[i]);
+        slots[i] = NULL;
+    }
+
+    HeapStats_t stats;
+    tlsf_stats(&stats);
+    if (stats.xNumberOfFreeBlocks != 1 || stats.xSizeOfLargestFreeBlockInBytes != stats.xAvailableHeapSpaceInBytes) {
+        printf("ERRO: %zu blocos livres depois de liberar tudo\n", stats.xNumberOfFreeBlocks);
+        return 1;
+    }
+    if (ulPortGetHeapFragmentation() != 0) {
+        printf("ERRO: fragmentacao %lu com o heap vazio\n", (unsigned long)ulPortGetHeapFragmentation());
+        return 1;
+    }
+    return 0;
+}
+
+static void print_classes(void) {
+    HeapClassStats_t classes[HEAP_TLSF_CLASSES];
+    size_t count = xPortGetHeapClassStats(classes, HEAP_TLSF_CLASSES);
+
+    printf("tlsf por classe (desde o inicio do programa):\n");
+    for (size_t i = 0; i < count; i++) {
+        if (classes[i].ulAllocations > 0) {
+            printf("  >= %6zu bytes: %7lu alocacoes, %3lu em uso, maximo %3lu\n", classes[i].xMinSize,
+                   (unsigned long)classes[i].ulAllocations, (unsigned long)classes[i].ulInUse,
+                   (unsigned long)classes[i].ulHighWater);
+        }
+    }
+}
+
+int main(void) {
+    if (check_tlsf()) {
+        return 1;
+    }
+
+    static const heap_t heaps[] = {
+        {"heap_3", malloc, free, NULL},
+        {"heap_4", heap4_malloc, heap4_free, heap4_stats},
+        {"heap_tlsf", tlsf_malloc, tlsf_free, tlsf_stats},
+    };
+    int count = sizeof(heaps) / sizeof(heaps[0]);
+
+    printf("heap de %d bytes\n", configTOTAL_HEAP_SIZE);
+    run("aleatorio (tamanhos do firmware, ate 64 vivos):", scenario_random, heaps, count);
+    run("fragmentado (128 buracos de 48-72 bytes, depois 2 KB aloca/libera):", scenario_fragmented, heaps, count);
+    print_classes();
+    return 0;
+}
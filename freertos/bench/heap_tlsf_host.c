@@ -0,0 +1,10 @@
+// heap_tlsf.c com nomes próprios, para o heap_bench.c comparar os heaps no
+// mesmo programa
+#define pvPortMalloc tlsf_malloc
+#define vPortFree tlsf_free
+#define vPortInitialiseBlocks tlsf_initialise_blocks
+#define xPortGetFreeHeapSize tlsf_free_size
+#define xPortGetMinimumEverFreeHeapSize tlsf_minimum_free_size
+#define vPortGetHeapStats tlsf_stats
+
+#include "heap_tlsf.c"
@@ -0,0 +1,50 @@
+#ifndef FREERTOS_H
+#define FREERTOS_H
+
+// FreeRTOS.h mínimo para compilar os heaps no computador (bench/heap_bench.c):
+// sem scheduler, vTaskSuspendAll/xTaskResumeAll não fazem nada e os ponteiros
+// têm 64 bits.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define configSUPPORT_DYNAMIC_ALLOCATION 1
+#define configAPPLICATION_ALLOCATED_HEAP 0
+#define configUSE_MALLOC_FAILED_HOOK 0
+#ifndef configTOTAL_HEAP_SIZE
+#define configTOTAL_HEAP_SIZE (64 * 1024)
+#endif
+
+#define portBYTE_ALIGNMENT 8
+#define portBYTE_ALIGNMENT_MASK 0x0007
+#define portPOINTER_SIZE_TYPE uintptr_t
+#define PRIVILEGED_DATA
+#define PRIVILEGED_FUNCTION
+
+#define configASSERT(x)
+#define mtCOVERAGE_TEST_MARKER()
+#define traceMALLOC(pvAddress, uiSize)
+#define traceFREE(pvAddress, uiSize)
+
+typedef long BaseType_t;
+typedef uint32_t TickType_t;
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+
+typedef struct xHeapStats {
+    size_t xAvailableHeapSpaceInBytes;
+    size_t xSizeOfLargestFreeBlockInBytes;
+    size_t xSizeOfSmallestFreeBlockInBytes;
+    size_t xNumberOfFreeBlocks;
+    size_t xMinimumEverFreeBytesRemaining;
+    size_t xNumberOfSuccessfulAllocations;
+    size_t xNumberOfSuccessfulFrees;
+} HeapStats_t;
+
+void *pvPortMalloc(size_t xSize);
+void vPortFree(void *pv);
+void vPortInitialiseBlocks(void);
+size_t xPortGetFreeHeapSize(void);
+size_t xPortGetMinimumEverFreeHeapSize(void);
+void vPortGetHeapStats(HeapStats_t *pxHeapStats);
+
+#endif
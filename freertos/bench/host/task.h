@@ -0,0 +1,15 @@
+#ifndef TASK_H
+#define TASK_H
+
+// Ver FreeRTOS.h desta pasta
+static inline void vTaskSuspendAll(void) {
+}
+
+static inline BaseType_t xTaskResumeAll(void) {
+    return 0;
+}
+
+#define taskENTER_CRITICAL()
+#define taskEXIT_CRITICAL()
+
+#endif
@@ -0,0 +1,127 @@
+// Compara no computador (não roda na Pico) as duas formas do tasks.c de
+// achar a tarefa pronta de maior prioridade:
+//
+// - genérica (configUSE_PORT_OPTIMISED_TASK_SELECTION 0): uxTopReadyPriority
+//   é um número e a seleção desce por listas vazias até achar uma pronta;
+// - mapa de bits (1): um bit por prioridade e ulPortHighestBit()
+//   (port_select.h).
+//
+// O padrão é o do CONTEXT_SWITCH_BENCHMARK do main_webserver: uma tarefa na
+// prioridade mais alta acorda e bloqueia, e a seleção volta para uma tarefa
+// na prioridade 1, com configMAX_PRIORITIES de 5 a 32. Cada tempo é o
+// melhor de REPEATS medidas, para tirar o ruído do computador.
+//
+//   cc -O2 -I. bench/select_bench.c -o select_bench
+//   ./select_bench
+//
+// Os tempos do computador não valem para o M0+; o que importa é como cada
+// forma cresce com configMAX_PRIORITIES. Na placa, os ciclos da
+// troca completa saem do CONTEXT_SWITCH_BENCHMARK.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#define configMAX_PRIORITIES 32
+#include "port_select.h"
+
+#define ROUNDS 20000000
+#define REPEATS 5
+#define LOW_PRIORITY 1
+
+// Tarefas prontas em cada prioridade (o tamanho de cada lista no tasks.c)
+static volatile uint32_t ready[configMAX_PRIORITIES];
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// taskRECORD_READY_PRIORITY / taskSELECT_HIGHEST_PRIORITY_TASK genéricos
+static uint32_t generic_round(uint32_t *top, uint32_t high) {
+    ready[high]++;
+    if (high > *top) {
+        *top = high;
+    }
+    uint32_t selected = *top;
+
+    ready[high]--;
+    while (ready[*top] == 0) {
+        --*top;
+    }
+    return selected + *top;
+}
+
+static uint32_t bitmap_round(uint32_t *bitmap, uint32_t high) {
+    uint32_t top;
+
+    ready[high]++;
+    portRECORD_READY_PRIORITY(high, *bitmap);
+    portGET_HIGHEST_PRIORITY(top, *bitmap);
+    uint32_t selected = top;
+
+    if (--ready[high] == 0) {
+        portRESET_READY_PRIORITY(high, *bitmap);
+    }
+    portGET_HIGHEST_PRIORITY(top, *bitmap);
+    return selected + top;
+}
+
+static void run(uint32_t max_priorities) {
+    uint32_t high = max_priorities - 1;
+    volatile uint32_t sink = 0;
+    double generic = 0, optimised = 0;
+
+    ready[LOW_PRIORITY] = 1;
+
+    for (int r = 0; r < REPEATS; r++) {
+        uint32_t top = LOW_PRIORITY;
+        double start = now_ns();
+        for (int i = 0; i < ROUNDS; i++) {
+            sink += generic_round(&top, high);
+        }
+        double t = (now_ns() - start) / ROUNDS;
+        if (r == 0 || t < generic) {
+            generic = t;
+        }
+
+        uint32_t bitmap = 1u << LOW_PRIORITY;
+        start = now_ns();
+        for (int i = 0; i < ROUNDS; i++) {
+            sink += bitmap_round(&bitmap, high);
+        }
+        t = (now_ns() - start) / ROUNDS;
+        if (r == 0 || t < optimised) {
+            optimised = t;
+        }
+    }
+
+    printf("configMAX_PRIORITIES %2lu: generica %5.2f ns, mapa de bits %5.2f ns por volta (2 selecoes)\n",
+           (unsigned long)max_priorities, generic, optimised);
+}
+
+static int check(void) {
+    for (uint32_t bit = 0; bit < 32; bit++) {
+        for (uint32_t below = 0; below < 64; below++) {
+            uint32_t bitmap = (1u << bit) | ((below * 2654435761u) & ((1u << bit) - 1));
+            if (ulPortHighestBit(bitmap) != bit) {
+                printf("ERRO: bitmap %08lx -> %lu\n", (unsigned long)bitmap, (unsigned long)ulPortHighestBit(bitmap));
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+int main(void) {
+    if (check()) {
+        return 1;
+    }
+    static const uint32_t priorities[] = {5, 8, 12, 16, 24, 32};
+    for (size_t i = 0; i < sizeof(priorities) / sizeof(priorities[0]); i++) {
+        run(priorities[i]);
+    }
+    return 0;
+}
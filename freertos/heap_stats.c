@@ -0,0 +1,27 @@
+#include <string.h>
+
+#include "FreeRTOS.h"
+
+// Contadores alimentados por traceMALLOC/traceFREE (FreeRTOSConfig.h), com
+// o scheduler suspenso, qualquer que seja o heap.
+volatile size_t xHeapStatsAllocations = 0;
+volatile size_t xHeapStatsFrees = 0;
+
+// Chamadas a pvPortMalloc/vPortFree desde o boot. O caminho das requisições
+// das aplicações usa só memória estática (http_client e dns_cache têm pools
+// fixos e a conclusão vem por notificação de tarefa), então a diferença entre
+// duas leituras em volta de uma requisição deve ser 0.
+size_t xPortGetHeapOperations(void) {
+    return xHeapStatsAllocations + xHeapStatsFrees;
+}
+
+// O heap_3 só repassa para o malloc da libc e não implementa
+// vPortGetHeapStats(), e no modo estático não há heap (os contadores ficam
+// em 0); os heaps 4 e tlsf têm o seu.
+#if defined(FREERTOS_HEAP_3) || (configSUPPORT_DYNAMIC_ALLOCATION == 0)
+void vPortGetHeapStats(HeapStats_t *pxHeapStats) {
+    memset(pxHeapStats, 0, sizeof(*pxHeapStats));
+    pxHeapStats->xNumberOfSuccessfulAllocations = xHeapStatsAllocations;
+    pxHeapStats->xNumberOfSuccessfulFrees = xHeapStatsFrees;
+}
+#endif
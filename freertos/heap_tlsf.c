@@ -0,0 +1,397 @@
+#include <string.h>
+
+// Impede o task.h de redefinir as APIs para os wrappers da MPU
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "heap_tlsf.h"
+#include "port_select.h"
+
+// Ver heap_tlsf.h.
+//
+// Cada bloco começa com o endereço do bloco físico anterior e o tamanho do
+// payload; o bit 0 do tamanho marca o bloco livre. Um bloco livre guarda no
+// próprio payload os ponteiros da lista da sua faixa. Depois do último bloco
+// há uma sentinela de tamanho 0, sempre "em uso", para a junção parar ali.
+// Os bytes livres contados são a soma dos payloads livres.
+
+#if (configSUPPORT_DYNAMIC_ALLOCATION == 0)
+#error heap_tlsf.c precisa de configSUPPORT_DYNAMIC_ALLOCATION 1
+#endif
+
+#if (configAPPLICATION_ALLOCATED_HEAP == 1)
+extern uint8_t ucHeap[configTOTAL_HEAP_SIZE];
+#else
+PRIVILEGED_DATA static uint8_t ucHeap[configTOTAL_HEAP_SIZE];
+#endif
+
+_Static_assert(configTOTAL_HEAP_SIZE < (1UL << HEAP_TLSF_FL_MAX), "aumente HEAP_TLSF_FL_MAX");
+
+typedef struct tlsf_block {
+    struct tlsf_block *prev_phys;
+    size_t size; // payload, em múltiplos de portBYTE_ALIGNMENT; bit 0: livre
+    // Só em blocos livres
+    struct tlsf_block *next_free;
+    struct tlsf_block *prev_free;
+} tlsf_block_t;
+
+#define BLOCK_FREE_BIT ((size_t)1)
+#define BLOCK_HEADER offsetof(tlsf_block_t, next_free)
+#define BLOCK_HEADER_SIZE ((BLOCK_HEADER + portBYTE_ALIGNMENT_MASK) & ~(size_t)portBYTE_ALIGNMENT_MASK)
+// Um bloco livre precisa caber os dois ponteiros da lista
+#define BLOCK_MIN_PAYLOAD ((sizeof(tlsf_block_t) - BLOCK_HEADER + portBYTE_ALIGNMENT_MASK) & ~(size_t)portBYTE_ALIGNMENT_MASK)
+#define SMALL_BLOCK_SIZE ((size_t)1 << HEAP_TLSF_FL_SHIFT)
+
+PRIVILEGED_DATA static uint32_t ulFlBitmap;
+PRIVILEGED_DATA static uint32_t ulSlBitmap[HEAP_TLSF_CLASSES];
+PRIVILEGED_DATA static tlsf_block_t *pxFreeLists[HEAP_TLSF_CLASSES][HEAP_TLSF_SL_COUNT];
+PRIVILEGED_DATA static tlsf_block_t *pxFirstBlock = NULL;
+
+PRIVILEGED_DATA static size_t xTotalBytes = 0;
+PRIVILEGED_DATA static size_t xFreeBytesRemaining = 0;
+PRIVILEGED_DATA static size_t xMinimumEverFreeBytesRemaining = 0;
+PRIVILEGED_DATA static size_t xFreeBlocks = 0;
+PRIVILEGED_DATA static size_t xSuccessfulAllocations = 0;
+PRIVILEGED_DATA static size_t xSuccessfulFrees = 0;
+PRIVILEGED_DATA static HeapClassStats_t xClassStats[HEAP_TLSF_CLASSES];
+
+// --- Blocos --------------------------------------------------------------
+
+static inline size_t block_size(const tlsf_block_t *block) {
+    return block->size & ~BLOCK_FREE_BIT;
+}
+
+static inline int block_is_free(const tlsf_block_t *block) {
+    return (block->size & BLOCK_FREE_BIT) != 0;
+}
+
+static inline void *block_payload(tlsf_block_t *block) {
+    return (uint8_t *)block + BLOCK_HEADER_SIZE;
+}
+
+static inline tlsf_block_t *block_from_payload(void *pv) {
+    return (tlsf_block_t *)((uint8_t *)pv - BLOCK_HEADER_SIZE);
+}
+
+static inline tlsf_block_t *block_next(tlsf_block_t *block) {
+    return (tlsf_block_t *)((uint8_t *)block_payload(block) + block_size(block));
+}
+
+// --- Mapeamento tamanho -> lista ------------------------------------------
+
+// Bit mais baixo de um valor diferente de 0
+static inline uint32_t lowest_bit(uint32_t value) {
+    return ulPortHighestBit(value & (0u - value));
+}
+
+// Lista onde um bloco livre de size bytes é guardado
+static void mapping_insert(size_t size, uint32_t *fl, uint32_t *sl) {
+    if (size < SMALL_BLOCK_SIZE) {
+        *fl = 0;
+        *sl = (uint32_t)(size / (SMALL_BLOCK_SIZE / HEAP_TLSF_SL_COUNT));
+    } else {
+        uint32_t bit = ulPortHighestBit((uint32_t)size);
+        *sl = (uint32_t)(size >> (bit - HEAP_TLSF_SL_LOG2)) ^ HEAP_TLSF_SL_COUNT;
+        *fl = bit - (HEAP_TLSF_FL_SHIFT - 1);
+    }
+}
+
+// Primeira lista em que qualquer bloco serve para size bytes: arredonda
+// para cima até a próxima subfaixa
+static void mapping_search(size_t size, uint32_t *fl, uint32_t *sl) {
+    if (size >= SMALL_BLOCK_SIZE) {
+        size += ((size_t)1 << (ulPortHighestBit((uint32_t)size) - HEAP_TLSF_SL_LOG2)) - 1;
+    }
+    mapping_insert(size, fl, sl);
+}
+
+static tlsf_block_t *find_suitable(uint32_t *fl, uint32_t *sl) {
+    if (*fl >= HEAP_TLSF_CLASSES) {
+        return NULL;
+    }
+
+    uint32_t sl_map = ulSlBitmap[*fl] & (~0u << *sl);
+    if (sl_map == 0) {
+        // Nenhuma subfaixa serve: primeira classe maior que tenha blocos
+        uint32_t fl_map = ulFlBitmap & (~0u << (*fl + 1));
+        if (fl_map == 0) {
+            return NULL;
+        }
+        *fl = lowest_bit(fl_map);
+        sl_map = ulSlBitmap[*fl];
+    }
+    *sl = lowest_bit(sl_map);
+    return pxFreeLists[*fl][*sl];
+}
+
+static void remove_free(tlsf_block_t *block, uint32_t fl, uint32_t sl) {
+    if (block->prev_free != NULL) {
+        block->prev_free->next_free = block->next_free;
+    } else {
+        pxFreeLists[fl][sl] = block->next_free;
+        if (block->next_free == NULL) {
+            ulSlBitmap[fl] &= ~(1u << sl);
+            if (ulSlBitmap[fl] == 0) {
+                ulFlBitmap &= ~(1u << fl);
+            }
+        }
+    }
+    if (block->next_free != NULL) {
+        block->next_free->prev_free = block->prev_free;
+    }
+    block->size &= ~BLOCK_FREE_BIT;
+    xFreeBlocks--;
+}
+
+static void remove_free_block(tlsf_block_t *block) {
+    uint32_t fl, sl;
+    mapping_insert(block_size(block), &fl, &sl);
+    remove_free(block, fl, sl);
+}
+
+static void insert_free_block(tlsf_block_t *block) {
+    uint32_t fl, sl;
+    mapping_insert(block_size(block), &fl, &sl);
+
+    block->size |= BLOCK_FREE_BIT;
+    block->prev_free = NULL;
+    block->next_free = pxFreeLists[fl][sl];
+    if (block->next_free != NULL) {
+        block->next_free->prev_free = block;
+    }
+    pxFreeLists[fl][sl] = block;
+    ulSlBitmap[fl] |= 1u << sl;
+    ulFlBitmap |= 1u << fl;
+    xFreeBlocks++;
+}
+
+// --- Heap ------------------------------------------------------------------
+
+static void heap_init(void) {
+    uintptr_t start = ((uintptr_t)ucHeap + portBYTE_ALIGNMENT_MASK) & ~(uintptr_t)portBYTE_ALIGNMENT_MASK;
+    uintptr_t end = ((uintptr_t)ucHeap + configTOTAL_HEAP_SIZE) & ~(uintptr_t)portBYTE_ALIGNMENT_MASK;
+
+    pxFirstBlock = (tlsf_block_t *)start;
+    pxFirstBlock->prev_phys = NULL;
+    pxFirstBlock->size = end - start - 2 * BLOCK_HEADER_SIZE;
+
+    tlsf_block_t *sentinel = block_next(pxFirstBlock);
+    sentinel->prev_phys = pxFirstBlock;
+    sentinel->size = 0;
+
+    insert_free_block(pxFirstBlock);
+
+    xTotalBytes = block_size(pxFirstBlock);
+    xFreeBytesRemaining = xTotalBytes;
+    xMinimumEverFreeBytesRemaining = xTotalBytes;
+
+    for (uint32_t i = 0; i < HEAP_TLSF_CLASSES; i++) {
+        xClassStats[i].xMinSize = i == 0 ? 0 : (size_t)1 << (i + HEAP_TLSF_FL_SHIFT - 1);
+    }
+}
+
+// Classe de estatística de um bloco: o primeiro nível do tamanho
+static uint32_t stats_class(size_t size) {
+    uint32_t fl, sl;
+    mapping_insert(size, &fl, &sl);
+    return fl;
+}
+
+void *pvPortMalloc(size_t xWantedSize) {
+    void *pvReturn = NULL;
+
+    vTaskSuspendAll();
+    {
+        if (pxFirstBlock == NULL) {
+            heap_init();
+        }
+
+        if (xWantedSize > 0 && xWantedSize <= xTotalBytes) {
+            size_t size = (xWantedSize + portBYTE_ALIGNMENT_MASK) & ~(size_t)portBYTE_ALIGNMENT_MASK;
+            if (size < BLOCK_MIN_PAYLOAD) {
+                size = BLOCK_MIN_PAYLOAD;
+            }
+
+            uint32_t fl, sl;
+            mapping_search(size, &fl, &sl);
+            tlsf_block_t *block = find_suitable(&fl, &sl);
+
+            if (block != NULL) {
+                remove_free(block, fl, sl);
+                xFreeBytesRemaining -= block_size(block);
+
+                // O que sobra vira um bloco livre, se couber um
+                size_t remaining = block_size(block) - size;
+                if (remaining >= BLOCK_HEADER_SIZE + BLOCK_MIN_PAYLOAD) {
+                    tlsf_block_t *rest = (tlsf_block_t *)((uint8_t *)block_payload(block) + size);
+                    rest->prev_phys = block;
+                    rest->size = remaining - BLOCK_HEADER_SIZE;
+                    block_next(rest)->prev_phys = rest;
+                    block->size = size;
+                    insert_free_block(rest);
+                    xFreeBytesRemaining += block_size(rest);
+                }
+
+                if (xFreeBytesRemaining < xMinimumEverFreeBytesRemaining) {
+                    xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+                }
+                xSuccessfulAllocations++;
+
+                HeapClassStats_t *stats = &xClassStats[stats_class(block_size(block))];
+                stats->ulAllocations++;
+                if (++stats->ulInUse > stats->ulHighWater) {
+                    stats->ulHighWater = stats->ulInUse;
+                }
+
+                pvReturn = block_payload(block);
+            }
+        }
+
+        traceMALLOC(pvReturn, xWantedSize);
+    }
+    (void)xTaskResumeAll();
+
+#if (configUSE_MALLOC_FAILED_HOOK == 1)
+    if (pvReturn == NULL) {
+        extern void vApplicationMallocFailedHook(void);
+        vApplicationMallocFailedHook();
+    }
+#endif
+
+    return pvReturn;
+}
+
+void vPortFree(void *pv) {
+    if (pv == NULL) {
+        return;
+    }
+
+    tlsf_block_t *block = block_from_payload(pv);
+    configASSERT(!block_is_free(block));
+
+    vTaskSuspendAll();
+    {
+        HeapClassStats_t *stats = &xClassStats[stats_class(block_size(block))];
+        if (stats->ulInUse > 0) {
+            stats->ulInUse--;
+        }
+
+        xFreeBytesRemaining += block_size(block);
+        xSuccessfulFrees++;
+        traceFREE(pv, block_size(block));
+
+        // Junta com o vizinho de trás e com o da frente, se estiverem livres
+        tlsf_block_t *prev = block->prev_phys;
+        if (prev != NULL && block_is_free(prev)) {
+            remove_free_block(prev);
+            prev->size += BLOCK_HEADER_SIZE + block_size(block);
+            xFreeBytesRemaining += BLOCK_HEADER_SIZE;
+            block = prev;
+            block_next(block)->prev_phys = block;
+        }
+
+        tlsf_block_t *next = block_next(block);
+        if (block_is_free(next)) {
+            remove_free_block(next);
+            block->size += BLOCK_HEADER_SIZE + block_size(next);
+            xFreeBytesRemaining += BLOCK_HEADER_SIZE;
+            block_next(block)->prev_phys = block;
+        }
+
+        insert_free_block(block);
+    }
+    (void)xTaskResumeAll();
+}
+
+size_t xPortGetFreeHeapSize(void) {
+    return xFreeBytesRemaining;
+}
+
+size_t xPortGetMinimumEverFreeHeapSize(void) {
+    return xMinimumEverFreeBytesRemaining;
+}
+
+void vPortInitialiseBlocks(void) {
+    // Inicializado no primeiro pvPortMalloc
+}
+
+// Maior bloco livre: está na lista não vazia mais alta, que só tem blocos
+// da mesma subfaixa; percorre só essa lista
+static size_t largest_free_block(void) {
+    if (ulFlBitmap == 0) {
+        return 0;
+    }
+    uint32_t fl = ulPortHighestBit(ulFlBitmap);
+    uint32_t sl = ulPortHighestBit(ulSlBitmap[fl]);
+
+    size_t largest = 0;
+    for (tlsf_block_t *block = pxFreeLists[fl][sl]; block != NULL; block = block->next_free) {
+        if (block_size(block) > largest) {
+            largest = block_size(block);
+        }
+    }
+    return largest;
+}
+
+void vPortGetHeapStats(HeapStats_t *pxHeapStats) {
+    memset(pxHeapStats, 0, sizeof(*pxHeapStats));
+
+    vTaskSuspendAll();
+    {
+        pxHeapStats->xSizeOfLargestFreeBlockInBytes = largest_free_block();
+
+        // Menor bloco livre: na lista não vazia mais baixa
+        if (ulFlBitmap != 0) {
+            uint32_t fl = lowest_bit(ulFlBitmap);
+            uint32_t sl = lowest_bit(ulSlBitmap[fl]);
+            size_t smallest = SIZE_MAX;
+            for (tlsf_block_t *block = pxFreeLists[fl][sl]; block != NULL; block = block->next_free) {
+                if (block_size(block) < smallest) {
+                    smallest = block_size(block);
+                }
+            }
+            pxHeapStats->xSizeOfSmallestFreeBlockInBytes = smallest;
+        }
+
+        pxHeapStats->xAvailableHeapSpaceInBytes = xFreeBytesRemaining;
+        pxHeapStats->xNumberOfFreeBlocks = xFreeBlocks;
+        pxHeapStats->xMinimumEverFreeBytesRemaining = xMinimumEverFreeBytesRemaining;
+        pxHeapStats->xNumberOfSuccessfulAllocations = xSuccessfulAllocations;
+        pxHeapStats->xNumberOfSuccessfulFrees = xSuccessfulFrees;
+    }
+    (void)xTaskResumeAll();
+}
+
+size_t xPortGetHeapClassStats(HeapClassStats_t *pxClasses, size_t xMax) {
+    size_t count = xMax < HEAP_TLSF_CLASSES ? xMax : HEAP_TLSF_CLASSES;
+
+    vTaskSuspendAll();
+    {
+        if (pxFirstBlock == NULL) {
+            heap_init();
+        }
+        memcpy(pxClasses, xClassStats, count * sizeof(HeapClassStats_t));
+    }
+    (void)xTaskResumeAll();
+    return count;
+}
+
+uint32_t ulPortGetHeapFragmentation(void) {
+    size_t largest, free_bytes;
+
+    vTaskSuspendAll();
+    {
+        largest = largest_free_block();
+        free_bytes = xFreeBytesRemaining;
+    }
+    (void)xTaskResumeAll();
+
+    if (free_bytes == 0) {
+        return 0;
+    }
+    return (uint32_t)(1000 - (uint64_t)largest * 1000 / free_bytes);
+}
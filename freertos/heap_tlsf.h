@@ -0,0 +1,44 @@
+#ifndef HEAP_TLSF_H
+#define HEAP_TLSF_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Heap TLSF (two-level segregated fit) do FreeRTOS, heap_tlsf.c.
+//
+// Os blocos livres ficam em listas por faixa de tamanho: um primeiro nível
+// por potência de 2 e, dentro dele, HEAP_TLSF_SL_COUNT subfaixas lineares.
+// Dois níveis de mapa de bits dizem quais listas têm blocos, e o bit certo
+// sai de ulPortHighestBit() (port_select.h). pvPortMalloc e vPortFree não
+// percorrem listas: tempo constante, qualquer que seja o estado do heap.
+// Blocos vizinhos livres são juntados no vPortFree.
+
+// Subfaixas por potência de 2 (2^4 = 16): o desperdício por arredondamento
+// fica abaixo de 1/16 do pedido
+#define HEAP_TLSF_SL_LOG2 4
+#define HEAP_TLSF_SL_COUNT (1 << HEAP_TLSF_SL_LOG2)
+
+// Maior bloco: 2^HEAP_TLSF_FL_MAX (128 KB, mais que o heap na Pico)
+#define HEAP_TLSF_FL_MAX 17
+
+// Blocos menores que 2^HEAP_TLSF_FL_SHIFT ficam todos na classe 0
+#define HEAP_TLSF_FL_SHIFT (HEAP_TLSF_SL_LOG2 + 3)
+#define HEAP_TLSF_CLASSES (HEAP_TLSF_FL_MAX - HEAP_TLSF_FL_SHIFT + 1)
+
+// Uso por classe de tamanho (primeiro nível), pelo tamanho do bloco entregue
+// (o pedido arredondado para a subfaixa)
+typedef struct {
+    size_t xMinSize;        // blocos a partir deste tamanho (até o xMinSize da próxima)
+    uint32_t ulAllocations; // pvPortMalloc bem-sucedidos desde o boot
+    uint32_t ulInUse;       // blocos alocados agora
+    uint32_t ulHighWater;   // maior ulInUse já visto
+} HeapClassStats_t;
+
+// Copia até xMax classes e retorna quantas copiou
+size_t xPortGetHeapClassStats(HeapClassStats_t *pxClasses, size_t xMax);
+
+// Fragmentação em milésimos: 1 - maior bloco livre / total livre. 0 quando
+// todo o espaço livre está em um bloco só.
+uint32_t ulPortGetHeapFragmentation(void);
+
+#endif
@@ -95,9 +95,34 @@ static void prvTaskExitError( void );
 
 /*-----------------------------------------------------------*/
 
+#if ( configNUMBER_OF_CORES == 1 )
+
 /* Each task maintains its own interrupt status in the critical nesting
  * variable. */
-static UBaseType_t uxCriticalNesting = 0xaaaaaaaa;
+    static UBaseType_t uxCriticalNesting = 0xaaaaaaaa;
+#else
+
+/*
+ * SMP: one critical nesting count per core (read by the kernel through
+ * portGET_CRITICAL_NESTING_COUNT()), the two recursive locks of portmacro.h
+ * on top of the hardware spinlocks the SDK reserves for the RTOS, and the
+ * inter-core FIFO to make the other core yield.
+ */
+    #include "hardware/irq.h"
+    #include "hardware/sync.h"
+    #include "pico/multicore.h"
+
+    #define portRTOS_SPINLOCK_COUNT    2
+
+    UBaseType_t uxCriticalNestings[ configNUMBER_OF_CORES ] = { 0 };
+
+    static uint8_t ucOwnedByCore[ configNUMBER_OF_CORES ][ portRTOS_SPINLOCK_COUNT ];
+    static uint8_t ucRecursionCountByLock[ portRTOS_SPINLOCK_COUNT ];
+
+    static void prvFIFOInterruptHandler( void );
+    static void prvCore1Start( void );
+    static void prvStartSchedulerOnThisCore( void );
+#endif /* configNUMBER_OF_CORES */
 
 /*-----------------------------------------------------------*/
 
@@ -124,6 +149,25 @@ static UBaseType_t uxCriticalNesting = 0xaaaaaaaa;
     static uint32_t ulStoppedTimerCompensation = 0;
 #endif /* configUSE_TICKLESS_IDLE */
 
+/*
+ * Tickless idle driven by the RP2040 64-bit microsecond timer instead of the
+ * 24-bit SysTick (see vPortSuppressTicksAndSleep() at the end of the file).
+ */
+#if ( configUSE_TICKLESS_IDLE == 2 )
+    #include "hardware/timer.h"
+    #include "tickless.h"
+
+    #define portTICK_PERIOD_US           ( 1000000UL / configTICK_RATE_HZ )
+    #define portSYSTICK_COUNTS_PER_US    ( configCPU_CLOCK_HZ / 1000000UL )
+    #define portNVIC_PENDSTSET_BIT       ( 1UL << 26UL )
+
+    static int lTicklessAlarm = -1;
+    static uint64_t ullSchedulerStartUs = 0;
+    static TicklessStats_t xTicklessStats;
+
+    static void prvTicklessAlarmCallback( uint alarm_num );
+#endif /* configUSE_TICKLESS_IDLE */
+
 /*-----------------------------------------------------------*/
 
 /*
@@ -161,7 +205,11 @@ static void prvTaskExitError( void )
      *
      * Artificially force an assert() to be triggered if configASSERT() is
      * defined, then stop here so application writers can catch the error. */
-    configASSERT( uxCriticalNesting == ~0UL );
+    #if ( configNUMBER_OF_CORES == 1 )
+        configASSERT( uxCriticalNesting == ~0UL );
+    #else
+        configASSERT( portGET_CRITICAL_NESTING_COUNT() == ~0UL );
+    #endif
     portDISABLE_INTERRUPTS();
 
     while( ulDummy == 0 )
@@ -192,6 +240,12 @@ void vPortStartFirstTask( void )
     __asm volatile (
         "	.syntax unified				\n"
         "	ldr  r2, pxCurrentTCBConst2	\n"/* Obtain location of pxCurrentTCB. */
+        #if ( configNUMBER_OF_CORES > 1 )
+            "	ldr  r1, SIOBASE2			\n"/* SMP: pxCurrentTCBs[ SIO:CPUID ]. */
+            "	ldr  r1, [r1, #0]			\n"
+            "	lsls r1, r1, #2				\n"
+            "	adds r2, r2, r1				\n"
+        #endif
         "	ldr  r3, [r2]				\n"
         "	ldr  r0, [r3]				\n"/* The first item in pxCurrentTCB is the task top of stack. */
         "	adds r0, #(32 + 24)				\n"/* Discard everything up to r0. */
@@ -207,7 +261,12 @@ void vPortStartFirstTask( void )
         "	bx   r3						\n"/* Finally, jump to the user defined task code. */
         "								\n"
         "	.align 4					\n"
-        "pxCurrentTCBConst2: .word pxCurrentTCB	  "
+        #if ( configNUMBER_OF_CORES == 1 )
+            "pxCurrentTCBConst2: .word pxCurrentTCB	  "
+        #else
+            "pxCurrentTCBConst2: .word pxCurrentTCBs	\n"
+            "SIOBASE2:			.word 0xd0000000	  "
+        #endif
         );
 }
 /*-----------------------------------------------------------*/
@@ -217,19 +276,27 @@ void vPortStartFirstTask( void )
  */
 BaseType_t xPortStartScheduler( void )
 {
-    /* Make PendSV, CallSV and SysTick the same priority as the kernel. */
-    portNVIC_SHPR3_REG |= portNVIC_PENDSV_PRI;
-    portNVIC_SHPR3_REG |= portNVIC_SYSTICK_PRI;
-
-    /* Start the timer that generates the tick ISR.  Interrupts are disabled
-     * here already. */
-    vPortSetupTimerInterrupt();
-
-    /* Initialise the critical nesting count ready for the first task. */
-    uxCriticalNesting = 0;
-
-    /* Start the first task. */
-    vPortStartFirstTask();
+    #if ( configNUMBER_OF_CORES == 1 )
+        /* Make PendSV, CallSV and SysTick the same priority as the kernel. */
+        portNVIC_SHPR3_REG |= portNVIC_PENDSV_PRI;
+        portNVIC_SHPR3_REG |= portNVIC_SYSTICK_PRI;
+
+        /* Start the timer that generates the tick ISR.  Interrupts are disabled
+         * here already. */
+        vPortSetupTimerInterrupt();
+
+        /* Initialise the critical nesting count ready for the first task. */
+        uxCriticalNesting = 0;
+
+        /* Start the first task. */
+        vPortStartFirstTask();
+    #else
+        /* The kernel has already chosen the first task of each core.  Core 1
+         * must still be held in reset by the boot ROM; it starts the task
+         * chosen for it while core 0 carries on with its own. */
+        multicore_launch_core1( prvCore1Start );
+        prvStartSchedulerOnThisCore();
+    #endif
 
     /* Should never get here as the tasks will now be executing!  Call the task
      * exit error function to prevent compiler warnings about a static function
@@ -237,7 +304,11 @@ BaseType_t xPortStartScheduler( void )
      * functionality by defining configTASK_RETURN_ADDRESS.  Call
      * vTaskSwitchContext() so link time optimisation does not remove the
      * symbol. */
-    vTaskSwitchContext();
+    #if ( configNUMBER_OF_CORES == 1 )
+        vTaskSwitchContext();
+    #else
+        vTaskSwitchContext( 0 );
+    #endif
     prvTaskExitError();
 
     /* Should not get here! */
@@ -249,10 +320,125 @@ void vPortEndScheduler( void )
 {
     /* Not implemented in ports where there is nothing to return to.
      * Artificially force an assert. */
-    configASSERT( uxCriticalNesting == 1000UL );
+    #if ( configNUMBER_OF_CORES == 1 )
+        configASSERT( uxCriticalNesting == 1000UL );
+    #else
+        configASSERT( portGET_CRITICAL_NESTING_COUNT() == 1000UL );
+    #endif
 }
 /*-----------------------------------------------------------*/
 
+#if ( configNUMBER_OF_CORES > 1 )
+
+    static void prvStartSchedulerOnThisCore( void )
+    {
+        const uint32_t ulIRQNum = SIO_IRQ_PROC0 + get_core_num();
+
+        /* The system handler priorities, the NVIC and the SysTick are per
+         * core, so each core sets up its own. */
+        portNVIC_SHPR3_REG |= portNVIC_PENDSV_PRI;
+        portNVIC_SHPR3_REG |= portNVIC_SYSTICK_PRI;
+
+        /* Yield requests from the other core arrive through the FIFO. */
+        multicore_fifo_drain();
+        multicore_fifo_clear_irq();
+        irq_set_exclusive_handler( ulIRQNum, prvFIFOInterruptHandler );
+        irq_set_priority( ulIRQNum, PICO_LOWEST_IRQ_PRIORITY );
+        irq_set_enabled( ulIRQNum, true );
+
+        vPortSetupTimerInterrupt();
+
+        /* Initialise the critical nesting count ready for the first task. */
+        portSET_CRITICAL_NESTING_COUNT( 0 );
+
+        vPortStartFirstTask();
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvCore1Start( void )
+    {
+        /* Interrupts stay disabled until the first task restores its
+         * context, as on core 0. */
+        portDISABLE_INTERRUPTS();
+        prvStartSchedulerOnThisCore();
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvFIFOInterruptHandler( void )
+    {
+        /* The values carry no information, any word in the FIFO is a yield
+         * request.  Draining it also drops requests that piled up. */
+        multicore_fifo_drain();
+        multicore_fifo_clear_irq();
+        portYIELD_FROM_ISR( pdTRUE );
+    }
+/*-----------------------------------------------------------*/
+
+    void vPortYieldCore( BaseType_t xCoreID )
+    {
+        /* With two cores the FIFO of the calling core always leads to the
+         * one to yield.  If it is full that core has requests pending already
+         * and will switch anyway, so never wait for it: the caller may hold
+         * the ISR lock. */
+        configASSERT( xCoreID != portGET_CORE_ID() );
+        ( void ) xCoreID;
+
+        if( multicore_fifo_wready() )
+        {
+            multicore_fifo_push_blocking( 0 );
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    void vPortRecursiveLock( uint32_t ulLockNum,
+                             BaseType_t xAcquire )
+    {
+        spin_lock_t * const pxSpinLock = spin_lock_instance( PICO_SPINLOCK_ID_OS1 + ulLockNum );
+        const uint32_t ulCoreNum = get_core_num();
+
+        /* Called with interrupts masked on the calling core, so the owner and
+         * recursion counts cannot change under it from this core. */
+        configASSERT( ulLockNum < portRTOS_SPINLOCK_COUNT );
+
+        if( xAcquire != pdFALSE )
+        {
+            /* Reading the spinlock register claims it, a zero read means it
+             * is held (possibly by this core). */
+            if( __builtin_expect( !*pxSpinLock, 0 ) )
+            {
+                if( ucOwnedByCore[ ulCoreNum ][ ulLockNum ] != 0U )
+                {
+                    ucRecursionCountByLock[ ulLockNum ]++;
+                    return;
+                }
+
+                while( __builtin_expect( !*pxSpinLock, 0 ) )
+                {
+                }
+            }
+
+            __mem_fence_acquire();
+            configASSERT( ucRecursionCountByLock[ ulLockNum ] == 0U );
+            ucRecursionCountByLock[ ulLockNum ] = 1;
+            ucOwnedByCore[ ulCoreNum ][ ulLockNum ] = 1;
+        }
+        else
+        {
+            configASSERT( ucOwnedByCore[ ulCoreNum ][ ulLockNum ] != 0U );
+            configASSERT( ucRecursionCountByLock[ ulLockNum ] != 0U );
+
+            if( --ucRecursionCountByLock[ ulLockNum ] == 0U )
+            {
+                ucOwnedByCore[ ulCoreNum ][ ulLockNum ] = 0;
+                __mem_fence_release();
+                *pxSpinLock = 1;
+            }
+        }
+    }
+
+#endif /* configNUMBER_OF_CORES */
+/*-----------------------------------------------------------*/
+
 void vPortYield( void )
 {
     /* Set a PendSV to request a context switch. */
@@ -265,25 +451,29 @@ void vPortYield( void )
 }
 /*-----------------------------------------------------------*/
 
-void vPortEnterCritical( void )
-{
-    portDISABLE_INTERRUPTS();
-    uxCriticalNesting++;
-    __asm volatile ( "dsb" ::: "memory" );
-    __asm volatile ( "isb" );
-}
-/*-----------------------------------------------------------*/
+#if ( configNUMBER_OF_CORES == 1 )
 
-void vPortExitCritical( void )
-{
-    configASSERT( uxCriticalNesting );
-    uxCriticalNesting--;
+    void vPortEnterCritical( void )
+    {
+        portDISABLE_INTERRUPTS();
+        uxCriticalNesting++;
+        __asm volatile ( "dsb" ::: "memory" );
+        __asm volatile ( "isb" );
+    }
+/*-----------------------------------------------------------*/
 
-    if( uxCriticalNesting == 0 )
+    void vPortExitCritical( void )
     {
-        portENABLE_INTERRUPTS();
+        configASSERT( uxCriticalNesting );
+        uxCriticalNesting--;
+
+        if( uxCriticalNesting == 0 )
+        {
+            portENABLE_INTERRUPTS();
+        }
     }
-}
+
+#endif /* configNUMBER_OF_CORES */
 /*-----------------------------------------------------------*/
 
 uint32_t ulSetInterruptMaskFromISR( void )
@@ -316,9 +506,18 @@ void xPortPendSVHandler( void )
         "	.syntax unified						\n"
         "	mrs r0, psp							\n"
         "										\n"
-        "	ldr	r3, pxCurrentTCBConst			\n"/* Get the location of the current TCB. */
-        "	ldr	r2, [r3]						\n"
-        "	ldr	r1, SIOBASE						\n"/* RP2040 SIO base address */
+        #if ( configNUMBER_OF_CORES == 1 )
+            "	ldr	r3, pxCurrentTCBConst			\n"/* Get the location of the current TCB. */
+            "	ldr	r2, [r3]						\n"
+            "	ldr	r1, SIOBASE						\n"/* RP2040 SIO base address */
+        #else
+            "	ldr	r1, SIOBASE						\n"/* RP2040 SIO base address */
+            "	ldr	r3, [r1, #0]					\n"/* SIO:CPUID */
+            "	lsls r3, r3, #2						\n"
+            "	ldr	r2, pxCurrentTCBConst			\n"/* Get the location of pxCurrentTCBs[ CPUID ]. */
+            "	adds r3, r3, r2						\n"
+            "	ldr	r2, [r3]						\n"
+        #endif
         "										\n"
         "	subs r0, r0, #(32 + 24)				\n"/* Make space for the remaining low registers. */
         "	str r0, [r2]						\n"/* Save the new top of stack. */
@@ -346,6 +545,9 @@ void xPortPendSVHandler( void )
         "										\n"
         "	push {r3, r14}						\n"
         "	cpsid i								\n"
+        #if ( configNUMBER_OF_CORES > 1 )
+            "	ldr r0, [r1, #0]					\n"/* vTaskSwitchContext( SIO:CPUID ) */
+        #endif
         "	bl vTaskSwitchContext				\n"
         "	cpsie i								\n"
         "	pop {r2, r3}						\n"/* lr goes in r3. r2 now holds tcb pointer. */
@@ -382,7 +584,11 @@ void xPortPendSVHandler( void )
         "	bx r3								\n"
         "										\n"
         "	.align 4							\n"
-        "pxCurrentTCBConst: .word pxCurrentTCB	\n"
+        #if ( configNUMBER_OF_CORES == 1 )
+            "pxCurrentTCBConst: .word pxCurrentTCB	\n"
+        #else
+            "pxCurrentTCBConst: .word pxCurrentTCBs	\n"
+        #endif
         "SIOBASE:			.word 0xd0000000	  "
     );
 }
@@ -394,12 +600,33 @@ void xPortSysTickHandler( void )
 
     ulPreviousMask = portSET_INTERRUPT_MASK_FROM_ISR();
     {
-        /* Increment the RTOS tick. */
-        if( xTaskIncrementTick() != pdFALSE )
-        {
-            /* Pend a context switch. */
-            portNVIC_INT_CTRL_REG = portNVIC_PENDSVSET_BIT;
-        }
+        #if ( configNUMBER_OF_CORES == 1 )
+            /* Increment the RTOS tick. */
+            if( xTaskIncrementTick() != pdFALSE )
+            {
+                /* Pend a context switch. */
+                portNVIC_INT_CTRL_REG = portNVIC_PENDSVSET_BIT;
+            }
+        #else
+            /* Every core has its own SysTick.  Only core 0 increments the
+             * tick, the others just time slice. */
+            BaseType_t xSwitchRequired;
+
+            if( portGET_CORE_ID() == 0 )
+            {
+                xSwitchRequired = xTaskIncrementTick();
+            }
+            else
+            {
+                xSwitchRequired = xTaskCheckForTimeSlice();
+            }
+
+            if( xSwitchRequired != pdFALSE )
+            {
+                /* Pend a context switch. */
+                portNVIC_INT_CTRL_REG = portNVIC_PENDSVSET_BIT;
+            }
+        #endif
     }
     portCLEAR_INTERRUPT_MASK_FROM_ISR( ulPreviousMask );
 }
@@ -420,6 +647,14 @@ __attribute__( ( weak ) ) void vPortSetupTimerInterrupt( void )
         }
     #endif /* configUSE_TICKLESS_IDLE */
 
+    #if ( configUSE_TICKLESS_IDLE == 2 )
+        {
+            lTicklessAlarm = hardware_alarm_claim_unused( true );
+            hardware_alarm_set_callback( ( uint ) lTicklessAlarm, prvTicklessAlarmCallback );
+            ullSchedulerStartUs = time_us_64();
+        }
+    #endif /* configUSE_TICKLESS_IDLE */
+
     /* Stop and reset the SysTick. */
     portNVIC_SYSTICK_CTRL_REG = 0UL;
     portNVIC_SYSTICK_CURRENT_VALUE_REG = 0UL;
@@ -598,3 +833,153 @@ __attribute__( ( weak ) ) void vPortSetupTimerInterrupt( void )
     }
 
 #endif /* configUSE_TICKLESS_IDLE */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TICKLESS_IDLE == 2 )
+
+    static void prvTicklessAlarmCallback( uint alarm_num )
+    {
+        /* Nothing to do: taking the interrupt is what ends the wfi. */
+        ( void ) alarm_num;
+    }
+/*-----------------------------------------------------------*/
+
+    /* Restart SysTick so that the next tick interrupt happens ulNextTickUs from
+     * now, then go back to full tick periods. */
+    static void prvRestartSysTick( uint32_t ulNextTickUs )
+    {
+        uint32_t ulReload = ulNextTickUs * portSYSTICK_COUNTS_PER_US;
+
+        if( ( ulReload == 0UL ) || ( ulReload > ( configCPU_CLOCK_HZ / configTICK_RATE_HZ ) ) )
+        {
+            ulReload = configCPU_CLOCK_HZ / configTICK_RATE_HZ;
+        }
+
+        portNVIC_SYSTICK_LOAD_REG = ulReload - 1UL;
+        portNVIC_SYSTICK_CURRENT_VALUE_REG = 0UL;
+        portNVIC_SYSTICK_CTRL_REG |= portNVIC_SYSTICK_ENABLE_BIT;
+        portNVIC_SYSTICK_LOAD_REG = ( configCPU_CLOCK_HZ / configTICK_RATE_HZ ) - 1UL;
+    }
+/*-----------------------------------------------------------*/
+
+    /* The SysTick keeps generating the ticks while tasks run; only the idle
+     * sleep is timed by a hardware alarm of the 64-bit timer, which has no
+     * practical limit on the number of suppressed ticks (SysTick alone stops at
+     * about 126 ms at 133 MHz).  The timer is also the reference used to work out
+     * how many ticks passed, so the time SysTick spends stopped does not
+     * accumulate as drift. */
+    void vPortSuppressTicksAndSleep( TickType_t xExpectedIdleTime )
+    {
+        uint64_t ullStartUs, ullBoundaryUs, ullTargetUs, ullNowUs;
+        uint32_t ulCompleteTickPeriods, ulNextTickUs, ulLateUs;
+
+        __asm volatile ( "cpsid i" ::: "memory" );
+        __asm volatile ( "dsb" );
+        __asm volatile ( "isb" );
+
+        portNVIC_SYSTICK_CTRL_REG &= ~portNVIC_SYSTICK_ENABLE_BIT;
+
+        /* A task became ready, or the tick that just ended is still pending:
+         * let it run normally. */
+        if( ( eTaskConfirmSleepModeStatus() == eAbortSleep ) ||
+            ( ( portNVIC_INT_CTRL_REG & portNVIC_PENDSTSET_BIT ) != 0UL ) )
+        {
+            portNVIC_SYSTICK_CTRL_REG |= portNVIC_SYSTICK_ENABLE_BIT;
+            xTicklessStats.ulAborted++;
+            __asm volatile ( "cpsie i" ::: "memory" );
+            return;
+        }
+
+        /* SysTick counts down to the next tick boundary.  The task that
+         * unblocks is due xExpectedIdleTime - 1 boundaries after that one. */
+        ullStartUs = time_us_64();
+        ullBoundaryUs = ullStartUs + ( portNVIC_SYSTICK_CURRENT_VALUE_REG / portSYSTICK_COUNTS_PER_US );
+        ullTargetUs = ullBoundaryUs + ( uint64_t ) ( xExpectedIdleTime - 1UL ) * portTICK_PERIOD_US;
+
+        if( hardware_alarm_set_target( ( uint ) lTicklessAlarm, from_us_since_boot( ullTargetUs ) ) )
+        {
+            /* Already in the past. */
+            portNVIC_SYSTICK_CTRL_REG |= portNVIC_SYSTICK_ENABLE_BIT;
+            xTicklessStats.ulAborted++;
+            __asm volatile ( "cpsie i" ::: "memory" );
+            return;
+        }
+
+        configPRE_SLEEP_PROCESSING( xExpectedIdleTime );
+
+        if( xExpectedIdleTime > 0 )
+        {
+            __asm volatile ( "dsb" ::: "memory" );
+            __asm volatile ( "wfi" );
+            __asm volatile ( "isb" );
+        }
+
+        configPOST_SLEEP_PROCESSING( xExpectedIdleTime );
+
+        ullNowUs = time_us_64();
+        hardware_alarm_cancel( ( uint ) lTicklessAlarm );
+
+        if( ullNowUs >= ullTargetUs )
+        {
+            /* Woken by the alarm.  The last tick is pended so the tick
+             * interrupt unblocks the task as soon as interrupts are enabled;
+             * whole ticks beyond that cannot be stepped past the unblock time
+             * and are counted as lost. */
+            ulLateUs = ( uint32_t ) ( ullNowUs - ullTargetUs );
+            ulCompleteTickPeriods = xExpectedIdleTime - 1UL;
+            ulNextTickUs = portTICK_PERIOD_US - ( ulLateUs % portTICK_PERIOD_US );
+            portNVIC_INT_CTRL_REG = portNVIC_PENDSTSET_BIT;
+
+            xTicklessStats.ulAlarmWakeups++;
+            xTicklessStats.ullWakeLatencyTotalUs += ulLateUs;
+
+            if( ulLateUs > xTicklessStats.ulWakeLatencyMaxUs )
+            {
+                xTicklessStats.ulWakeLatencyMaxUs = ulLateUs;
+            }
+
+            xTicklessStats.ulLostTicks += ulLateUs / portTICK_PERIOD_US;
+        }
+        else if( ullNowUs < ullBoundaryUs )
+        {
+            /* Some other interrupt, still inside the tick we started in. */
+            ulCompleteTickPeriods = 0UL;
+            ulNextTickUs = ( uint32_t ) ( ullBoundaryUs - ullNowUs );
+        }
+        else
+        {
+            /* Some other interrupt, some boundaries later. */
+            ulCompleteTickPeriods = 1UL + ( uint32_t ) ( ( ullNowUs - ullBoundaryUs ) / portTICK_PERIOD_US );
+            ulNextTickUs = portTICK_PERIOD_US - ( uint32_t ) ( ( ullNowUs - ullBoundaryUs ) % portTICK_PERIOD_US );
+        }
+
+        prvRestartSysTick( ulNextTickUs );
+        vTaskStepTick( ulCompleteTickPeriods );
+
+        xTicklessStats.ulSleeps++;
+        xTicklessStats.ullSleptUs += ullNowUs - ullStartUs;
+
+        __asm volatile ( "cpsie i" ::: "memory" );
+    }
+/*-----------------------------------------------------------*/
+
+    void vPortGetTicklessStats( TicklessStats_t * pxStats )
+    {
+        uint64_t ullKernelUs, ullTimerUs;
+
+        portENTER_CRITICAL();
+        {
+            *pxStats = xTicklessStats;
+
+            /* Kernel time: whole ticks plus the part of the current tick that
+             * SysTick has already counted. */
+            ullKernelUs = ( uint64_t ) xTaskGetTickCount() * portTICK_PERIOD_US +
+                          ( ( configCPU_CLOCK_HZ / configTICK_RATE_HZ ) - portNVIC_SYSTICK_CURRENT_VALUE_REG ) / portSYSTICK_COUNTS_PER_US;
+            ullTimerUs = time_us_64() - ullSchedulerStartUs;
+        }
+        portEXIT_CRITICAL();
+
+        pxStats->lDriftUs = ( int32_t ) ( ( int64_t ) ullKernelUs - ( int64_t ) ullTimerUs );
+    }
+
+#endif /* configUSE_TICKLESS_IDLE */
@@ -0,0 +1,43 @@
+#ifndef PORT_SELECT_H
+#define PORT_SELECT_H
+
+#include <stdint.h>
+
+/* Seleção da tarefa pronta de maior prioridade em O(1) para o M0+
+ * (configUSE_PORT_OPTIMISED_TASK_SELECTION 1).
+ *
+ * O tasks.c guarda em uxTopReadyPriority um bit por prioridade com tarefas
+ * prontas. Sem CLZ no M0+, o bit mais alto sai por de Bruijn: os bits abaixo
+ * do mais alto são preenchidos com shifts, e a multiplicação por uma
+ * sequência de de Bruijn deixa nos 5 bits de cima um índice único para uma
+ * tabela de 32 posições. São ~12 instruções sem desvio, qualquer que seja o
+ * número de prioridades; a busca genérica percorre as listas vazias uma a
+ * uma a cada troca de contexto. */
+
+#if ( configMAX_PRIORITIES > 32 )
+    #error configUSE_PORT_OPTIMISED_TASK_SELECTION 1 aceita no máximo 32 prioridades
+#endif
+
+/* Índice do bit mais alto de ulBitmap (diferente de 0) */
+static inline uint32_t ulPortHighestBit( uint32_t ulBitmap )
+{
+    static const uint8_t ucDeBruijnPosition[ 32 ] =
+    {
+        0, 9,  1,  10, 13, 21, 2,  29, 11, 14, 16, 18, 22, 25, 3, 30,
+        8, 12, 20, 28, 15, 17, 24, 7,  19, 27, 23, 6,  26, 5,  4, 31
+    };
+
+    ulBitmap |= ulBitmap >> 1;
+    ulBitmap |= ulBitmap >> 2;
+    ulBitmap |= ulBitmap >> 4;
+    ulBitmap |= ulBitmap >> 8;
+    ulBitmap |= ulBitmap >> 16;
+
+    return ucDeBruijnPosition[ ( uint32_t ) ( ulBitmap * 0x07C4ACDDUL ) >> 27 ];
+}
+
+#define portRECORD_READY_PRIORITY( uxPriority, uxReadyPriorities )    ( uxReadyPriorities ) |= ( 1UL << ( uxPriority ) )
+#define portRESET_READY_PRIORITY( uxPriority, uxReadyPriorities )     ( uxReadyPriorities ) &= ~( 1UL << ( uxPriority ) )
+#define portGET_HIGHEST_PRIORITY( uxTopPriority, uxReadyPriorities )  uxTopPriority = ulPortHighestBit( ( uxReadyPriorities ) )
+
+#endif
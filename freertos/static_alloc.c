@@ -0,0 +1,45 @@
+#include "FreeRTOS.h"
+#include "task.h"
+
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+// Sem heap, o kernel pede à aplicação a memória das tarefas que ele mesmo
+// cria em vTaskStartScheduler(): a idle e, com configUSE_TIMERS, a do timer
+
+void vApplicationGetIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer, StackType_t **ppxIdleTaskStackBuffer,
+                                   uint32_t *pulIdleTaskStackSize) {
+    static StaticTask_t xIdleTaskTCB;
+    static StackType_t uxIdleTaskStack[configMINIMAL_STACK_SIZE];
+
+    *ppxIdleTaskTCBBuffer = &xIdleTaskTCB;
+    *ppxIdleTaskStackBuffer = uxIdleTaskStack;
+    *pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+
+#if ( configNUMBER_OF_CORES > 1 )
+// FREERTOS_SMP: uma idle por núcleo; a do núcleo 0 vem da função acima e as
+// dos outros (as idle "passivas") daqui, indexadas a partir do núcleo 1
+void vApplicationGetPassiveIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer, StackType_t **ppxIdleTaskStackBuffer,
+                                          uint32_t *pulIdleTaskStackSize, BaseType_t xPassiveIdleTaskIndex) {
+    static StaticTask_t xIdleTaskTCBs[configNUMBER_OF_CORES - 1];
+    static StackType_t uxIdleTaskStacks[configNUMBER_OF_CORES - 1][configMINIMAL_STACK_SIZE];
+
+    *ppxIdleTaskTCBBuffer = &xIdleTaskTCBs[xPassiveIdleTaskIndex];
+    *ppxIdleTaskStackBuffer = uxIdleTaskStacks[xPassiveIdleTaskIndex];
+    *pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+#endif
+
+#if ( configUSE_TIMERS == 1 )
+void vApplicationGetTimerTaskMemory(StaticTask_t **ppxTimerTaskTCBBuffer, StackType_t **ppxTimerTaskStackBuffer,
+                                    uint32_t *pulTimerTaskStackSize) {
+    static StaticTask_t xTimerTaskTCB;
+    static StackType_t uxTimerTaskStack[configTIMER_TASK_STACK_DEPTH];
+
+    *ppxTimerTaskTCBBuffer = &xTimerTaskTCB;
+    *ppxTimerTaskStackBuffer = uxTimerTaskStack;
+    *pulTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+}
+#endif
+
+#endif
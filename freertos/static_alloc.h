@@ -0,0 +1,33 @@
+#ifndef STATIC_ALLOC_H
+#define STATIC_ALLOC_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Criação de tarefas que serve aos dois modos de alocação (FREERTOS_STATIC
+ * no freertos/CMakeLists.txt).
+ *
+ * Com configSUPPORT_STATIC_ALLOCATION 1, a pilha e o TCB viram variáveis
+ * estáticas no ponto da chamada: entram no .bss com tamanho conhecido no
+ * link (--print-memory-usage e o .map) e a criação não falha em tempo de
+ * execução. Sem ele, vêm do heap com xTaskCreate(). Cada chamada reserva
+ * memória para uma tarefa só, então não deve ficar dentro de um laço.
+ * pxHandle pode ser NULL. */
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+#define TASK_CREATE( pxTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pxHandle )             \
+    do {                                                                                                 \
+        static StackType_t xStack[ usStackDepth ];                                                       \
+        static StaticTask_t xTaskBuffer;                                                                 \
+        TaskHandle_t xCreated = xTaskCreateStatic( ( pxTaskCode ), ( pcName ), ( usStackDepth ),         \
+                                                   ( pvParameters ), ( uxPriority ), xStack, &xTaskBuffer ); \
+        TaskHandle_t *pxCreated = ( pxHandle );                                                          \
+        if( pxCreated != NULL ) {                                                                        \
+            *pxCreated = xCreated;                                                                       \
+        }                                                                                                \
+    } while( 0 )
+#else
+#define TASK_CREATE( pxTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pxHandle ) \
+    ( void ) xTaskCreate( ( pxTaskCode ), ( pcName ), ( usStackDepth ), ( pvParameters ), ( uxPriority ), ( pxHandle ) )
+#endif
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef TICKLESS_H
+#define TICKLESS_H
+
+#include <stdint.h>
+
+/* Estatísticas do tickless idle com o timer de 64 bits do RP2040
+ * (configUSE_TICKLESS_IDLE 2, port.c). Os tempos são em microssegundos. */
+typedef struct {
+    uint32_t ulSleeps;              /* vezes que a tarefa idle dormiu */
+    uint32_t ulAborted;             /* desistiu de dormir (tarefa pronta, tick pendente) */
+    uint32_t ulAlarmWakeups;        /* acordou pelo alarme; as outras, por outra interrupção */
+    uint64_t ullSleptUs;            /* tempo total dormindo */
+    uint64_t ullWakeLatencyTotalUs; /* soma de alarme -> CPU de volta, nos ulAlarmWakeups */
+    uint32_t ulWakeLatencyMaxUs;
+    uint32_t ulLostTicks;           /* ticks inteiros perdidos por acordar atrasado */
+    int32_t lDriftUs;               /* tempo do kernel - tempo do timer, desde o scheduler */
+} TicklessStats_t;
+
+void vPortGetTicklessStats(TicklessStats_t *pxStats);
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef LWIP_HDR_PBUF_H
+#define LWIP_HDR_PBUF_H
+
+// struct pbuf mínima para compilar o http_parser.c no computador
+// (bench/http_parser_bench.c): só os campos que o parser percorre.
+
+#include <stdint.h>
+
+struct pbuf {
+    struct pbuf *next;
+    void *payload;
+    uint16_t tot_len;
+    uint16_t len;
+};
+
+#endif
@@ -0,0 +1,225 @@
+// Mede o http_parser no computador (não roda na Pico), em bytes por ciclo,
+// com as respostas que o http_client recebe:
+//
+//   cc -O2 -Ibench/host -I. http_parser.c bench/http_parser_bench.c -o http_parser_bench
+//   ./http_parser_bench [GHz]
+//
+// Cenários:
+//   content-length: a resposta inteira em um pbuf só
+//   segmentos:      a mesma resposta numa cadeia de pbufs, via
+//                   http_parser_execute_pbuf(): o primeiro corta o cabeçalho
+//                   no meio de uma linha, os outros têm 536 bytes (MSS
+//                   padrão do lwIP)
+//   pedaços:        a mesma resposta entregue em chamadas de 7 bytes, para
+//                   ver o custo de retomar o estado a cada chamada
+//   chunked:        corpo em chunks de 256 bytes com extensões e trailer
+//
+// Antes de medir, cada cenário confere o status e o corpo (tamanho e soma).
+// Em x86 os ciclos vêm do TSC (frequência nominal); nas outras arquiteturas,
+// do tempo vezes a frequência passada em GHz. O M0+ não executa como o
+// computador: o número serve para comparar cenários e versões do parser.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "http_parser.h"
+
+#define BODY_SIZE 2048
+#define MSS 536
+#define FIRST_SEGMENT 100
+#define SMALL_PIECE 7
+#define CHUNK_SIZE 256
+#define TARGET_BYTES (16u * 1024 * 1024)
+// Cada cenário roda REPEATS vezes e fica o melhor: no computador as outras
+// medidas pegam preempção e troca de frequência
+#define REPEATS 7
+
+#define HEADERS                                                                                     \
+    "Server: nginx/1.24.0\r\n"                                                                      \
+    "Date: Sat, 17 Oct 2026 18:00:00 GMT\r\n"                                                       \
+    "Content-Type: application/json; charset=utf-8\r\n"                                             \
+    "Connection: keep-alive\r\n"                                                                    \
+    "X-Cache-Key: /data/2.5/weather?q=Sao+Paulo\r\n"                                                \
+    "Access-Control-Allow-Origin: *\r\n"
+
+static char content_length_response[1024 + BODY_SIZE];
+static size_t content_length_len;
+static char chunked_response[1024 + BODY_SIZE * 2];
+static size_t chunked_len;
+static uint8_t body[BODY_SIZE];
+static uint32_t body_sum;
+
+static double ghz = 1.0;
+
+typedef struct {
+    int status;
+    size_t body_len;
+    uint32_t body_sum;
+    int complete;
+} result_t;
+
+static void on_status(http_parser_t *parser, int status) {
+    ((result_t *)parser->arg)->status = status;
+}
+
+static void on_body(http_parser_t *parser, const uint8_t *data, size_t len) {
+    result_t *r = parser->arg;
+    r->body_len += len;
+    for (size_t i = 0; i < len; i++) {
+        r->body_sum += data[i];
+    }
+}
+
+static void on_complete(http_parser_t *parser) {
+    ((result_t *)parser->arg)->complete++;
+}
+
+static const http_parser_settings_t settings = {on_status, on_body, on_complete};
+
+static void build_responses(void) {
+    uint32_t state = 12345;
+    for (size_t i = 0; i < BODY_SIZE; i++) {
+        state = state * 1664525u + 1013904223u;
+        body[i] = (uint8_t)(' ' + (state >> 24) % 95);
+        body_sum += body[i];
+    }
+
+    content_length_len = (size_t)sprintf(content_length_response, "HTTP/1.1 200 OK\r\n" HEADERS "Content-Length: %d\r\n\r\n",
+                                         BODY_SIZE);
+    memcpy(content_length_response + content_length_len, body, BODY_SIZE);
+    content_length_len += BODY_SIZE;
+
+    chunked_len = (size_t)sprintf(chunked_response, "HTTP/1.1 200 OK\r\n" HEADERS "Transfer-Encoding: chunked\r\n\r\n");
+    for (size_t off = 0; off < BODY_SIZE; off += CHUNK_SIZE) {
+        chunked_len += (size_t)sprintf(chunked_response + chunked_len, "%x;ext=1\r\n", CHUNK_SIZE);
+        memcpy(chunked_response + chunked_len, body + off, CHUNK_SIZE);
+        chunked_len += CHUNK_SIZE;
+        chunked_len += (size_t)sprintf(chunked_response + chunked_len, "\r\n");
+    }
+    chunked_len += (size_t)sprintf(chunked_response + chunked_len, "0\r\nX-Trailer: 1\r\n\r\n");
+}
+
+// Cadeia de pbufs sobre a resposta, sem copiar: FIRST_SEGMENT bytes e
+// depois até MSS bytes por pbuf
+static struct pbuf segments[sizeof(content_length_response) / MSS + 2];
+
+static struct pbuf *build_chain(const char *data, size_t len) {
+    size_t count = 0;
+    for (size_t off = 0; off < len; count++) {
+        size_t max = count == 0 ? FIRST_SEGMENT : MSS;
+        segments[count].payload = (void *)(data + off);
+        segments[count].len = (uint16_t)(len - off < max ? len - off : max);
+        segments[count].tot_len = (uint16_t)(len - off);
+        segments[count].next = NULL;
+        if (count > 0) {
+            segments[count - 1].next = &segments[count];
+        }
+        off += segments[count].len;
+    }
+    return &segments[0];
+}
+
+typedef void (*feed_t)(http_parser_t *parser);
+
+static void feed_whole(http_parser_t *parser) {
+    http_parser_execute(parser, (const uint8_t *)content_length_response, content_length_len);
+}
+
+static struct pbuf *chain;
+
+static void feed_segments(http_parser_t *parser) {
+    http_parser_execute_pbuf(parser, chain, 0);
+}
+
+static void feed_pieces(http_parser_t *parser) {
+    for (size_t off = 0; off < content_length_len; off += SMALL_PIECE) {
+        size_t n = content_length_len - off < SMALL_PIECE ? content_length_len - off : SMALL_PIECE;
+        http_parser_execute(parser, (const uint8_t *)content_length_response + off, n);
+    }
+}
+
+static void feed_chunked(http_parser_t *parser) {
+    http_parser_execute(parser, (const uint8_t *)chunked_response, chunked_len);
+}
+
+static uint64_t cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)((ts.tv_sec * 1e9 + ts.tv_nsec) * ghz);
+#endif
+}
+
+static int check(const char *name, feed_t feed) {
+    http_parser_t parser;
+    result_t r = {0};
+    http_parser_init(&parser, &settings, &r);
+    feed(&parser);
+    if (!http_parser_done(&parser) || r.status != 200 || r.complete != 1 || r.body_len != BODY_SIZE ||
+        r.body_sum != body_sum) {
+        printf("ERRO em %s: status %d, %zu bytes de corpo, completa %d\n", name, r.status, r.body_len, r.complete);
+        return 0;
+    }
+    return 1;
+}
+
+// No on_body só soma o tamanho: a medida é do parser, não do consumidor
+static void on_body_len(http_parser_t *parser, const uint8_t *data, size_t len) {
+    (void)data;
+    ((result_t *)parser->arg)->body_len += len;
+}
+
+static const http_parser_settings_t bench_settings = {on_status, on_body_len, on_complete};
+
+static void run(const char *name, feed_t feed, size_t response_len) {
+    http_parser_t parser;
+    result_t r = {0};
+    uint32_t rounds = TARGET_BYTES / response_len;
+
+    http_parser_init(&parser, &bench_settings, &r);
+    uint64_t elapsed = UINT64_MAX;
+    for (int repeat = 0; repeat < REPEATS; repeat++) {
+        uint64_t start = cycles();
+        for (uint32_t i = 0; i < rounds; i++) {
+            http_parser_reset(&parser);
+            feed(&parser);
+        }
+        uint64_t spent = cycles() - start;
+        elapsed = spent < elapsed ? spent : elapsed;
+    }
+
+    double bytes = (double)rounds * response_len;
+    printf("  %-15s %5zu bytes  %6.3f bytes/ciclo  %7.1f ciclos/resposta\n", name, response_len, bytes / elapsed,
+           (double)elapsed / rounds);
+    if (r.complete != (int)(rounds * REPEATS)) {
+        printf("  ERRO: %d de %lu respostas completas\n", r.complete, (unsigned long)(rounds * REPEATS));
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1) {
+        ghz = atof(argv[1]);
+    }
+    build_responses();
+    chain = build_chain(content_length_response, content_length_len);
+
+    if (!check("content-length", feed_whole) || !check("segmentos", feed_segments) ||
+        !check("pedacos", feed_pieces) || !check("chunked", feed_chunked)) {
+        return 1;
+    }
+
+    printf("corpo de %d bytes:\n", BODY_SIZE);
+    run("content-length", feed_whole, content_length_len);
+    run("segmentos", feed_segments, content_length_len);
+    run("pedacos", feed_pieces, content_length_len);
+    run("chunked", feed_chunked, chunked_len);
+    return 0;
+}
@@ -0,0 +1,498 @@
+#include <string.h>
+
+#include "lwip/pbuf.h"
+#include "lwip/udp.h"
+#include "lwip/sys.h"
+#include "lwip/timeouts.h"
+
+#include "dns_cache.h"
+
+#define DEBUG_printf(...)
+
+// Portas de origem sorteadas para cada consulta (faixa efêmera da IANA)
+#define DNS_PORT_MIN 49152
+#define DNS_PORT_COUNT 16384
+#define DNS_PORT_TRIES 4
+
+#define DNS_HEADER_SIZE 12
+#define DNS_MSG_SIZE 512 // limite de uma resposta por UDP sem EDNS
+#define DNS_FLAG_QR 0x80
+#define DNS_FLAG_RD 0x01
+#define DNS_TYPE_A 1
+#define DNS_TYPE_CNAME 5
+#define DNS_CLASS_IN 1
+
+typedef struct {
+    char name[DNS_CACHE_NAME_SIZE]; // vazio = entrada livre
+    struct udp_pcb *pcb;            // socket da consulta em andamento
+    ip_addr_t addr;
+    bool has_addr;  // addr vale (mesmo expirado ou em renovação)
+    bool querying;
+    bool used;      // consultada desde a última resposta
+    bool stale;     // addr sobrevivendo a falhas, até stale_until_ms
+    uint8_t tries;
+    uint16_t txid;
+    uint32_t expires_ms;
+    uint32_t refresh_ms;
+    uint32_t sent_ms;
+    uint32_t last_used_ms;
+    uint32_t stale_until_ms; // fixado na primeira falha, não é adiado pelas seguintes
+} dns_entry_t;
+
+typedef struct {
+    dns_entry_t *entry; // NULL = livre
+    dns_found_callback found;
+    void *arg;
+} dns_waiter_t;
+
+static dns_entry_t entries[DNS_CACHE_SIZE];
+static dns_waiter_t waiters[DNS_CACHE_MAX_WAITERS];
+static bool timer_running;
+static uint32_t timer_deadline_ms;
+static dns_cache_stats_t stats;
+
+// Comparações de tempo que sobrevivem à volta do sys_now()
+static inline bool time_reached(uint32_t now, uint32_t t) {
+    return (int32_t)(now - t) >= 0;
+}
+
+static inline uint8_t to_lower(uint8_t c) {
+    return (c >= 'A' && c <= 'Z') ? (uint8_t)(c | 0x20) : c;
+}
+
+// --- Mensagens -----------------------------------------------------------
+
+static uint16_t get16(const uint8_t *p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static uint32_t get32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+// Monta a pergunta (tipo A) para name; retorna o tamanho ou 0 se o nome é inválido
+static uint16_t build_query(uint8_t *msg, uint16_t txid, const char *name) {
+    uint16_t off = DNS_HEADER_SIZE;
+
+    memset(msg, 0, DNS_HEADER_SIZE);
+    msg[0] = txid >> 8;
+    msg[1] = txid & 0xff;
+    msg[2] = DNS_FLAG_RD;
+    msg[5] = 1; // uma pergunta
+
+    // "api.exemplo.com" -> 3 api 7 exemplo 3 com 0
+    while (*name) {
+        const char *dot = strchr(name, '.');
+        size_t label = dot ? (size_t)(dot - name) : strlen(name);
+        if (label == 0 || label > 63 || off + 1 + label + 5 > DNS_MSG_SIZE) {
+            return 0;
+        }
+        msg[off++] = (uint8_t)label;
+        memcpy(&msg[off], name, label);
+        off += label;
+        name += label;
+        if (*name == '.') {
+            name++;
+        }
+    }
+    msg[off++] = 0;
+    msg[off++] = 0;
+    msg[off++] = DNS_TYPE_A;
+    msg[off++] = 0;
+    msg[off++] = DNS_CLASS_IN;
+    return off;
+}
+
+// Pula um nome (rótulos ou ponteiro de compressão); retorna 0 se malformado
+static uint16_t skip_name(const uint8_t *msg, uint16_t len, uint16_t off) {
+    while (off < len) {
+        uint8_t label = msg[off];
+        if (label == 0) {
+            return off + 1;
+        }
+        if ((label & 0xc0) == 0xc0) {
+            return off + 2 <= len ? off + 2 : 0;
+        }
+        off += 1 + label;
+    }
+    return 0;
+}
+
+// Confere o nome da pergunta na resposta (sem ponteiros, como foi enviado)
+static bool name_matches(const uint8_t *msg, uint16_t len, uint16_t off, const char *name) {
+    while (off < len && msg[off] != 0) {
+        uint8_t label = msg[off++];
+        if (label > 63 || off + label > len) {
+            return false;
+        }
+        for (uint8_t i = 0; i < label; i++) {
+            if (*name == '\0' || to_lower(msg[off + i]) != to_lower((uint8_t)*name++)) {
+                return false;
+            }
+        }
+        off += label;
+        if (*name == '.') {
+            name++;
+        }
+    }
+    return off < len && *name == '\0';
+}
+
+// --- Entradas e espera ---------------------------------------------------
+
+static void notify_waiters(dns_entry_t *entry, const ip_addr_t *addr) {
+    for (int i = 0; i < DNS_CACHE_MAX_WAITERS; i++) {
+        dns_waiter_t *w = &waiters[i];
+        if (w->entry == entry) {
+            w->entry = NULL;
+            // found() pode chamar dns_cache_lookup de novo; a vaga já está livre
+            w->found(entry->name, addr, w->arg);
+        }
+    }
+}
+
+static void dns_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr, u16_t port);
+
+// Cada consulta sai de um socket próprio, numa porta sorteada: quem quiser
+// forjar a resposta tem que acertar a porta e o txid (30 bits), não só o
+// txid. O socket vive até a resposta ou a última retransmissão.
+static struct udp_pcb *query_open(dns_entry_t *entry) {
+    struct udp_pcb *pcb = udp_new_ip_type(IPADDR_TYPE_ANY);
+    if (!pcb) {
+        return NULL;
+    }
+    for (int i = 0; i < DNS_PORT_TRIES; i++) {
+        u16_t port = (u16_t)(DNS_PORT_MIN + LWIP_RAND() % DNS_PORT_COUNT);
+        if (udp_bind(pcb, IP_ANY_TYPE, port) == ERR_OK) {
+            udp_recv(pcb, dns_recv, entry);
+            return pcb;
+        }
+    }
+    udp_remove(pcb);
+    return NULL;
+}
+
+static void query_close(dns_entry_t *entry) {
+    if (entry->pcb) {
+        udp_remove(entry->pcb);
+        entry->pcb = NULL;
+    }
+}
+
+static void query_send(dns_entry_t *entry) {
+    static uint8_t msg[DNS_MSG_SIZE];
+    const ip_addr_t *server = dns_getserver(0);
+    uint16_t len = build_query(msg, entry->txid, entry->name);
+
+    if (!entry->pcb) {
+        // Pool de sockets do lwIP cheio na tentativa anterior
+        entry->pcb = query_open(entry);
+    }
+    entry->sent_ms = sys_now();
+    entry->tries++;
+    if (!entry->pcb || len == 0 || !server || ip_addr_isany(server)) {
+        return; // o timer conta como tentativa perdida
+    }
+
+    struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, len, PBUF_RAM);
+    if (!p) {
+        return;
+    }
+    pbuf_take(p, msg, len);
+    udp_sendto(entry->pcb, p, server, DNS_SERVER_PORT);
+    pbuf_free(p);
+    stats.queries++;
+}
+
+static void query_start(dns_entry_t *entry) {
+    entry->querying = true;
+    entry->tries = 0;
+    entry->txid = (uint16_t)LWIP_RAND();
+    query_send(entry);
+}
+
+static void query_failed(dns_entry_t *entry) {
+    uint32_t now = sys_now();
+
+    entry->querying = false;
+    query_close(entry);
+    // Só volta a consultar se alguém pedir o nome de novo: com o servidor
+    // DNS fora, o timer não fica renovando uma entrada que ninguém usa
+    entry->used = false;
+    stats.failures++;
+
+    if (entry->has_addr && !entry->stale) {
+        entry->stale = true;
+        entry->stale_until_ms = now + DNS_CACHE_STALE_S * 1000;
+    }
+    if (entry->has_addr && time_reached(now, entry->stale_until_ms)) {
+        // Tempo demais sem confirmar o endereço: pode não valer mais
+        entry->has_addr = false;
+        entry->stale = false;
+    }
+
+    if (entry->has_addr) {
+        // Serve o endereço antigo por mais um pouco em vez de derrubar as
+        // requisições (o servidor DNS pode estar só momentaneamente fora)
+        entry->expires_ms = now + DNS_CACHE_MIN_TTL_S * 1000;
+        if (!time_reached(entry->stale_until_ms, entry->expires_ms)) {
+            entry->expires_ms = entry->stale_until_ms;
+        }
+        entry->refresh_ms = now + DNS_CACHE_MIN_TTL_S * 1000 / 2;
+        stats.stale++;
+        notify_waiters(entry, &entry->addr);
+    } else {
+        notify_waiters(entry, NULL);
+        if (!entry->querying) {
+            entry->name[0] = '\0'; // ninguém tentou de novo em found()
+        }
+    }
+}
+
+static void query_done(dns_entry_t *entry, const ip_addr_t *addr, uint32_t ttl_s) {
+    uint32_t now = sys_now();
+
+    if (ttl_s < DNS_CACHE_MIN_TTL_S) {
+        ttl_s = DNS_CACHE_MIN_TTL_S;
+    } else if (ttl_s > DNS_CACHE_MAX_TTL_S) {
+        ttl_s = DNS_CACHE_MAX_TTL_S;
+    }
+    DEBUG_printf("dns_cache: %s ttl %lu s\n", entry->name, ttl_s);
+
+    entry->addr = *addr;
+    entry->has_addr = true;
+    entry->stale = false;
+    entry->querying = false;
+    query_close(entry);
+    entry->used = false;
+    entry->expires_ms = now + ttl_s * 1000;
+    entry->refresh_ms = now + ttl_s * 10 * DNS_CACHE_PREFETCH_PERCENT;
+    notify_waiters(entry, &entry->addr);
+}
+
+static void dns_recv_message(dns_entry_t *entry, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr,
+                             u16_t port) {
+    static uint8_t msg[DNS_MSG_SIZE];
+
+    uint16_t len = pbuf_copy_partial(p, msg, sizeof(msg), 0);
+    pbuf_free(p);
+    if (len < DNS_HEADER_SIZE || port != DNS_SERVER_PORT) {
+        return;
+    }
+
+    const ip_addr_t *server = dns_getserver(0);
+    if (!entry->querying || entry->pcb != pcb || get16(&msg[0]) != entry->txid || !(msg[2] & DNS_FLAG_QR) ||
+        !server || !ip_addr_cmp(addr, server)) {
+        return;
+    }
+    if (get16(&msg[4]) != 1 || !name_matches(msg, len, DNS_HEADER_SIZE, entry->name)) {
+        return;
+    }
+    if ((msg[3] & 0x0f) != 0) {
+        query_failed(entry); // NXDOMAIN etc.: não adianta retransmitir
+        return;
+    }
+
+    // Primeiro registro A; o TTL é o menor da cadeia de CNAMEs até ele
+    uint16_t off = skip_name(msg, len, DNS_HEADER_SIZE);
+    if (off == 0) {
+        query_failed(entry);
+        return;
+    }
+    off += 4;
+    uint16_t answers = get16(&msg[6]);
+    uint32_t ttl = UINT32_MAX;
+    for (uint16_t i = 0; i < answers; i++) {
+        off = skip_name(msg, len, off);
+        if (off == 0 || off + 10 > len) {
+            break;
+        }
+        uint16_t type = get16(&msg[off]);
+        uint16_t class = get16(&msg[off + 2]);
+        uint32_t rr_ttl = get32(&msg[off + 4]);
+        uint16_t rdlen = get16(&msg[off + 8]);
+        off += 10;
+        if (off + rdlen > len) {
+            break;
+        }
+        if (class == DNS_CLASS_IN && (type == DNS_TYPE_A || type == DNS_TYPE_CNAME) && rr_ttl < ttl) {
+            ttl = rr_ttl;
+        }
+        if (class == DNS_CLASS_IN && type == DNS_TYPE_A && rdlen == 4) {
+            ip_addr_t found;
+            IP_ADDR4(&found, msg[off], msg[off + 1], msg[off + 2], msg[off + 3]);
+            query_done(entry, &found, ttl);
+            return;
+        }
+        off += rdlen;
+    }
+    query_failed(entry);
+}
+
+// O timer só fica armado enquanto há uma consulta no ar ou uma renovação
+// marcada, e para no prazo mais próximo: com o cache parado, a CPU não é
+// acordada por ele (tickless idle)
+static void dns_timer(void *arg);
+
+static void timer_schedule(void) {
+    uint32_t now = sys_now();
+    bool pending = false;
+    uint32_t deadline = 0;
+
+    for (int i = 0; i < DNS_CACHE_SIZE; i++) {
+        dns_entry_t *entry = &entries[i];
+        uint32_t t;
+        if (entry->name[0] == '\0') {
+            continue;
+        }
+        if (entry->querying) {
+            t = entry->sent_ms + DNS_CACHE_RETRY_MS;
+        } else if (entry->used && entry->has_addr) {
+            t = entry->refresh_ms;
+        } else {
+            continue;
+        }
+        if (!pending || (int32_t)(t - deadline) < 0) {
+            deadline = t;
+            pending = true;
+        }
+    }
+
+    if (timer_running && (!pending || deadline != timer_deadline_ms)) {
+        sys_untimeout(dns_timer, NULL);
+        timer_running = false;
+    }
+    if (pending && !timer_running) {
+        timer_running = true;
+        timer_deadline_ms = deadline;
+        sys_timeout(time_reached(now, deadline) ? 0 : deadline - now, dns_timer, NULL);
+    }
+}
+
+static void dns_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr, u16_t port) {
+    dns_recv_message((dns_entry_t *)arg, pcb, p, addr, port);
+    timer_schedule();
+}
+
+// Retransmissões e renovação em segundo plano
+static void dns_timer(void *arg) {
+    uint32_t now = sys_now();
+    LWIP_UNUSED_ARG(arg);
+    timer_running = false;
+
+    for (int i = 0; i < DNS_CACHE_SIZE; i++) {
+        dns_entry_t *entry = &entries[i];
+        if (entry->name[0] == '\0') {
+            continue;
+        }
+        if (entry->querying) {
+            if (time_reached(now, entry->sent_ms + DNS_CACHE_RETRY_MS)) {
+                if (entry->tries < DNS_CACHE_RETRIES) {
+                    query_send(entry);
+                } else {
+                    query_failed(entry);
+                }
+            }
+        } else if (entry->used && time_reached(now, entry->refresh_ms)) {
+            stats.prefetches++;
+            query_start(entry);
+        }
+    }
+    timer_schedule();
+}
+
+static dns_entry_t *entry_find(const char *name) {
+    for (int i = 0; i < DNS_CACHE_SIZE; i++) {
+        if (entries[i].name[0] != '\0' && strcmp(entries[i].name, name) == 0) {
+            return &entries[i];
+        }
+    }
+    return NULL;
+}
+
+// Entrada livre, ou a usada há mais tempo que não está no meio de uma consulta
+static dns_entry_t *entry_alloc(const char *name) {
+    dns_entry_t *victim = NULL;
+
+    for (int i = 0; i < DNS_CACHE_SIZE; i++) {
+        dns_entry_t *entry = &entries[i];
+        if (entry->name[0] == '\0') {
+            victim = entry;
+            break;
+        }
+        if (!entry->querying && (!victim || (int32_t)(entry->last_used_ms - victim->last_used_ms) < 0)) {
+            victim = entry;
+        }
+    }
+    if (victim) {
+        memset(victim, 0, sizeof(*victim));
+        strncpy(victim->name, name, sizeof(victim->name) - 1);
+    }
+    return victim;
+}
+
+// --- API -----------------------------------------------------------------
+
+err_t dns_cache_lookup(const char *name, ip_addr_t *addr, dns_found_callback found, void *arg) {
+    uint32_t now = sys_now();
+
+    if (strlen(name) >= DNS_CACHE_NAME_SIZE) {
+        return ERR_ARG;
+    }
+
+    dns_entry_t *entry = entry_find(name);
+    if (entry) {
+        entry->last_used_ms = now;
+        entry->used = true;
+        if (entry->has_addr && !time_reached(now, entry->expires_ms)) {
+            stats.hits++;
+            *addr = entry->addr;
+            if (!entry->querying && time_reached(now, entry->refresh_ms)) {
+                stats.prefetches++;
+                query_start(entry);
+            }
+            timer_schedule(); // used pode ter marcado uma renovação
+            return ERR_OK;
+        }
+    } else {
+        entry = entry_alloc(name);
+        if (!entry) {
+            return ERR_MEM;
+        }
+        entry->last_used_ms = now;
+        entry->used = true;
+    }
+
+    dns_waiter_t *waiter = NULL;
+    for (int i = 0; i < DNS_CACHE_MAX_WAITERS; i++) {
+        if (!waiters[i].entry) {
+            waiter = &waiters[i];
+            break;
+        }
+    }
+    if (!waiter) {
+        return ERR_MEM;
+    }
+
+    stats.misses++;
+    waiter->entry = entry;
+    waiter->found = found;
+    waiter->arg = arg;
+    if (!entry->querying) {
+        query_start(entry);
+    }
+    timer_schedule();
+    return ERR_INPROGRESS;
+}
+
+void dns_cache_cancel(void *arg) {
+    for (int i = 0; i < DNS_CACHE_MAX_WAITERS; i++) {
+        if (waiters[i].entry && waiters[i].arg == arg) {
+            waiters[i].entry = NULL;
+        }
+    }
+}
+
+void dns_cache_get_stats(dns_cache_stats_t *out) {
+    *out = stats;
+}
@@ -0,0 +1,94 @@
+#ifndef DNS_CACHE_H
+#define DNS_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "lwip/ip_addr.h"
+#include "lwip/dns.h"
+
+// Cache de resolução de nomes por hostname, usado pelo http_client.
+//
+// As consultas são feitas direto por UDP no servidor DNS configurado pelo
+// DHCP (o resolvedor do lwIP não expõe o TTL da resposta). Cada resposta fica
+// guardada pelo TTL que veio nela; quando passa de DNS_CACHE_PREFETCH_PERCENT
+// do TTL, a próxima consulta ainda é atendida na hora com o endereço guardado
+// e a renovação sai em segundo plano. Um timer do lwIP faz as retransmissões
+// e renova também as entradas usadas desde a última renovação, então um
+// host consultado com frequência nunca chega a expirar. O timer é armado
+// para o próximo prazo e só existe enquanto há consulta ou renovação
+// pendente.
+//
+// Se a renovação falha, o endereço antigo continua valendo por no máximo
+// DNS_CACHE_STALE_S e só é reconsultado quando alguém pede o nome de novo.
+//
+// Cada consulta usa um socket UDP próprio, numa porta de origem sorteada,
+// além do txid aleatório: até DNS_CACHE_SIZE sockets do MEMP_NUM_UDP_PCB
+// ao mesmo tempo, somados aos do DHCP e do resolvedor do lwIP.
+//
+// Todas as funções rodam no contexto do lwIP (callbacks ou entre
+// cyw43_arch_lwip_begin/end).
+
+#ifndef DNS_CACHE_SIZE
+#define DNS_CACHE_SIZE 4
+#endif
+
+// Consultas esperando resposta ao mesmo tempo (somando todos os nomes)
+#ifndef DNS_CACHE_MAX_WAITERS
+#define DNS_CACHE_MAX_WAITERS 4
+#endif
+
+#ifndef DNS_CACHE_NAME_SIZE
+#define DNS_CACHE_NAME_SIZE 64
+#endif
+
+// Limites para o TTL recebido, em segundos
+#ifndef DNS_CACHE_MIN_TTL_S
+#define DNS_CACHE_MIN_TTL_S 5
+#endif
+
+#ifndef DNS_CACHE_MAX_TTL_S
+#define DNS_CACHE_MAX_TTL_S 3600
+#endif
+
+// Por quanto tempo, contado da primeira falha de renovação, o endereço
+// antigo continua sendo servido enquanto o servidor DNS não responde.
+// Passado esse prazo, a entrada é descartada e a consulta falha.
+#ifndef DNS_CACHE_STALE_S
+#define DNS_CACHE_STALE_S 60
+#endif
+
+// Fração do TTL a partir da qual a entrada é renovada antes de expirar
+#ifndef DNS_CACHE_PREFETCH_PERCENT
+#define DNS_CACHE_PREFETCH_PERCENT 80
+#endif
+
+#ifndef DNS_CACHE_RETRY_MS
+#define DNS_CACHE_RETRY_MS 1000
+#endif
+
+#ifndef DNS_CACHE_RETRIES
+#define DNS_CACHE_RETRIES 3
+#endif
+
+typedef struct {
+    uint32_t hits;       // respondidas na hora, sem consulta
+    uint32_t misses;     // precisaram esperar uma consulta
+    uint32_t prefetches; // renovações feitas antes de expirar
+    uint32_t queries;    // pacotes enviados, incluindo retransmissões
+    uint32_t failures;
+    uint32_t stale;      // servidas com o endereço antigo após falha na renovação
+} dns_cache_stats_t;
+
+// Mesmo contrato do dns_gethostbyname(): ERR_OK com addr preenchido se o
+// nome está no cache, ERR_INPROGRESS se found() será chamada quando a
+// consulta terminar (com NULL em caso de falha), ou outro erro.
+err_t dns_cache_lookup(const char *name, ip_addr_t *addr, dns_found_callback found, void *arg);
+
+// Descarta as chamadas pendentes para arg (a consulta continua e o resultado
+// fica no cache)
+void dns_cache_cancel(void *arg);
+
+void dns_cache_get_stats(dns_cache_stats_t *stats);
+
+#endif
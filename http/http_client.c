@@ -0,0 +1,637 @@
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"
+
+#include "lwip/pbuf.h"
+#include "lwip/tcp.h"
+
+#include "http_client.h"
+#include "http_parser.h"
+#include "dns_cache.h"
+
+#define DEBUG_printf(...)
+
+typedef enum {
+    CONN_FREE,
+    CONN_RESOLVING,
+    CONN_CONNECTING,
+    CONN_CONNECTED,
+} conn_state_t;
+
+typedef struct http_slot_ http_slot_t;
+
+typedef struct {
+    struct tcp_pcb *pcb;
+    conn_state_t state;
+    char host[HTTP_CLIENT_HOST_SIZE];
+    uint16_t port;
+    ip_addr_t addr;
+    http_parser_t parser;
+    struct pbuf *rx_pbuf; // pbuf sendo interpretado, para os body_refs
+    bool response_done;
+    uint64_t start_us;    // início da resolução do nome
+    uint64_t resolved_us; // início do handshake
+
+    // Requisições desta conexão na ordem em que as respostas vão chegar; as
+    // `sent` primeiras já foram escritas no TCP. A resposta sendo lida é
+    // sempre a de pipeline[0].
+    http_slot_t *pipeline[HTTP_CLIENT_PIPELINE_DEPTH];
+    uint8_t count;
+    uint8_t sent;
+} http_conn_t;
+
+struct http_slot_ {
+    http_request_t req;
+    http_segment_t single; // req.data/len como segmento único
+    http_result_t result;
+    http_conn_t *conn; // NULL enquanto espera uma conexão
+    uint64_t start_us;
+    uint64_t sent_us;  // escrita no TCP; 0 antes disso
+    uint32_t seq;      // ordem de chegada
+    uint16_t generation;
+    bool used;
+    bool received;
+    bool retried;
+    bool pipelined; // enviada atrás de outra na mesma conexão
+};
+
+static http_conn_t conns[HTTP_CLIENT_MAX_CONNECTIONS];
+static http_slot_t slots[HTTP_CLIENT_MAX_INFLIGHT];
+static uint32_t next_seq;
+static http_client_stats_t stats;
+
+// pcb abortado durante o callback atual; o callback precisa devolver ERR_ABRT
+static struct tcp_pcb *aborted_pcb;
+
+static void dispatch_pending(void);
+static void conn_connect(http_conn_t *conn);
+
+static err_t callback_result(struct tcp_pcb *tpcb) {
+    if (tpcb && aborted_pcb == tpcb) {
+        aborted_pcb = NULL;
+        return ERR_ABRT;
+    }
+    return ERR_OK;
+}
+
+// --- Conclusão -----------------------------------------------------------
+
+static void conn_remove(http_conn_t *conn, http_slot_t *slot) {
+    for (int i = 0; i < conn->count; i++) {
+        if (conn->pipeline[i] == slot) {
+            if (i < conn->sent) {
+                conn->sent--;
+            }
+            memmove(&conn->pipeline[i], &conn->pipeline[i + 1], (conn->count - i - 1) * sizeof(conn->pipeline[0]));
+            conn->count--;
+            break;
+        }
+    }
+    slot->conn = NULL;
+}
+
+static void slot_finish(http_slot_t *slot, err_t err) {
+    http_request_t *req = &slot->req;
+
+    slot->result.err = err;
+    uint64_t now = time_us_64();
+    slot->result.latency_us = now - slot->start_us;
+    if (slot->sent_us) {
+        slot->result.transfer_us = now - slot->sent_us;
+    }
+    if (slot->conn) {
+        conn_remove(slot->conn, slot);
+    }
+    slot->used = false;
+    if (err != ERR_OK) {
+        stats.failures++;
+    }
+
+    if (req->result) {
+        *req->result = slot->result;
+    }
+    if (req->on_done) {
+        req->on_done(req->arg, &slot->result);
+    }
+    if (req->notify_task) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveIndexedFromISR(req->notify_task, HTTP_CLIENT_NOTIFY_INDEX, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+// --- Conexões ------------------------------------------------------------
+
+static void conn_close(http_conn_t *conn) {
+    if (conn->state == CONN_RESOLVING) {
+        dns_cache_cancel(conn);
+    }
+    if (conn->pcb) {
+        tcp_arg(conn->pcb, NULL);
+        tcp_poll(conn->pcb, NULL, 0);
+        tcp_sent(conn->pcb, NULL);
+        tcp_recv(conn->pcb, NULL);
+        tcp_err(conn->pcb, NULL);
+        if (tcp_close(conn->pcb) != ERR_OK) {
+            tcp_abort(conn->pcb);
+            aborted_pcb = conn->pcb;
+        }
+        conn->pcb = NULL;
+    }
+    conn->state = CONN_FREE;
+}
+
+// Encerra a conexão. As requisições que estavam nela e ainda não receberam
+// nada voltam para a fila uma vez se a falha pode ser da conexão e não delas
+// (keep-alive que caiu, ou enviadas em pipeline atrás de outra); as demais
+// terminam com erro.
+static void conn_fail(http_conn_t *conn, err_t err) {
+    http_slot_t *pending[HTTP_CLIENT_PIPELINE_DEPTH];
+    int n = conn->count;
+
+    conn_close(conn);
+    memcpy(pending, conn->pipeline, n * sizeof(pending[0]));
+    conn->count = 0;
+    conn->sent = 0;
+
+    for (int i = 0; i < n; i++) {
+        http_slot_t *slot = pending[i];
+        slot->conn = NULL;
+        if (!slot->received && !slot->retried && (slot->result.reused || slot->pipelined)) {
+            DEBUG_printf("http_client: reenviando\n");
+            slot->retried = true;
+            slot->pipelined = false;
+            slot->result.reused = false;
+            stats.retries++;
+        } else {
+            slot_finish(slot, err);
+        }
+    }
+    dispatch_pending();
+}
+
+// Escreve as requisições ainda não enviadas. Todas menos a última levam
+// TCP_WRITE_FLAG_MORE, então um lote sai em segmentos cheios e um único
+// tcp_output. O que não couber no buffer de envio sai no tcp_sent.
+static void conn_flush(http_conn_t *conn) {
+    bool wrote = false;
+
+    if (conn->state != CONN_CONNECTED) {
+        return;
+    }
+    while (conn->sent < conn->count) {
+        http_slot_t *slot = conn->pipeline[conn->sent];
+        const http_request_t *req = &slot->req;
+
+        // A requisição vai inteira ou fica para o próximo tcp_sent: uma
+        // escrita pela metade deixaria a conexão inutilizável. Cada segmento
+        // pode ocupar um pbuf a mais na fila de envio.
+        uint32_t total = 0;
+        uint32_t queue = 0;
+        for (int i = 0; i < req->segment_count; i++) {
+            total += req->segments[i].len;
+            queue += 1 + (req->segments[i].len + TCP_MSS - 1) / TCP_MSS;
+        }
+        if (total > tcp_sndbuf(conn->pcb) || tcp_sndqueuelen(conn->pcb) + queue > TCP_SND_QUEUELEN) {
+            break;
+        }
+
+        for (int i = 0; i < req->segment_count; i++) {
+            const http_segment_t *segment = &req->segments[i];
+            // Partes constantes vão por referência (pbuf apontando para a
+            // flash), sem cópia para o buffer de envio do lwIP
+            u8_t flags = segment->copy ? TCP_WRITE_FLAG_COPY : 0;
+            if (i + 1 < req->segment_count || conn->sent + 1 < conn->count) {
+                flags |= TCP_WRITE_FLAG_MORE;
+            }
+            if (segment->len == 0) {
+                continue;
+            }
+            err_t err = tcp_write(conn->pcb, segment->data, segment->len, flags);
+            if (err != ERR_OK) {
+                conn_fail(conn, err);
+                return;
+            }
+            if (segment->copy) {
+                stats.tx_bytes_copied += segment->len;
+            } else {
+                stats.tx_bytes_referenced += segment->len;
+            }
+        }
+        slot->sent_us = time_us_64();
+        conn->sent++;
+        wrote = true;
+    }
+    if (wrote && tcp_output(conn->pcb) != ERR_OK) {
+        conn_fail(conn, ERR_CONN);
+    }
+}
+
+static void parser_on_status(http_parser_t *parser, int status) {
+    http_conn_t *conn = (http_conn_t *)parser->arg;
+    conn->pipeline[0]->result.status = status;
+}
+
+static void parser_on_body(http_parser_t *parser, const uint8_t *data, size_t len) {
+    http_conn_t *conn = (http_conn_t *)parser->arg;
+    http_slot_t *slot = conn->pipeline[0];
+    http_request_t *req = &slot->req;
+
+    if (req->on_body) {
+        req->on_body(req->arg, data, len);
+    }
+    if (req->body_refs && slot->result.body_refs < req->body_ref_count) {
+        http_body_ref_t *ref = &req->body_refs[slot->result.body_refs++];
+        pbuf_ref(conn->rx_pbuf);
+        ref->p = conn->rx_pbuf;
+        ref->data = data;
+        ref->len = (uint16_t)len; // nunca passa de um pbuf
+        stats.bytes_referenced += len;
+    }
+    if (req->body_buf && req->body_size > 0) {
+        size_t left = req->body_size - 1 - slot->result.body_len;
+        size_t n = len < left ? len : left;
+        memcpy(req->body_buf + slot->result.body_len, data, n);
+        req->body_buf[slot->result.body_len + n] = '\0';
+        stats.bytes_copied += n;
+    }
+    slot->result.body_len += len;
+}
+
+static void parser_on_complete(http_parser_t *parser) {
+    http_conn_t *conn = (http_conn_t *)parser->arg;
+    conn->response_done = true;
+}
+
+static const http_parser_settings_t parser_settings = {
+    .on_status = parser_on_status,
+    .on_body = parser_on_body,
+    .on_complete = parser_on_complete,
+};
+
+static err_t tcp_client_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err) {
+    http_conn_t *conn = (http_conn_t *)arg;
+    aborted_pcb = NULL;
+
+    if (!p) {
+        // Servidor fechou; respostas sem Content-Length terminam aqui
+        http_slot_t *slot = conn->count ? conn->pipeline[0] : NULL;
+        if (slot && slot->received) {
+            http_parser_finish(&conn->parser);
+            if (http_parser_done(&conn->parser)) {
+                slot_finish(slot, ERR_OK);
+            }
+        }
+        conn_fail(conn, ERR_CLSD);
+        return callback_result(tpcb);
+    }
+
+    // Um mesmo segmento pode trazer o fim de uma resposta e o começo da
+    // seguinte; cada uma vai para a requisição da vez
+    uint16_t offset = 0;
+    bool must_close = false;
+    conn->rx_pbuf = p;
+    while (offset < p->tot_len && conn->sent > 0) {
+        http_slot_t *slot = conn->pipeline[0];
+        slot->received = true;
+        offset += http_parser_execute_pbuf(&conn->parser, p, offset);
+
+        if (http_parser_failed(&conn->parser)) {
+            must_close = true;
+            break;
+        }
+        if (!conn->response_done) {
+            break;
+        }
+        bool keep = slot->req.keep_alive && http_parser_keep_alive(&conn->parser);
+        slot_finish(slot, ERR_OK);
+        http_parser_reset(&conn->parser);
+        conn->response_done = false;
+        if (!keep) {
+            must_close = true;
+            break;
+        }
+    }
+    conn->rx_pbuf = NULL;
+    // A janela reabre já: o que ficou em body_refs segura só os pbufs
+    tcp_recved(tpcb, p->tot_len);
+    pbuf_free(p);
+
+    if (must_close) {
+        conn_fail(conn, http_parser_failed(&conn->parser) ? ERR_VAL : ERR_CLSD);
+    } else {
+        dispatch_pending();
+    }
+    return callback_result(tpcb);
+}
+
+static err_t tcp_client_sent(void *arg, struct tcp_pcb *tpcb, u16_t len) {
+    http_conn_t *conn = (http_conn_t *)arg;
+    LWIP_UNUSED_ARG(len);
+    aborted_pcb = NULL;
+    conn_flush(conn);
+    return callback_result(tpcb);
+}
+
+static err_t tcp_client_connected(void *arg, struct tcp_pcb *tpcb, err_t err) {
+    http_conn_t *conn = (http_conn_t *)arg;
+    aborted_pcb = NULL;
+    if (err != ERR_OK) {
+        conn_fail(conn, err);
+    } else {
+        // As requisições que esperaram por esta conexão pagaram DNS + handshake
+        uint64_t now = time_us_64();
+        for (int i = 0; i < conn->count; i++) {
+            http_result_t *result = &conn->pipeline[i]->result;
+            result->dns_us = conn->resolved_us - conn->start_us;
+            result->connect_us = now - conn->resolved_us;
+        }
+        conn->state = CONN_CONNECTED;
+        conn_flush(conn);
+    }
+    return callback_result(tpcb);
+}
+
+static err_t tcp_client_poll(void *arg, struct tcp_pcb *tpcb) {
+    http_conn_t *conn = (http_conn_t *)arg;
+    aborted_pcb = NULL;
+    http_slot_t *slot = conn->count ? conn->pipeline[0] : NULL;
+    if (slot && time_us_64() - slot->start_us > (uint64_t)HTTP_CLIENT_TIMEOUT_MS * 1000) {
+        DEBUG_printf("http_client: timeout\n");
+        // Sem reenvio: o servidor já teve o tempo todo para responder
+        slot->retried = true;
+        conn_fail(conn, ERR_TIMEOUT);
+    }
+    return callback_result(tpcb);
+}
+
+static void tcp_client_err(void *arg, err_t err) {
+    http_conn_t *conn = (http_conn_t *)arg;
+    // O lwIP já liberou o pcb
+    conn->pcb = NULL;
+    conn_fail(conn, err);
+}
+
+static void dns_found(const char *name, const ip_addr_t *ipaddr, void *arg) {
+    http_conn_t *conn = (http_conn_t *)arg;
+    if (conn->state != CONN_RESOLVING || strcmp(name, conn->host) != 0) {
+        return; // cancelada enquanto resolvia
+    }
+    if (!ipaddr) {
+        for (int i = 0; i < conn->count; i++) {
+            conn->pipeline[i]->result.dns_us = time_us_64() - conn->start_us;
+        }
+        conn_fail(conn, ERR_RTE);
+        return;
+    }
+    conn->addr = *ipaddr;
+    conn_connect(conn);
+}
+
+static void conn_connect(http_conn_t *conn) {
+    conn->resolved_us = time_us_64();
+    conn->pcb = tcp_new_ip_type(IP_GET_TYPE(&conn->addr));
+    if (!conn->pcb) {
+        conn_fail(conn, ERR_MEM);
+        return;
+    }
+
+    tcp_arg(conn->pcb, conn);
+    tcp_poll(conn->pcb, tcp_client_poll, HTTP_CLIENT_POLL_INTERVAL);
+    tcp_sent(conn->pcb, tcp_client_sent);
+    tcp_recv(conn->pcb, tcp_client_recv);
+    tcp_err(conn->pcb, tcp_client_err);
+    // Detecta servidor que sumiu enquanto a conexão keep-alive está ociosa
+    ip_set_option(conn->pcb, SOF_KEEPALIVE);
+
+    conn->state = CONN_CONNECTING;
+    stats.connections++;
+    err_t err = tcp_connect(conn->pcb, &conn->addr, conn->port, tcp_client_connected);
+    if (err != ERR_OK) {
+        conn_fail(conn, err);
+    }
+}
+
+// Coloca a requisição na conexão. Se a conexão ainda não existe, resolve o
+// nome (se preciso) e conecta; o envio acontece em conn_flush.
+static void conn_start(http_conn_t *conn, http_slot_t *slot) {
+    slot->conn = conn;
+    slot->pipelined = conn->count > 0;
+    slot->result.reused = conn->state == CONN_CONNECTED;
+    conn->pipeline[conn->count++] = slot;
+
+    if (slot->result.reused) {
+        stats.reused++;
+    }
+    if (slot->pipelined) {
+        stats.pipelined++;
+    }
+    if (conn->state != CONN_FREE) {
+        return;
+    }
+
+    strncpy(conn->host, slot->req.host, sizeof(conn->host) - 1);
+    conn->host[sizeof(conn->host) - 1] = '\0';
+    conn->port = slot->req.port;
+    http_parser_init(&conn->parser, &parser_settings, conn);
+    conn->response_done = false;
+
+    conn->start_us = time_us_64();
+    if (ip4addr_aton(conn->host, &conn->addr)) {
+        conn_connect(conn);
+        return;
+    }
+
+    conn->state = CONN_RESOLVING;
+    // Nome em cache responde na hora; a renovação antes do TTL vencer
+    // acontece em segundo plano
+    err_t err = dns_cache_lookup(conn->host, &conn->addr, dns_found, conn);
+    if (err == ERR_OK) {
+        conn_connect(conn);
+    } else if (err != ERR_INPROGRESS) {
+        conn_fail(conn, err);
+    }
+}
+
+// Só GET vai em pipeline: se a conexão cair, reenviar é seguro. HEAD também
+// seria, mas o parser não sabe que a resposta dele vem sem corpo.
+static bool can_pipeline(const http_request_t *req) {
+    const http_segment_t *first = &req->segments[0];
+    return HTTP_CLIENT_PIPELINE_DEPTH > 1 && req->keep_alive && first->len > 4 && memcmp(first->data, "GET ", 4) == 0;
+}
+
+static bool same_destination(const http_conn_t *conn, const http_request_t *req) {
+    return conn->port == req->port && strncmp(conn->host, req->host, sizeof(conn->host)) == 0;
+}
+
+// Escolhe uma conexão para a requisição, nesta ordem: uma aberta e ociosa
+// para o mesmo destino, uma para o mesmo destino com vaga no pipeline, uma
+// livre. Uma conexão ociosa de outro destino é fechada se não sobrar
+// nenhuma livre.
+static http_conn_t *conn_find(const http_request_t *req) {
+    http_conn_t *pipeline_conn = NULL;
+    http_conn_t *free_conn = NULL;
+    http_conn_t *idle_conn = NULL;
+
+    for (int i = 0; i < HTTP_CLIENT_MAX_CONNECTIONS; i++) {
+        http_conn_t *conn = &conns[i];
+        if (conn->state == CONN_FREE) {
+            free_conn = free_conn ? free_conn : conn;
+        } else if (conn->count == 0) {
+            if (same_destination(conn, req)) {
+                return conn;
+            }
+            idle_conn = idle_conn ? idle_conn : conn;
+        } else if (!pipeline_conn && conn->count < HTTP_CLIENT_PIPELINE_DEPTH && same_destination(conn, req) &&
+                   can_pipeline(req) && can_pipeline(&conn->pipeline[0]->req)) {
+            pipeline_conn = conn;
+        }
+    }
+
+    if (pipeline_conn) {
+        return pipeline_conn;
+    }
+    if (!free_conn && idle_conn) {
+        conn_close(idle_conn);
+        free_conn = idle_conn;
+    }
+    return free_conn;
+}
+
+// Distribui as requisições que estão esperando, na ordem de chegada, e
+// depois escreve de uma vez o que cada conexão recebeu
+static void dispatch_pending(void) {
+    while (1) {
+        http_slot_t *next = NULL;
+        for (int i = 0; i < HTTP_CLIENT_MAX_INFLIGHT; i++) {
+            http_slot_t *slot = &slots[i];
+            if (slot->used && !slot->conn && (!next || (int32_t)(slot->seq - next->seq) < 0)) {
+                next = slot;
+            }
+        }
+        if (!next) {
+            break;
+        }
+        http_conn_t *conn = conn_find(&next->req);
+        if (!conn) {
+            break;
+        }
+        conn_start(conn, next);
+    }
+
+    for (int i = 0; i < HTTP_CLIENT_MAX_CONNECTIONS; i++) {
+        if (conns[i].sent < conns[i].count) {
+            conn_flush(&conns[i]);
+        }
+    }
+}
+
+// --- API -----------------------------------------------------------------
+
+int http_client_request(const http_request_t *req) {
+    int handle = ERR_MEM;
+
+    cyw43_arch_lwip_begin();
+    for (int i = 0; i < HTTP_CLIENT_MAX_INFLIGHT; i++) {
+        http_slot_t *slot = &slots[i];
+        if (slot->used) {
+            continue;
+        }
+        uint16_t generation = slot->generation + 1;
+        memset(slot, 0, sizeof(*slot));
+        slot->req = *req;
+        if (!req->segments) {
+            slot->single.data = req->data;
+            slot->single.len = req->len;
+            slot->single.copy = true;
+            slot->req.segments = &slot->single;
+            slot->req.segment_count = 1;
+        }
+        slot->generation = generation;
+        slot->seq = next_seq++;
+        slot->start_us = time_us_64();
+        slot->used = true;
+        stats.requests++;
+        handle = ((int)generation << 8) | i;
+
+        if (req->body_buf && req->body_size > 0) {
+            req->body_buf[0] = '\0';
+        }
+        dispatch_pending();
+        break;
+    }
+    cyw43_arch_lwip_end();
+
+    return handle;
+}
+
+void http_client_cancel(int handle) {
+    int i = handle & 0xff;
+    if (handle < 0 || i >= HTTP_CLIENT_MAX_INFLIGHT) {
+        return;
+    }
+
+    cyw43_arch_lwip_begin();
+    http_slot_t *slot = &slots[i];
+    if (slot->used && slot->generation == (uint16_t)(handle >> 8)) {
+        http_conn_t *conn = slot->conn;
+        slot->used = false;
+        // Quem cancela não recebe o resultado, então não teria como liberar
+        for (int j = 0; j < slot->result.body_refs; j++) {
+            pbuf_free(slot->req.body_refs[j].p);
+        }
+        if (conn) {
+            bool was_sent = false;
+            for (int j = 0; j < conn->sent; j++) {
+                was_sent |= conn->pipeline[j] == slot;
+            }
+            conn_remove(conn, slot);
+            // Uma resposta ainda a caminho deixaria a conexão dessincronizada
+            if (was_sent) {
+                conn_fail(conn, ERR_ABRT);
+            }
+        }
+        dispatch_pending();
+    }
+    cyw43_arch_lwip_end();
+}
+
+err_t http_client_request_sync(const http_request_t *req, http_result_t *result) {
+    http_request_t sync_req = *req;
+    sync_req.result = result;
+    sync_req.notify_task = xTaskGetCurrentTaskHandle();
+
+    memset(result, 0, sizeof(*result));
+    xTaskNotifyStateClearIndexed(NULL, HTTP_CLIENT_NOTIFY_INDEX);
+    ulTaskNotifyValueClearIndexed(NULL, HTTP_CLIENT_NOTIFY_INDEX, UINT32_MAX);
+
+    int handle = http_client_request(&sync_req);
+    if (handle < 0) {
+        result->err = (err_t)handle;
+        return result->err;
+    }
+
+    // O timeout normal vem do tcp_poll; este só cobre a fase de DNS
+    TickType_t timeout = pdMS_TO_TICKS(HTTP_CLIENT_TIMEOUT_MS + HTTP_CLIENT_POLL_INTERVAL * 500 * 2);
+    if (!ulTaskNotifyTakeIndexed(HTTP_CLIENT_NOTIFY_INDEX, pdTRUE, timeout)) {
+        http_client_cancel(handle);
+        result->err = ERR_TIMEOUT;
+    }
+    return result->err;
+}
+
+void http_client_body_release(http_body_ref_t *refs, uint8_t count) {
+    cyw43_arch_lwip_begin();
+    for (int i = 0; i < count; i++) {
+        pbuf_free(refs[i].p);
+        refs[i].p = NULL;
+    }
+    cyw43_arch_lwip_end();
+}
+
+void http_client_get_stats(http_client_stats_t *out) {
+    cyw43_arch_lwip_begin();
+    *out = stats;
+    cyw43_arch_lwip_end();
+}
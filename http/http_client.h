@@ -0,0 +1,167 @@
+#ifndef HTTP_CLIENT_H
+#define HTTP_CLIENT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include "lwip/err.h"
+#include "lwip/pbuf.h"
+
+// Cliente HTTP assíncrono em cima do raw API do lwIP, compartilhado pelos
+// exemplos main_get, main_post e main_api.
+//
+// http_client_request() só enfileira a requisição e retorna; a resolução de
+// nome (pelo dns_cache), a conexão, o envio e a leitura da resposta acontecem
+// nos callbacks do lwIP. A conclusão é avisada por callback, por notificação
+// de tarefa ou pelos dois. Conexões keep-alive ficam abertas e são
+// reaproveitadas pela próxima requisição para o mesmo host e porta.
+//
+// Os parâmetros abaixo podem ser trocados por app com
+// target_compile_definitions().
+
+// Conexões TCP abertas ao mesmo tempo
+#ifndef HTTP_CLIENT_MAX_CONNECTIONS
+#define HTTP_CLIENT_MAX_CONNECTIONS 2
+#endif
+
+// Requisições em andamento (as que passarem do número de conexões esperam
+// uma conexão livre)
+#ifndef HTTP_CLIENT_MAX_INFLIGHT
+#define HTTP_CLIENT_MAX_INFLIGHT 4
+#endif
+
+// Requisições escritas de uma vez na mesma conexão, antes das respostas
+// (HTTP/1.1 pipelining). Só GET keep-alive entram no pipeline; as
+// respostas chegam na ordem dos pedidos. 1 desliga.
+#ifndef HTTP_CLIENT_PIPELINE_DEPTH
+#define HTTP_CLIENT_PIPELINE_DEPTH 1
+#endif
+
+// Tempo máximo entre o início da requisição e o fim da resposta
+#ifndef HTTP_CLIENT_TIMEOUT_MS
+#define HTTP_CLIENT_TIMEOUT_MS 5000
+#endif
+
+// Período do tcp_poll, em unidades de 500 ms
+#ifndef HTTP_CLIENT_POLL_INTERVAL
+#define HTTP_CLIENT_POLL_INTERVAL 2
+#endif
+
+#ifndef HTTP_CLIENT_HOST_SIZE
+#define HTTP_CLIENT_HOST_SIZE 64
+#endif
+
+// Índice de notificação usado por http_client_request_sync() e por notify_task
+#ifndef HTTP_CLIENT_NOTIFY_INDEX
+#define HTTP_CLIENT_NOTIFY_INDEX 1
+#endif
+
+typedef struct {
+    err_t err;         // ERR_OK quando a resposta chegou inteira
+    int status;        // status HTTP, 0 se não houve resposta
+    uint32_t body_len; // tamanho total do corpo recebido
+    uint32_t latency_us; // total, desde http_client_request()
+
+    // Fases da latência; dns_us e connect_us ficam em 0 em conexão reaproveitada
+    uint32_t dns_us;      // resolução do nome (cache ou consulta)
+    uint32_t connect_us;  // handshake TCP
+    uint32_t transfer_us; // do envio da requisição ao fim da resposta
+
+    bool reused;       // a conexão já estava aberta (sem handshake)
+    uint8_t body_refs; // descritores preenchidos em body_refs
+} http_result_t;
+
+// Pedaço de uma requisição montada por partes (ver http_template.h)
+typedef struct {
+    const void *data;
+    uint16_t len;
+    // false: data é constante (flash) e vai para o lwIP por referência, sem
+    // cópia; precisa continuar válido até o servidor confirmar o recebimento
+    bool copy;
+} http_segment_t;
+
+// Fatia do corpo recebido que continua no pbuf do lwIP: data aponta para
+// dentro de p, que tem uma referência a mais até http_client_body_release()
+typedef struct {
+    struct pbuf *p;
+    const uint8_t *data;
+    uint16_t len;
+} http_body_ref_t;
+
+// Chamados no contexto do lwIP: não podem bloquear
+typedef void (*http_body_fn)(void *arg, const uint8_t *data, size_t len);
+typedef void (*http_done_fn)(void *arg, const http_result_t *result);
+
+typedef struct {
+    const char *host; // IP ou nome (resolvido por DNS); precisa existir até a conclusão
+    uint16_t port;
+
+    // Requisição completa (linha, cabeçalhos e corpo). É copiada para o
+    // lwIP no envio, mas precisa existir até a conclusão.
+    const void *data;
+    uint16_t len;
+
+    // Alternativa a data/len: a requisição em partes, enviadas em sequência
+    const http_segment_t *segments;
+    uint8_t segment_count;
+
+    // Mantém a conexão aberta depois da resposta, se o servidor permitir
+    bool keep_alive;
+
+    // Opcional: o corpo é copiado aqui (com '\0' no fim, truncado se precisar)
+    char *body_buf;
+    size_t body_size;
+
+    // Opcional: fatias do corpo direto dos pbufs recebidos, sem cópia
+    http_body_fn on_body;
+
+    // Opcional: o corpo fica nos pbufs recebidos e a tarefa o lê depois da
+    // conclusão, sem cópia e fora do contexto do lwIP. Cada fatia ocupa um
+    // descritor; o que não couber em body_ref_count é descartado (conta só
+    // em body_len). Os pbufs ficam presos até http_client_body_release(),
+    // que deve vir logo: são buffers do PBUF_POOL.
+    http_body_ref_t *body_refs;
+    uint8_t body_ref_count;
+
+    // Conclusão: qualquer combinação dos três
+    http_done_fn on_done;
+    TaskHandle_t notify_task;
+    http_result_t *result;
+
+    void *arg;
+} http_request_t;
+
+typedef struct {
+    uint32_t requests;
+    uint32_t failures;
+    uint32_t connections; // conexões abertas (handshakes)
+    uint32_t reused;      // requisições que aproveitaram uma conexão aberta
+    uint32_t pipelined;   // enviadas atrás de outra, sem esperar a resposta
+    uint32_t retries;     // reenvios após uma conexão keep-alive cair
+    uint32_t bytes_copied;        // corpo das respostas copiado para body_buf
+    uint32_t bytes_referenced;    // corpo entregue em body_refs, sem cópia
+    uint32_t tx_bytes_copied;     // enviados copiando para o buffer do lwIP
+    uint32_t tx_bytes_referenced; // enviados por referência, sem cópia
+} http_client_stats_t;
+
+// Enfileira a requisição. Retorna um identificador (>= 0) para
+// http_client_cancel() ou ERR_MEM se todas as vagas estão ocupadas.
+int http_client_request(const http_request_t *req);
+
+// Cancela uma requisição; nenhum aviso de conclusão é dado depois disso
+void http_client_cancel(int handle);
+
+// Envia e bloqueia a tarefa atual (por notificação) até a conclusão
+err_t http_client_request_sync(const http_request_t *req, http_result_t *result);
+
+// Libera os pbufs dos result->body_refs primeiros descritores, também quando
+// a requisição terminou com erro (qualquer tarefa; pega o lock do lwIP)
+void http_client_body_release(http_body_ref_t *refs, uint8_t count);
+
+void http_client_get_stats(http_client_stats_t *stats);
+
+#endif
@@ -0,0 +1,50 @@
+#include "http_format.h"
+
+// "00".."99": dois dígitos por divisão
+static const char digit_pairs[200] = "00010203040506070809"
+                                     "10111213141516171819"
+                                     "20212223242526272829"
+                                     "30313233343536373839"
+                                     "40414243444546474849"
+                                     "50515253545556575859"
+                                     "60616263646566676869"
+                                     "70717273747576777879"
+                                     "80818283848586878889"
+                                     "90919293949596979899";
+
+static size_t count_digits(uint32_t value) {
+    size_t n = 1;
+    while (value >= 10) {
+        value /= 10;
+        n++;
+    }
+    return n;
+}
+
+size_t http_format_uint(char *buf, uint32_t value) {
+    size_t len = count_digits(value);
+    char *p = buf + len;
+
+    // Do fim para o começo, dois dígitos por vez
+    while (value >= 100) {
+        uint32_t pair = (value % 100) * 2;
+        value /= 100;
+        *--p = digit_pairs[pair + 1];
+        *--p = digit_pairs[pair];
+    }
+    if (value >= 10) {
+        *--p = digit_pairs[value * 2 + 1];
+        *--p = digit_pairs[value * 2];
+    } else {
+        *--p = (char)('0' + value);
+    }
+    return len;
+}
+
+size_t http_format_int(char *buf, int32_t value) {
+    if (value < 0) {
+        buf[0] = '-';
+        return 1 + http_format_uint(buf + 1, 0u - (uint32_t)value);
+    }
+    return http_format_uint(buf, (uint32_t)value);
+}
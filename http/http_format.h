@@ -0,0 +1,15 @@
+#ifndef HTTP_FORMAT_H
+#define HTTP_FORMAT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Inteiros em decimal sem printf, para cabeçalhos e corpos montados em
+// pedaços (Content-Length, campos do http_template, temperatura). Só
+// depende da libc: serve também para as aplicações sem o http_client.
+
+// Escreve value em decimal (sem '\0') e retorna o número de caracteres
+size_t http_format_uint(char *buf, uint32_t value);
+size_t http_format_int(char *buf, int32_t value);
+
+#endif
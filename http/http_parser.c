@@ -0,0 +1,365 @@
+#include <stdint.h>
+#include <limits.h>
+
+#include "http_parser.h"
+
+enum {
+    HEADER_CONTENT_LENGTH,
+    HEADER_TRANSFER_ENCODING,
+    HEADER_CONNECTION,
+    HEADER_COUNT,
+};
+
+// Nomes em minúsculas; a comparação ignora maiúsculas/minúsculas
+static const char *const header_names[HEADER_COUNT] = {
+    [HEADER_CONTENT_LENGTH] = "content-length",
+    [HEADER_TRANSFER_ENCODING] = "transfer-encoding",
+    [HEADER_CONNECTION] = "connection",
+};
+
+static const uint8_t header_lengths[HEADER_COUNT] = {
+    [HEADER_CONTENT_LENGTH] = sizeof("content-length") - 1,
+    [HEADER_TRANSFER_ENCODING] = sizeof("transfer-encoding") - 1,
+    [HEADER_CONNECTION] = sizeof("connection") - 1,
+};
+
+#define ALL_HEADERS ((uint8_t)((1u << HEADER_COUNT) - 1))
+
+static inline uint8_t to_lower(uint8_t c) {
+    return (c >= 'A' && c <= 'Z') ? (uint8_t)(c | 0x20) : c;
+}
+
+static inline int hex_value(uint8_t c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    c = to_lower(c);
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// Procura um token (ex.: "chunked") dentro do valor, um caractere por vez
+static bool match_token(http_parser_t *parser, const char *token, uint8_t c) {
+    c = to_lower(c);
+    if (c == (uint8_t)token[parser->token_pos]) {
+        parser->token_pos++;
+    } else {
+        parser->token_pos = (c == (uint8_t)token[0]) ? 1 : 0;
+    }
+    if (token[parser->token_pos] == '\0') {
+        parser->token_pos = 0;
+        return true;
+    }
+    return false;
+}
+
+static void complete(http_parser_t *parser) {
+    parser->state = HTTP_PARSER_DONE;
+    if (parser->settings && parser->settings->on_complete) {
+        parser->settings->on_complete(parser);
+    }
+}
+
+static void headers_end(http_parser_t *parser) {
+    if (parser->status / 100 == 1) {
+        // 100 Continue e similares: a resposta de verdade vem em seguida
+        http_parser_reset(parser);
+    } else if (parser->status == 204 || parser->status == 304) {
+        complete(parser);
+    } else if (parser->chunked) {
+        parser->remaining = 0;
+        parser->state = HTTP_PARSER_CHUNK_SIZE;
+    } else if (parser->content_length >= 0) {
+        parser->remaining = (uint32_t)parser->content_length;
+        if (parser->remaining == 0) {
+            complete(parser);
+        } else {
+            parser->state = HTTP_PARSER_BODY_LENGTH;
+        }
+    } else {
+        parser->state = HTTP_PARSER_BODY_EOF;
+    }
+}
+
+static void chunk_size_end(http_parser_t *parser) {
+    parser->state = parser->remaining ? HTTP_PARSER_CHUNK_DATA : HTTP_PARSER_TRAILER_START;
+}
+
+static void parse_status_line(http_parser_t *parser, uint8_t c) {
+    if (c == '\n') {
+        if (parser->status < 100 || parser->status > 999) {
+            parser->state = HTTP_PARSER_ERROR;
+            return;
+        }
+        parser->state = HTTP_PARSER_HEADER_START;
+        if (parser->settings && parser->settings->on_status) {
+            parser->settings->on_status(parser, parser->status);
+        }
+        return;
+    }
+
+    switch (parser->status_field) {
+    case 0: // "HTTP/1.1"
+        if (c == ' ') {
+            parser->status_field = 1;
+        } else if (c >= '0' && c <= '9') {
+            parser->version_minor = c - '0';
+        }
+        break;
+    case 1: // "200"
+        if (c >= '0' && c <= '9') {
+            parser->status = parser->status * 10 + (c - '0');
+        } else if (c == ' ' || c == '\r') {
+            parser->status_field = 2;
+        } else {
+            parser->state = HTTP_PARSER_ERROR;
+        }
+        break;
+    default: // reason phrase, ignorada
+        break;
+    }
+}
+
+static void parse_header_name(http_parser_t *parser, uint8_t c) {
+    if (c == ':') {
+        parser->header_id = -1;
+        for (int i = 0; i < HEADER_COUNT; i++) {
+            if ((parser->header_candidates & (1u << i)) && header_lengths[i] == parser->header_pos) {
+                parser->header_id = i;
+                break;
+            }
+        }
+        parser->token_pos = 0;
+        parser->state = HTTP_PARSER_HEADER_VALUE;
+        return;
+    }
+    if (c == '\n') {
+        // Linha sem ':'; ignora
+        parser->state = HTTP_PARSER_HEADER_START;
+        return;
+    }
+
+    c = to_lower(c);
+    for (int i = 0; i < HEADER_COUNT; i++) {
+        if ((parser->header_candidates & (1u << i)) &&
+            (parser->header_pos >= header_lengths[i] || (uint8_t)header_names[i][parser->header_pos] != c)) {
+            parser->header_candidates &= ~(1u << i);
+        }
+    }
+    if (parser->header_pos < UINT8_MAX) {
+        parser->header_pos++;
+    }
+}
+
+static void parse_header_value(http_parser_t *parser, uint8_t c) {
+    if (c == '\n') {
+        parser->state = HTTP_PARSER_HEADER_START;
+        return;
+    }
+
+    switch (parser->header_id) {
+    case HEADER_CONTENT_LENGTH:
+        if (c >= '0' && c <= '9') {
+            if (parser->content_length < 0) {
+                parser->content_length = 0;
+            }
+            if (parser->content_length > (INT32_MAX - 9) / 10) {
+                parser->state = HTTP_PARSER_ERROR;
+                return;
+            }
+            parser->content_length = parser->content_length * 10 + (c - '0');
+        } else if (c != ' ' && c != '\t' && c != '\r') {
+            parser->state = HTTP_PARSER_ERROR;
+        }
+        break;
+    case HEADER_TRANSFER_ENCODING:
+        if (match_token(parser, "chunked", c)) {
+            parser->chunked = true;
+        }
+        break;
+    case HEADER_CONNECTION:
+        if (match_token(parser, "close", c)) {
+            parser->connection_close = true;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+static void parse_char(http_parser_t *parser, uint8_t c) {
+    switch (parser->state) {
+    case HTTP_PARSER_STATUS_LINE:
+        parse_status_line(parser, c);
+        break;
+
+    case HTTP_PARSER_HEADER_START:
+        if (c == '\r') {
+            break;
+        }
+        if (c == '\n') {
+            headers_end(parser);
+            break;
+        }
+        parser->header_candidates = ALL_HEADERS;
+        parser->header_pos = 0;
+        parser->state = HTTP_PARSER_HEADER_NAME;
+        parse_header_name(parser, c);
+        break;
+
+    case HTTP_PARSER_HEADER_NAME:
+        parse_header_name(parser, c);
+        break;
+
+    case HTTP_PARSER_HEADER_VALUE:
+        parse_header_value(parser, c);
+        break;
+
+    case HTTP_PARSER_CHUNK_SIZE: {
+        int v = hex_value(c);
+        if (v >= 0) {
+            if (parser->remaining > (UINT32_MAX >> 4)) {
+                parser->state = HTTP_PARSER_ERROR;
+                break;
+            }
+            parser->remaining = (parser->remaining << 4) | (uint32_t)v;
+        } else if (c == ';' || c == ' ') {
+            parser->state = HTTP_PARSER_CHUNK_EXT;
+        } else if (c == '\n') {
+            chunk_size_end(parser);
+        } else if (c != '\r') {
+            parser->state = HTTP_PARSER_ERROR;
+        }
+        break;
+    }
+
+    case HTTP_PARSER_CHUNK_EXT:
+        if (c == '\n') {
+            chunk_size_end(parser);
+        }
+        break;
+
+    case HTTP_PARSER_CHUNK_DATA_END:
+        if (c == '\n') {
+            parser->remaining = 0;
+            parser->state = HTTP_PARSER_CHUNK_SIZE;
+        } else if (c != '\r') {
+            parser->state = HTTP_PARSER_ERROR;
+        }
+        break;
+
+    case HTTP_PARSER_TRAILER_START:
+        if (c == '\n') {
+            complete(parser);
+        } else if (c != '\r') {
+            parser->state = HTTP_PARSER_TRAILER;
+        }
+        break;
+
+    case HTTP_PARSER_TRAILER:
+        if (c == '\n') {
+            parser->state = HTTP_PARSER_TRAILER_START;
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+void http_parser_init(http_parser_t *parser, const http_parser_settings_t *settings, void *arg) {
+    parser->settings = settings;
+    parser->arg = arg;
+    parser->bytes_parsed = 0;
+    http_parser_reset(parser);
+}
+
+void http_parser_reset(http_parser_t *parser) {
+    parser->state = HTTP_PARSER_STATUS_LINE;
+    parser->status = 0;
+    parser->content_length = -1;
+    parser->remaining = 0;
+    parser->status_field = 0;
+    parser->version_minor = 0;
+    parser->chunked = false;
+    parser->connection_close = false;
+    parser->header_candidates = 0;
+    parser->header_pos = 0;
+    parser->header_id = -1;
+    parser->token_pos = 0;
+}
+
+size_t http_parser_execute(http_parser_t *parser, const uint8_t *data, size_t len) {
+    size_t i = 0;
+
+    while (i < len) {
+        switch (parser->state) {
+        case HTTP_PARSER_DONE:
+        case HTTP_PARSER_ERROR:
+            goto out;
+
+        case HTTP_PARSER_BODY_LENGTH:
+        case HTTP_PARSER_CHUNK_DATA: {
+            // Corpo: entrega a fatia inteira de uma vez, sem copiar
+            size_t n = len - i;
+            if (n > parser->remaining) {
+                n = parser->remaining;
+            }
+            if (parser->settings && parser->settings->on_body) {
+                parser->settings->on_body(parser, data + i, n);
+            }
+            i += n;
+            parser->remaining -= n;
+            if (parser->remaining == 0) {
+                if (parser->state == HTTP_PARSER_BODY_LENGTH) {
+                    complete(parser);
+                } else {
+                    parser->state = HTTP_PARSER_CHUNK_DATA_END;
+                }
+            }
+            break;
+        }
+
+        case HTTP_PARSER_BODY_EOF:
+            if (parser->settings && parser->settings->on_body) {
+                parser->settings->on_body(parser, data + i, len - i);
+            }
+            i = len;
+            break;
+
+        default:
+            parse_char(parser, data[i++]);
+            break;
+        }
+    }
+
+out:
+    parser->bytes_parsed += i;
+    return i;
+}
+
+size_t http_parser_execute_pbuf(http_parser_t *parser, const struct pbuf *p, uint16_t offset) {
+    size_t total = 0;
+
+    while (p != NULL && offset >= p->len) {
+        offset -= p->len;
+        p = p->next;
+    }
+
+    for (; p != NULL; p = p->next) {
+        size_t n = p->len - offset;
+        size_t used = http_parser_execute(parser, (const uint8_t *)p->payload + offset, n);
+        total += used;
+        offset = 0;
+        if (used < n) {
+            break;
+        }
+    }
+    return total;
+}
+
+void http_parser_finish(http_parser_t *parser) {
+    if (parser->state == HTTP_PARSER_BODY_EOF) {
+        complete(parser);
+    } else if (parser->state != HTTP_PARSER_DONE) {
+        parser->state = HTTP_PARSER_ERROR;
+    }
+}
@@ -0,0 +1,96 @@
+#ifndef HTTP_PARSER_H
+#define HTTP_PARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "lwip/pbuf.h"
+
+// Parser incremental de respostas HTTP/1.1.
+//
+// Os bytes são consumidos à medida que chegam (um segmento TCP por vez), sem
+// copiar nada: o cabeçalho é interpretado caractere a caractere, então ele pode
+// chegar quebrado em qualquer ponto, e o corpo é entregue em fatias que
+// apontam direto para o payload recebido. Suporta Content-Length, chunked e
+// corpo delimitado pelo fechamento da conexão.
+
+typedef struct http_parser_ http_parser_t;
+
+typedef struct {
+    // Linha de status recebida (ex.: 200)
+    void (*on_status)(http_parser_t *parser, int status);
+    // Fatia do corpo, válida apenas durante a chamada
+    void (*on_body)(http_parser_t *parser, const uint8_t *data, size_t len);
+    // Resposta completa; o parser para de consumir bytes até ser reiniciado
+    void (*on_complete)(http_parser_t *parser);
+} http_parser_settings_t;
+
+typedef enum {
+    HTTP_PARSER_STATUS_LINE,
+    HTTP_PARSER_HEADER_START,
+    HTTP_PARSER_HEADER_NAME,
+    HTTP_PARSER_HEADER_VALUE,
+    HTTP_PARSER_BODY_LENGTH,
+    HTTP_PARSER_BODY_EOF,
+    HTTP_PARSER_CHUNK_SIZE,
+    HTTP_PARSER_CHUNK_EXT,
+    HTTP_PARSER_CHUNK_DATA,
+    HTTP_PARSER_CHUNK_DATA_END,
+    HTTP_PARSER_TRAILER_START,
+    HTTP_PARSER_TRAILER,
+    HTTP_PARSER_DONE,
+    HTTP_PARSER_ERROR,
+} http_parser_state_t;
+
+struct http_parser_ {
+    const http_parser_settings_t *settings;
+    void *arg; // livre para o usuário
+
+    http_parser_state_t state;
+    int status;
+    int32_t content_length; // -1 quando ausente
+    uint32_t remaining;     // bytes restantes do corpo ou do chunk atual
+    uint8_t status_field;   // campo atual da linha de status
+    uint8_t version_minor;
+    bool chunked;
+    bool connection_close;
+
+    // Casamento incremental dos nomes de cabeçalho conhecidos
+    uint8_t header_candidates;
+    uint8_t header_pos;
+    int8_t header_id;
+    uint8_t token_pos;
+
+    uint32_t bytes_parsed;
+};
+
+void http_parser_init(http_parser_t *parser, const http_parser_settings_t *settings, void *arg);
+
+// Prepara o parser para a próxima resposta na mesma conexão
+void http_parser_reset(http_parser_t *parser);
+
+// Consome até len bytes e retorna quantos foram usados. Para no fim da
+// resposta, então o que sobrar pertence à próxima.
+size_t http_parser_execute(http_parser_t *parser, const uint8_t *data, size_t len);
+
+// Percorre a cadeia de pbufs a partir de offset sem copiar o conteúdo
+size_t http_parser_execute_pbuf(http_parser_t *parser, const struct pbuf *p, uint16_t offset);
+
+// Avisa que a conexão foi fechada; finaliza respostas sem Content-Length
+void http_parser_finish(http_parser_t *parser);
+
+static inline bool http_parser_done(const http_parser_t *parser) {
+    return parser->state == HTTP_PARSER_DONE;
+}
+
+static inline bool http_parser_failed(const http_parser_t *parser) {
+    return parser->state == HTTP_PARSER_ERROR;
+}
+
+// Verdadeiro se o servidor permite reaproveitar a conexão
+static inline bool http_parser_keep_alive(const http_parser_t *parser) {
+    return parser->version_minor >= 1 && !parser->connection_close;
+}
+
+#endif
@@ -0,0 +1,95 @@
+#include <string.h>
+
+#include "http_template.h"
+
+void http_template_init(http_template_t *t) {
+    memset(t, 0, sizeof(*t));
+    t->body = -1;
+    t->content_length = -1;
+}
+
+static int add_segment(http_template_t *t, const void *data, uint16_t len, bool copy) {
+    if (t->count >= HTTP_TEMPLATE_MAX_SEGMENTS) {
+        return -1;
+    }
+    http_segment_t *segment = &t->segments[t->count];
+    segment->data = data;
+    segment->len = len;
+    segment->copy = copy;
+    return t->count++;
+}
+
+int http_template_static(http_template_t *t, const char *data, uint16_t len) {
+    return add_segment(t, data, len, false);
+}
+
+int http_template_field(http_template_t *t) {
+    if (t->field_count >= HTTP_TEMPLATE_MAX_FIELDS) {
+        return -1;
+    }
+    char *buf = t->fields[t->field_count];
+    int segment = add_segment(t, buf, 0, true);
+    if (segment >= 0) {
+        t->field_count++;
+        http_template_set_uint(t, segment, 0);
+    }
+    return segment;
+}
+
+int http_template_content_length(http_template_t *t) {
+    int segment = http_template_field(t);
+    t->content_length = (int8_t)segment;
+    return segment;
+}
+
+int http_template_buffer(http_template_t *t) {
+    return add_segment(t, NULL, 0, true);
+}
+
+void http_template_begin_body(http_template_t *t) {
+    t->body = (int8_t)t->count;
+}
+
+void http_template_set_uint(http_template_t *t, int segment, uint32_t value) {
+    if (segment < 0) {
+        return;
+    }
+    http_segment_t *s = &t->segments[segment];
+    s->len = (uint16_t)http_format_uint((char *)s->data, value);
+}
+
+void http_template_set_int(http_template_t *t, int segment, int32_t value) {
+    if (segment < 0) {
+        return;
+    }
+    http_segment_t *s = &t->segments[segment];
+    s->len = (uint16_t)http_format_int((char *)s->data, value);
+}
+
+void http_template_set_buffer(http_template_t *t, int segment, const void *data, uint16_t len) {
+    if (segment < 0) {
+        return;
+    }
+    t->segments[segment].data = data;
+    t->segments[segment].len = len;
+}
+
+uint32_t http_template_finish(http_template_t *t) {
+    uint32_t total = 0;
+    uint32_t body = 0;
+
+    for (int i = 0; i < t->count; i++) {
+        if (i == t->content_length) {
+            continue;
+        }
+        total += t->segments[i].len;
+        if (t->body >= 0 && i >= t->body) {
+            body += t->segments[i].len;
+        }
+    }
+    if (t->content_length >= 0) {
+        http_template_set_uint(t, t->content_length, body);
+        total += t->segments[t->content_length].len;
+    }
+    return total;
+}
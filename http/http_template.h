@@ -0,0 +1,82 @@
+#ifndef HTTP_TEMPLATE_H
+#define HTTP_TEMPLATE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "http_client.h"
+#include "http_format.h"
+
+// Requisição montada uma vez a partir de partes constantes e campos.
+//
+// As partes constantes são literais (o tamanho vem do sizeof, em tempo de
+// compilação) e vão para o lwIP por referência, sem cópia. Os campos
+// numéricos têm buffer próprio dentro do template e são reescritos no lugar
+// a cada envio com http_format_uint(); o Content-Length é recalculado em
+// http_template_finish() a partir do tamanho das partes do corpo.
+//
+//     http_template_literal(&t, "POST /x HTTP/1.1\r\nContent-Length: ");
+//     http_template_content_length(&t);
+//     http_template_literal(&t, "\r\n\r\n");
+//     http_template_begin_body(&t);
+//     http_template_literal(&t, "dado=");
+//     int dado = http_template_field(&t);
+//     ...
+//     http_template_set_uint(&t, dado, contador);
+//     http_template_finish(&t);
+//
+// O template precisa existir (e não mudar) até a requisição terminar, e não
+// pode ser copiado: os campos apontam para dentro dele.
+
+#ifndef HTTP_TEMPLATE_MAX_SEGMENTS
+#define HTTP_TEMPLATE_MAX_SEGMENTS 8
+#endif
+
+#ifndef HTTP_TEMPLATE_MAX_FIELDS
+#define HTTP_TEMPLATE_MAX_FIELDS 3
+#endif
+
+// "-2147483648" cabe
+#define HTTP_TEMPLATE_FIELD_SIZE 12
+
+typedef struct {
+    http_segment_t segments[HTTP_TEMPLATE_MAX_SEGMENTS];
+    char fields[HTTP_TEMPLATE_MAX_FIELDS][HTTP_TEMPLATE_FIELD_SIZE];
+    uint8_t count;
+    uint8_t field_count;
+    int8_t body;           // primeiro segmento do corpo, -1 sem corpo
+    int8_t content_length; // segmento do Content-Length, -1 se não tem
+} http_template_t;
+
+void http_template_init(http_template_t *t);
+
+// Parte constante; retorna o índice do segmento ou -1 se não couber
+int http_template_static(http_template_t *t, const char *data, uint16_t len);
+#define http_template_literal(t, s) http_template_static((t), (s), sizeof(s) - 1)
+
+// Campo numérico, preenchido com http_template_set_uint/int
+int http_template_field(http_template_t *t);
+
+// Campo preenchido com o tamanho do corpo em http_template_finish()
+int http_template_content_length(http_template_t *t);
+
+// Parte que aponta para um buffer do usuário (copiado no envio)
+int http_template_buffer(http_template_t *t);
+
+// Os segmentos adicionados a partir daqui formam o corpo
+void http_template_begin_body(http_template_t *t);
+
+void http_template_set_uint(http_template_t *t, int segment, uint32_t value);
+void http_template_set_int(http_template_t *t, int segment, int32_t value);
+void http_template_set_buffer(http_template_t *t, int segment, const void *data, uint16_t len);
+
+// Atualiza o Content-Length e retorna o tamanho total da requisição
+uint32_t http_template_finish(http_template_t *t);
+
+// Aponta a requisição para os segmentos do template
+static inline void http_template_request(const http_template_t *t, http_request_t *req) {
+    req->segments = t->segments;
+    req->segment_count = t->count;
+}
+
+#endif
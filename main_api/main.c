@@ -5,15 +5,21 @@
 #include "pico/stdlib.h"
 #include "pico/cyw43_arch.h"
 
-#include "lwip/pbuf.h"
-#include "lwip/tcp.h"
-#include "lwip/dns.h"
 #include "lwip/err.h"
-#include "lwip/netdb.h"
 
 #include "FreeRTOS.h"
 #include "task.h"
-#include "semphr.h"
+#if configUSE_TICKLESS_IDLE == 2
+#include "tickless.h"
+#endif
+#include "static_alloc.h"
+#ifdef FREERTOS_HEAP_TLSF
+#include "heap_tlsf.h"
+#endif
+
+#include "http_client.h"
+#include "http_template.h"
+#include "dns_cache.h"
 
 // Configurações de Wi-Fi e servidor
 #define WIFI_SSID "FERNANDES2"
@@ -21,18 +27,10 @@
 #define SERVER_DOMAIN "api.openweathermap.org"
 #define SERVER_PORT 80
 
-// Tamanho máximo do buffer de recepção
+// Tamanho máximo do corpo da resposta guardado
 #define RECV_BUFFER_SIZE 2048
 
-// Estrutura para manter o estado do cliente TCP
-typedef struct {
-    struct tcp_pcb *pcb;
-    ip_addr_t server_ip;
-    char recv_buffer[RECV_BUFFER_SIZE];
-    int recv_len;
-    SemaphoreHandle_t recv_sem;
-    SemaphoreHandle_t dns_sem; // Semáforo para DNS
-} tcp_client_t;
+static char recv_buffer[RECV_BUFFER_SIZE];
 
 // Função para inicializar a conexão Wi-Fi
 void wifi_init(void) {
@@ -53,192 +51,141 @@ void wifi_init(void) {
     printf("Conectado ao Wi-Fi\n");
 }
 
-// Callback para quando a resolução DNS for concluída
-static void my_dns_found_callback(const char *name, const ip_addr_t *ipaddr, void *callback_arg) {
-    tcp_client_t *client = (tcp_client_t *)callback_arg;
-    if (ipaddr == NULL) {
-        printf("Falha ao resolver o domínio: %s\n", name);
-    } else {
-        printf("Domínio %s resolvido para IP: %s\n", name, ipaddr_ntoa(ipaddr));
-        client->server_ip = *ipaddr;
-    }
-    xSemaphoreGive(client->dns_sem); // Libera o semáforo DNS
-}
-
-// Callback para quando a conexão TCP for estabelecida
-static err_t tcp_client_connected(void *arg, struct tcp_pcb *tpcb, err_t err) {
-    tcp_client_t *client = (tcp_client_t *)arg;
-    if (err != ERR_OK) {
-        printf("Falha na conexão TCP: %d\n", err);
-    } else {
-        printf("Conexão TCP estabelecida\n");
-    }
-    xSemaphoreGive(client->recv_sem); // Libera o semáforo em qualquer caso
-    return err;
-}
-
-// Callback para quando dados forem recebidos
-static err_t tcp_client_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err) {
-    tcp_client_t *client = (tcp_client_t *)arg;
-
-    if (!p) {
-        // Conexão fechada pelo servidor
-        printf("Conexão TCP fechada pelo servidor\n");
-        xSemaphoreGive(client->recv_sem); // Libera o semáforo ao finalizar recepção
-        return ERR_OK;
-    }
-
-    if (p->tot_len > 0) {
-        // Limita o tamanho dos dados recebidos ao tamanho do buffer
-        int len = (p->tot_len > RECV_BUFFER_SIZE - client->recv_len) ? RECV_BUFFER_SIZE - client->recv_len : p->tot_len;
-        pbuf_copy_partial(p, client->recv_buffer + client->recv_len, len, 0);
-        client->recv_len += len;
-        client->recv_buffer[client->recv_len] = '\0'; // Garante terminação da string
-
-        tcp_recved(tpcb, p->tot_len); // Informa ao TCP quanto de dados foram recebidos
+// Espaço livre do heap do FreeRTOS (fica em 0 com o heap_3, que não informa,
+// e com FREERTOS_STATIC, sem heap) e, com o heap TLSF, a fragmentação e os
+// blocos em uso por classe de tamanho
+static void print_heap_stats(void) {
+    HeapStats_t heap;
+    vPortGetHeapStats(&heap);
+    printf("HEAP: %zu bytes livres (minimo %zu), maior bloco %zu, %zu blocos livres\n",
+           heap.xAvailableHeapSpaceInBytes, heap.xMinimumEverFreeBytesRemaining, heap.xSizeOfLargestFreeBlockInBytes,
+           heap.xNumberOfFreeBlocks);
+
+#ifdef FREERTOS_HEAP_TLSF
+    HeapClassStats_t classes[HEAP_TLSF_CLASSES];
+    size_t count = xPortGetHeapClassStats(classes, HEAP_TLSF_CLASSES);
+    uint32_t fragmentation = ulPortGetHeapFragmentation();
+
+    printf("HEAP: fragmentacao %lu.%lu%%\n", fragmentation / 10, fragmentation % 10);
+    for (size_t i = 0; i < count; i++) {
+        if (classes[i].ulAllocations > 0) {
+            printf("HEAP: >= %zu bytes: %lu alocacoes, %lu em uso, maximo %lu\n", classes[i].xMinSize,
+                   classes[i].ulAllocations, classes[i].ulInUse, classes[i].ulHighWater);
+        }
     }
-
-    pbuf_free(p); // Libera o buffer
-
-    return ERR_OK;
+#endif
 }
 
-// Callback para erros na conexão TCP
-static void tcp_client_error(void *arg, err_t err) {
-    tcp_client_t *client = (tcp_client_t *)arg;
-    printf("Erro na conexão TCP: %d\n", err);
-    xSemaphoreGive(client->recv_sem); // Libera o semáforo em caso de erro
+#if configUSE_TICKLESS_IDLE == 2
+// Entre as requisições a tarefa fica em vTaskDelay e o core 0 dorme até o
+// alarme do timer (tickless idle). Latência: do alarme até a CPU voltar;
+// deriva: relógio do kernel menos o timer, que deve ficar perto de zero.
+static void print_tickless_stats(void) {
+    TicklessStats_t stats;
+    vPortGetTicklessStats(&stats);
+
+    uint32_t average = stats.ulAlarmWakeups ? (uint32_t)(stats.ullWakeLatencyTotalUs / stats.ulAlarmWakeups) : 0;
+    printf("Tickless: %lu sonos (%lu pelo alarme, %lu desistencias), %llu ms dormindo\n", stats.ulSleeps,
+           stats.ulAlarmWakeups, stats.ulAborted, stats.ullSleptUs / 1000);
+    printf("Tickless: latencia media %lu us, max %lu us | deriva %ld us, %lu ticks perdidos\n", average,
+           stats.ulWakeLatencyMaxUs, stats.lDriftUs, stats.ulLostTicks);
 }
+#endif
 
 // Função para enviar requisições HTTP
-void send_http_request(const char *request) {
-    tcp_client_t client;
-    memset(&client, 0, sizeof(tcp_client_t));
-    client.recv_sem = xSemaphoreCreateBinary();
-    client.dns_sem = xSemaphoreCreateBinary();
-
-    // Inicia a resolução DNS
-    err_t err = dns_gethostbyname(SERVER_DOMAIN, &client.server_ip, my_dns_found_callback, &client);
-    if (err == ERR_INPROGRESS) {
-        // A resolução está em andamento, aguarda o semáforo
-        if (xSemaphoreTake(client.dns_sem, pdMS_TO_TICKS(5000)) != pdTRUE) {
-            printf("Timeout na resolução DNS\n");
-            vSemaphoreDelete(client.recv_sem);
-            vSemaphoreDelete(client.dns_sem);
-            return;
-        }
-    } else if (err == ERR_OK) {
-        // O endereço IP já foi resolvido (está em cache)
-        printf("Domínio %s resolvido para IP: %s (cache)\n", SERVER_DOMAIN, ipaddr_ntoa(&client.server_ip));
-    } else {
-        printf("Erro na resolução DNS: %d\n", err);
-        vSemaphoreDelete(client.recv_sem);
-        vSemaphoreDelete(client.dns_sem);
-        return;
-    }
-
-    // Cria um novo PCB TCP
-    client.pcb = tcp_new();
-    if (!client.pcb) {
-        printf("Falha ao criar PCB TCP\n");
-        vSemaphoreDelete(client.recv_sem);
-        vSemaphoreDelete(client.dns_sem);
-        return;
-    }
-
-    // Conecta ao servidor
-    tcp_arg(client.pcb, &client);
-    tcp_err(client.pcb, tcp_client_error);
-    tcp_recv(client.pcb, tcp_client_recv);
-
-    err = tcp_connect(client.pcb, &client.server_ip, SERVER_PORT, tcp_client_connected);
-    if (err != ERR_OK) {
-        printf("Falha ao iniciar conexão TCP: %d\n", err);
-        tcp_abort(client.pcb);
-        vSemaphoreDelete(client.recv_sem);
-        vSemaphoreDelete(client.dns_sem);
-        return;
-    }
-
-    // Aguarda a conexão ser estabelecida ou ocorrer um erro
-    if (xSemaphoreTake(client.recv_sem, pdMS_TO_TICKS(5000)) != pdTRUE) {
-        printf("Timeout ao conectar ao servidor\n");
-        tcp_abort(client.pcb);
-        vSemaphoreDelete(client.recv_sem);
-        vSemaphoreDelete(client.dns_sem);
-        return;
-    }
-
-    // Envia a requisição HTTP
-    err = tcp_write(client.pcb, request, strlen(request), TCP_WRITE_FLAG_COPY);
-    if (err != ERR_OK) {
-        printf("Falha ao enviar dados: %d\n", err);
-        tcp_abort(client.pcb);
-        vSemaphoreDelete(client.recv_sem);
-        vSemaphoreDelete(client.dns_sem);
-        return;
-    }
-    tcp_output(client.pcb); // Garante que os dados sejam enviados
-
-    // Aguarda a resposta do servidor
-    if (xSemaphoreTake(client.recv_sem, pdMS_TO_TICKS(5000)) == pdTRUE) {
-        printf("Resposta do servidor:\n%s\n", client.recv_buffer);
-    } else {
+// A resolução DNS, a conexão e a leitura da resposta ficam com o http_client.
+// O nome do servidor fica no dns_cache pelo TTL da resposta DNS, então só a
+// primeira requisição (e as que vierem depois de uma falha) esperam o DNS.
+void send_http_request(const http_template_t *request) {
+    http_request_t req = {
+        .host = SERVER_DOMAIN,
+        .port = SERVER_PORT,
+        .body_buf = recv_buffer,
+        .body_size = sizeof(recv_buffer),
+    };
+    http_result_t result;
+
+    http_template_request(request, &req);
+
+    dns_cache_stats_t dns;
+
+    size_t heap_before = xPortGetHeapOperations();
+    err_t err = http_client_request_sync(&req, &result);
+    size_t heap_ops = xPortGetHeapOperations() - heap_before;
+
+    cyw43_arch_lwip_begin();
+    dns_cache_get_stats(&dns);
+    cyw43_arch_lwip_end();
+
+    // Fases: dns e conexão ficam em 0 quando a conexão foi reaproveitada
+    printf("Tempo: total %lu us | dns %lu us | conexao %lu us | transferencia %lu us\n", result.latency_us,
+           result.dns_us, result.connect_us, result.transfer_us);
+    printf("DNS cache: %lu acertos, %lu esperas, %lu renovacoes, %lu falhas\n", dns.hits, dns.misses,
+           dns.prefetches, dns.failures);
+    printf("HEAP: %zu operacoes na requisicao\n", heap_ops);
+
+    if (err == ERR_OK) {
+        printf("Resposta do servidor (%d):\n%s\n", result.status, recv_buffer);
+    } else if (err == ERR_TIMEOUT) {
         printf("Timeout ao receber resposta do servidor\n");
+    } else {
+        printf("Falha na requisição HTTP: %d\n", err);
     }
-
-    // Fecha a conexão TCP
-    tcp_close(client.pcb);
-    vSemaphoreDelete(client.recv_sem);
-    vSemaphoreDelete(client.dns_sem);
 }
 
 // Tarefa principal para enviar requisições HTTP
 void http_client_task(void *pvParameters) {
     int contador = 0;
 
+    // Templates montados uma vez, na partida da tarefa: os cabeçalhos são
+    // literais e vão para o lwIP sem cópia; a cada envio só o contador e o
+    // Content-Length são reescritos no lugar
+    static http_template_t post_request;
+    http_template_init(&post_request);
+    http_template_literal(&post_request, "POST /post_data HTTP/1.1\r\n"
+                                         "Host: " SERVER_DOMAIN "\r\n"
+                                         "Content-Type: application/x-www-form-urlencoded\r\n"
+                                         "Connection: close\r\n"
+                                         "Content-Length: ");
+    http_template_content_length(&post_request);
+    http_template_literal(&post_request, "\r\n\r\n");
+    http_template_begin_body(&post_request);
+    http_template_literal(&post_request, "dado=");
+    int dado = http_template_field(&post_request);
+
+    // Requisição HTTP GET
+    // "GET /get_counter HTTP/1.1\r\n"
+    // "Host: " SERVER_DOMAIN "\r\n"
+    // "Connection: close\r\n"
+    // "\r\n"
+    static http_template_t get_request;
+    http_template_init(&get_request);
+    http_template_literal(&get_request,
+                          "GET /data/2.5/weather?q=cotia&appid=ae10626011dbb050cfebc1ffa52f7829&units=metric HTTP/1.1\r\n"
+                          "Host: " SERVER_DOMAIN "\r\n"
+                          "Connection: close\r\n"
+                          "\r\n");
+    http_template_finish(&get_request);
+
     while (1) {
         // Requisição HTTP POST
-        char post_payload[128];
-        snprintf(post_payload, sizeof(post_payload), "dado=%d", contador);
-
-        char post_request[512];
-        snprintf(post_request, sizeof(post_request),
-                 "POST /post_data HTTP/1.1\r\n"
-                 "Host: %s\r\n"
-                 "Content-Type: application/x-www-form-urlencoded\r\n"
-                 "Content-Length: %d\r\n"
-                 "Connection: close\r\n"
-                 "\r\n"
-                 "%s",
-                 SERVER_DOMAIN, strlen(post_payload), post_payload);
+        http_template_set_int(&post_request, dado, contador);
+        http_template_finish(&post_request);
 
         printf("Enviando requisição HTTP POST...\n");
-        send_http_request(post_request);
+        send_http_request(&post_request);
         contador++;
 
         vTaskDelay(pdMS_TO_TICKS(2000));
 
-        // Requisição HTTP GET
-        // char get_request[256];
-        // snprintf(get_request, sizeof(get_request),
-        //          "GET /get_counter HTTP/1.1\r\n"
-        //          "Host: %s\r\n"
-        //          "Connection: close\r\n"
-        //          "\r\n",
-        //          SERVER_DOMAIN);
-        char get_request[512];
-        snprintf(get_request, sizeof(get_request),
-                "GET /data/2.5/weather?q=cotia&appid=ae10626011dbb050cfebc1ffa52f7829&units=metric HTTP/1.1\r\n"
-                "Host: %s\r\n"
-                "Connection: close\r\n"
-                "\r\n",
-                SERVER_DOMAIN);
-
         printf("Enviando requisição HTTP GET...\n");
-        send_http_request(get_request);
+        send_http_request(&get_request);
 
         vTaskDelay(pdMS_TO_TICKS(5000));
+#if configUSE_TICKLESS_IDLE == 2
+        print_tickless_stats();
+#endif
+        print_heap_stats();
     }
 }
 
@@ -246,7 +193,7 @@ int main() {
     wifi_init();
 
     // Cria a tarefa para enviar requisições HTTP
-    xTaskCreate(http_client_task, "HTTP Client Task", 4096, NULL, 1, NULL);
+    TASK_CREATE(http_client_task, "HTTP Client Task", 4096, NULL, 1, NULL);
 
     // Inicia o agendador do FreeRTOS
     vTaskStartScheduler();
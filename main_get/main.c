@@ -5,279 +5,195 @@
 #include "pico/cyw43_arch.h"
 
 #include <task.h>
-#include <semphr.h>
-#include <queue.h>
+#include "static_alloc.h"
 #include "hardware/gpio.h"
 #include "hardware/adc.h"
 
-#include "lwip/pbuf.h"
 #include "lwip/tcp.h"
 
+#include "http_client.h"
+
 #define WIFI_SSID "corsi"
 #define WIFI_PASSWORD "1223334444"
 #define SERVER_IP "192.168.161.227"
 
 #define TCP_PORT 5000
-#define DEBUG_printf printf
-#define BUF_SIZE 2048
-
-#define TEST_ITERATIONS 10
-#define POLL_TIME_S 5
-
-QueueHandle_t xQueueTcpRecData;
 
-#if 0
-static void dump_bytes(const uint8_t *bptr, uint32_t len) {
-    unsigned int i = 0;
-
-    printf("dump_bytes %d", len);
-    for (i = 0; i < len;) {
-        if ((i & 0x0f) == 0) {
-            printf("\n");
-        } else if ((i & 0x07) == 0) {
-            printf(" ");
-        }
-        printf("%02x ", bptr[i++]);
-    }
-    printf("\n");
-}
-#define DUMP_BYTES dump_bytes
+// 1: mantém uma única conexão TCP aberta entre as requisições (HTTP/1.1 keep-alive)
+//    e só reconecta quando o servidor fecha ou ocorre um erro.
+// 0: abre e fecha uma conexão por requisição (handshake + slow start a cada GET).
+#define HTTP_KEEP_ALIVE 1
+
+// Requisições disparadas de uma vez a cada ciclo. Com keep-alive elas saem
+// em pipeline pela mesma conexão (até HTTP_CLIENT_PIPELINE_DEPTH, definido
+// no CMakeLists.txt), sem esperar cada resposta. 1: uma por vez.
+#define GET_BURST 8
+
+// Com GET_BURST 1: 1 lê o corpo direto dos pbufs recebidos (body_refs), sem
+// cópia, depois da conclusão; 0 copia para um buffer no contexto do lwIP.
+#define GET_BODY_BY_REFERENCE 1
+
+static const char request[] = "GET /get_data?dado HTTP/1.1\r\n"
+                              "Host: " SERVER_IP "\r\n"
+                              "Accept: */*\r\n"
+#if HTTP_KEEP_ALIVE
+                              "Connection: keep-alive\r\n"
 #else
-#define DUMP_BYTES(A, B)
+                              "Connection: close\r\n"
 #endif
+                              "\r\n";
 
-typedef struct TCP_CLIENT_T_ {
-    struct tcp_pcb *tcp_pcb;
-    ip_addr_t remote_addr;
-    uint8_t buffer[BUF_SIZE];
-    int buffer_len;
-    int sent_len;
-    bool complete;
-    int run_count;
-    bool connected;
-} TCP_CLIENT_T;
-
-static err_t tcp_client_close(void *arg) {
-    TCP_CLIENT_T *state = (TCP_CLIENT_T *)arg;
-    err_t err = ERR_OK;
-    if (state->tcp_pcb != NULL) {
-        tcp_arg(state->tcp_pcb, NULL);
-        tcp_poll(state->tcp_pcb, NULL, 0);
-        tcp_sent(state->tcp_pcb, NULL);
-        tcp_recv(state->tcp_pcb, NULL);
-        tcp_err(state->tcp_pcb, NULL);
-        err = tcp_close(state->tcp_pcb);
-        if (err != ERR_OK) {
-            DEBUG_printf("close failed %d, calling abort\n", err);
-            tcp_abort(state->tcp_pcb);
-            err = ERR_ABRT;
-        }
-        state->tcp_pcb = NULL;
-    }
-    return err;
-}
-
-// Called with results of operation
-static err_t tcp_result(void *arg, int status) {
-    TCP_CLIENT_T *state = (TCP_CLIENT_T *)arg;
-    if (status == 0) {
-        DEBUG_printf("test success\n");
-    } else {
-        DEBUG_printf("test failed %d\n", status);
-    }
-    state->complete = true;
-    return tcp_client_close(arg);
-}
-
-static err_t tcp_client_sent(void *arg, struct tcp_pcb *tpcb, u16_t len) {
-    TCP_CLIENT_T *state = (TCP_CLIENT_T *)arg;
-    DEBUG_printf("tcp_client_sent %u\n", len);
-    state->sent_len += len;
+// A requisição é constante: vai para o lwIP por referência, sem cópia
+static const http_segment_t request_segment = {request, sizeof(request) - 1, false};
 
-    if (state->sent_len >= BUF_SIZE) {
+#if GET_BURST > 1
+void wifi_task(void *p) {
+    static char bodies[GET_BURST][64];
+    static http_result_t results[GET_BURST];
+    int handles[GET_BURST];
+    http_client_stats_t before, after;
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
 
-        state->run_count++;
-        if (state->run_count >= TEST_ITERATIONS) {
-            tcp_result(arg, 0);
-            return ERR_OK;
+    while (1) {
+        int started = 0;
+
+        memset(results, 0, sizeof(results));
+        ulTaskNotifyValueClearIndexed(NULL, HTTP_CLIENT_NOTIFY_INDEX, UINT32_MAX);
+        http_client_get_stats(&before);
+        size_t heap_before = xPortGetHeapOperations();
+        uint64_t t0 = time_us_64();
+        for (int i = 0; i < GET_BURST; i++) {
+            http_request_t req = {
+                .host = SERVER_IP,
+                .port = TCP_PORT,
+                .segments = &request_segment,
+                .segment_count = 1,
+                .keep_alive = HTTP_KEEP_ALIVE,
+                .body_buf = bodies[i],
+                .body_size = sizeof(bodies[i]),
+                .notify_task = self,
+                .result = &results[i],
+            };
+            handles[i] = http_client_request(&req);
+            if (handles[i] >= 0) {
+                started++;
+            }
         }
 
-        // We should receive a new buffer from the server
-        state->buffer_len = 0;
-        state->sent_len = 0;
-        DEBUG_printf("Waiting for buffer from server\n");
-    }
-
-    return ERR_OK;
-}
-
-static err_t tcp_client_connected(void *arg, struct tcp_pcb *tpcb, err_t err) {
-    TCP_CLIENT_T *state = (TCP_CLIENT_T *)arg;
-    if (err != ERR_OK) {
-        printf("connect failed %d\n", err);
-        return tcp_result(arg, err);
-    }
-    state->connected = true;
-    DEBUG_printf("Waiting for buffer from server\n");
-    return ERR_OK;
-}
-
-static err_t tcp_client_poll(void *arg, struct tcp_pcb *tpcb) {
-    DEBUG_printf("tcp_client_poll\n");
-    return tcp_result(arg, -1); // no response is an error?
-}
-
-static void tcp_client_err(void *arg, err_t err) {
-    if (err != ERR_ABRT) {
-        DEBUG_printf("tcp_client_err %d\n", err);
-        tcp_result(arg, err);
-    }
-}
-
-err_t tcp_client_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err) {
-    TCP_CLIENT_T *state = (TCP_CLIENT_T *)arg;
-    if (!p) {
-        return tcp_result(arg, -1);
-    }
-    // this method is callback from lwIP, so cyw43_arch_lwip_begin is not required, however you
-    // can use this method to cause an assertion in debug mode, if this method is called when
-    // cyw43_arch_lwip_begin IS needed
-    cyw43_arch_lwip_check();
-    if (p->tot_len > 0) {
-        for (struct pbuf *q = p; q != NULL; q = q->next) {
-            DUMP_BYTES(q->payload, q->len);
+        // Cada conclusão dá uma notificação
+        int done = 0;
+        while (done < started &&
+               ulTaskNotifyTakeIndexed(HTTP_CLIENT_NOTIFY_INDEX, pdFALSE, pdMS_TO_TICKS(HTTP_CLIENT_TIMEOUT_MS * 2))) {
+            done++;
+        }
+        uint64_t elapsed = time_us_64() - t0;
+        http_client_get_stats(&after);
+
+        // Latência de cada requisição (do envio até a resposta completa),
+        // como no modo de uma por vez
+        int ok = 0, reused = 0;
+        uint32_t latency_min = UINT32_MAX, latency_max = 0;
+        uint64_t latency_total = 0;
+        for (int i = 0; i < GET_BURST; i++) {
+            if (results[i].err == ERR_OK && results[i].status == 200) {
+                ok++;
+                reused += results[i].reused;
+                latency_total += results[i].latency_us;
+                latency_min = results[i].latency_us < latency_min ? results[i].latency_us : latency_min;
+                latency_max = results[i].latency_us > latency_max ? results[i].latency_us : latency_max;
+            }
+        }
+        if (ok > 0) {
+            printf("HTTP: Dado recebido:\n");
+            printf("%s\n", bodies[0]);
+        }
+        printf("HTTP: %d/%d respostas 200 em %lu us (%lu req/s)\n", ok, GET_BURST, (uint32_t)elapsed,
+               elapsed ? (uint32_t)(ok * 1000000ull / elapsed) : 0);
+        if (ok > 0) {
+            printf("HTTP: latencia media %lu us, min %lu us, max %lu us (%d de %d sem handshake)\n",
+                   (uint32_t)(latency_total / ok), latency_min, latency_max, reused, ok);
+        }
+        printf("HTTP: %lu em pipeline, %lu handshakes, %lu reenvios\n", after.pipelined - before.pipelined,
+               after.connections - before.connections, after.retries - before.retries);
+        printf("HTTP: %lu bytes copiados nesta rajada\n", after.bytes_copied - before.bytes_copied);
+        printf("HEAP: %zu operacoes nesta rajada\n", xPortGetHeapOperations() - heap_before);
+        if (done < started) {
+            for (int i = 0; i < GET_BURST; i++) {
+                http_client_cancel(handles[i]);
+            }
+            printf("SOCKET: Falha na requisicao (timeout)\n");
+            printf("SOCKET: Verifique IP, porta e rede wifi\n");
         }
-        // Receive the buffer
-        const uint16_t buffer_left = BUF_SIZE - state->buffer_len;
-        state->buffer_len += pbuf_copy_partial(p, state->buffer + state->buffer_len,
-                                               p->tot_len > buffer_left ? buffer_left : p->tot_len, 0);
-        tcp_recved(tpcb, p->tot_len);
-    }
-
-    xQueueSendFromISR(xQueueTcpRecData, p->payload, 0);
-
-    pbuf_free(p);
-
-    return ERR_OK;
-}
-
-static bool tcp_client_open(void *arg) {
-    TCP_CLIENT_T *state = (TCP_CLIENT_T *)arg;
-    DEBUG_printf("Connecting to %s port %u\n", ip4addr_ntoa(&state->remote_addr), TCP_PORT);
-    state->tcp_pcb = tcp_new_ip_type(IP_GET_TYPE(&state->remote_addr));
-    if (!state->tcp_pcb) {
-        DEBUG_printf("failed to create pcb\n");
-        return false;
-    }
-
-    tcp_arg(state->tcp_pcb, state);
-    tcp_poll(state->tcp_pcb, tcp_client_poll, POLL_TIME_S * 2);
-    tcp_sent(state->tcp_pcb, tcp_client_sent);
-    tcp_recv(state->tcp_pcb, tcp_client_recv);
-    tcp_err(state->tcp_pcb, tcp_client_err);
-
-    state->buffer_len = 0;
-
-    // cyw43_arch_lwip_begin/end should be used around calls into lwIP to ensure correct locking.
-    // You can omit them if you are in a callback from lwIP. Note that when using pico_cyw_arch_poll
-    // these calls are a no-op and can be omitted, but it is a good practice to use them in
-    // case you switch the cyw43_arch type later.
-    cyw43_arch_lwip_begin();
-    err_t err = tcp_connect(state->tcp_pcb, &state->remote_addr, TCP_PORT, tcp_client_connected);
-    cyw43_arch_lwip_end();
-
-    return err == ERR_OK;
-}
-
-// Perform initialisation
-static TCP_CLIENT_T *tcp_client_init(void) {
-    TCP_CLIENT_T *state = calloc(1, sizeof(TCP_CLIENT_T));
-    if (!state) {
-        DEBUG_printf("failed to allocate state\n");
-        return NULL;
-    }
-    ip4addr_aton(SERVER_IP, &state->remote_addr);
-    return state;
-}
-
-int verify_ack(const char *response) {
-    // Expected status line for a successful response
-    const char *expected_status = "HTTP/1.1 200 OK";
-
-    // Check if the response starts with the expected status line
-    if (strncmp(response, expected_status, strlen(expected_status)) == 0) {
-        return 1; // ACK is correct
-    } else {
-        return 0; // ACK is incorrect
-    }
-}
-
-int extract_content_length(const char *response) {
-    const char *content_length_str = "Content-Length: ";
-    char *content_length_pos = strstr(response, content_length_str);
 
-    if (content_length_pos) {
-        content_length_pos += strlen(content_length_str); // Move pointer to the start of the content length value
-        return atoi(content_length_pos);                  // Convert content length value to integer
-    } else {
-        printf("Content-Length not found in response.\n");
-        return -1; // Return -1 if Content-Length header is not found
+        vTaskDelay(pdMS_TO_TICKS(500));
     }
 }
-
+#else
 void wifi_task(void *p) {
+    // A resposta é interpretada direto dos pbufs; o corpo fica neles
+    // (body_refs) ou é copiado aqui
+#if GET_BODY_BY_REFERENCE
+    http_body_ref_t body_refs[4];
+#else
+    char body[64];
+#endif
+    http_client_stats_t before, after;
 
     while (1) {
-        char request_new[255];
-        snprintf(request_new, sizeof(request_new),
-                 "GET /get_data?dado HTTP/1.1\r\n"
-                 "Host: 0.0.0.0\r\n" // Replace with the actual server IP
-                 "Accept: */*\r\n"
-                 "\r\n");
-        TCP_CLIENT_T *state = tcp_client_init();
-
-        if (state && tcp_client_open(state)) {
-            printf("SOCKET: Conectado ao servidor\n");
-            cyw43_arch_lwip_begin();
-            int err = tcp_write(state->tcp_pcb, request_new, strlen(request_new), 0);
-            cyw43_arch_lwip_end();
-
-            if (err != ERR_OK) {
-                printf("TCP: Falha ao enviar dados\n");
-                printf("TCP: Servidor está rodando? Porta e IP corretos?\n");
-                printf("\nerrno: %d \n", err);
-            } else {
-                printf("TCP: Dados enviados com sucesso\n");
-            }
-
-            char tcpRecData[1024];
-            int content_length;
-            // ACK
-            if (xQueueReceive(xQueueTcpRecData, tcpRecData, 1000)) {
-                if (verify_ack(tcpRecData)) {
-                    content_length = extract_content_length(tcpRecData);
-                    printf("HTTP: ack 200 from server\n");
-                    if (xQueueReceive(xQueueTcpRecData, tcpRecData, 1000)) {
-                        tcpRecData[content_length] = 0;
-                        printf("HTTP: Dado recebido:\n");
-                        printf("%s\n", tcpRecData);
-                    }
-                } else {
-                    printf("HTTP: ack error from server \n");
-                    printf(tcpRecData);
+        http_request_t req = {
+            .host = SERVER_IP,
+            .port = TCP_PORT,
+            .segments = &request_segment,
+            .segment_count = 1,
+            .keep_alive = HTTP_KEEP_ALIVE,
+#if GET_BODY_BY_REFERENCE
+            .body_refs = body_refs,
+            .body_ref_count = 4,
+#else
+            .body_buf = body,
+            .body_size = sizeof(body),
+#endif
+        };
+        http_result_t result;
+
+        http_client_get_stats(&before);
+        size_t heap_before = xPortGetHeapOperations();
+        err_t err = http_client_request_sync(&req, &result);
+        size_t heap_ops = xPortGetHeapOperations() - heap_before;
+        http_client_get_stats(&after);
+
+        if (err == ERR_OK) {
+            if (result.status == 200) {
+                printf("HTTP: ack 200 from server\n");
+                printf("HTTP: Dado recebido:\n");
+#if GET_BODY_BY_REFERENCE
+                for (int i = 0; i < result.body_refs; i++) {
+                    fwrite(body_refs[i].data, 1, body_refs[i].len, stdout);
                 }
+                printf("\n");
+#else
+                printf("%s\n", body);
+#endif
+            } else {
+                printf("HTTP: ack error from server %d\n", result.status);
             }
-
-            tcp_client_close(state);
-            free(state);
-
-            vTaskDelay(pdMS_TO_TICKS(500));
+            printf("HTTP: latencia %lu us (%s)\n", result.latency_us,
+                   result.reused ? "somente requisicao" : "handshake + requisicao");
+            printf("HTTP: %lu bytes copiados, %lu por referencia nesta requisicao\n",
+                   after.bytes_copied - before.bytes_copied, after.bytes_referenced - before.bytes_referenced);
+            printf("HEAP: %zu operacoes nesta requisicao\n", heap_ops);
         } else {
-            printf("SOCKET: Falha ao conectar ao servidor\n");
+            printf("SOCKET: Falha na requisicao (%d)\n", err);
             printf("SOCKET: Verifique IP, porta e rede wifi\n");
         }
+#if GET_BODY_BY_REFERENCE
+        http_client_body_release(body_refs, result.body_refs);
+#endif
+
+        vTaskDelay(pdMS_TO_TICKS(500));
     }
 }
+#endif
 
 int main() {
     char sIP[] = "xxx.xxx.xxx.xxx";
@@ -310,8 +226,7 @@ int main() {
     strcpy(sIP, ip4addr_ntoa(netif_ip4_addr(netif_list)));
     printf("Conectado, IP %s\n", sIP);
 
-    xQueueTcpRecData = xQueueCreate(2, 1024);
-    xTaskCreate(wifi_task, "wifi task", 4095, NULL, 1, NULL);
+    TASK_CREATE(wifi_task, "wifi task", 4095, NULL, 1, NULL);
 
     vTaskStartScheduler();
 
@@ -5,204 +5,134 @@
 #include "pico/cyw43_arch.h"
 
 #include <task.h>
-#include <semphr.h>
-#include <queue.h>
+#include "static_alloc.h"
 #include "hardware/gpio.h"
 #include "hardware/adc.h"
 
-#include "lwip/pbuf.h"
 #include "lwip/tcp.h"
 
+#include "http_client.h"
+#include "http_template.h"
+
 #define WIFI_SSID "SUA REDE"
 #define WIFI_PASSWORD "SUA SENHA"
 #define SERVER_IP "SEU.IP"
 
 #define TCP_PORT 5000
-#define DEBUG_printf printf
-#define BUF_SIZE 2048
-
-#define TEST_ITERATIONS 10
-#define POLL_TIME_S 5
-
-#if 0
-static void dump_bytes(const uint8_t *bptr, uint32_t len) {
-    unsigned int i = 0;
-
-    printf("dump_bytes %d", len);
-    for (i = 0; i < len;) {
-        if ((i & 0x0f) == 0) {
-            printf("\n");
-        } else if ((i & 0x07) == 0) {
-            printf(" ");
-        }
-        printf("%02x ", bptr[i++]);
-    }
-    printf("\n");
-}
-#define DUMP_BYTES dump_bytes
-#else
-#define DUMP_BYTES(A, B)
-#endif
 
-typedef struct TCP_CLIENT_T_ {
-    struct tcp_pcb *tcp_pcb;
-    ip_addr_t remote_addr;
-    uint8_t buffer[BUF_SIZE];
-    int buffer_len;
-    int sent_len;
-    bool complete;
-    int run_count;
-    bool connected;
-} TCP_CLIENT_T;
-
-static err_t tcp_client_close(void *arg) {
-    TCP_CLIENT_T *state = (TCP_CLIENT_T *)arg;
-    err_t err = ERR_OK;
-    if (state->tcp_pcb != NULL) {
-        tcp_arg(state->tcp_pcb, NULL);
-        tcp_poll(state->tcp_pcb, NULL, 0);
-        tcp_sent(state->tcp_pcb, NULL);
-        tcp_recv(state->tcp_pcb, NULL);
-        tcp_err(state->tcp_pcb, NULL);
-        err = tcp_close(state->tcp_pcb);
-        if (err != ERR_OK) {
-            DEBUG_printf("close failed %d, calling abort\n", err);
-            tcp_abort(state->tcp_pcb);
-            err = ERR_ABRT;
-        }
-        state->tcp_pcb = NULL;
+// 1: acumula as amostras num buffer circular e envia várias num único POST
+//    (/post_batch) quando junta BATCH_FLUSH_COUNT ou a mais antiga passa de
+//    BATCH_MAX_AGE_MS.
+// 0: um POST /post_data com um único dado por conexão.
+#define POST_BATCH 1
+#define SAMPLE_PERIOD_MS 500
+#define SAMPLE_RING_SIZE 32
+#define BATCH_FLUSH_COUNT 20
+#define BATCH_MAX_AGE_MS 10000
+
+// Até 11 caracteres e uma vírgula por amostra
+#define PAYLOAD_SIZE (SAMPLE_RING_SIZE * 12)
+
+// Estimativa do que vai para o ar além do HTTP em cada conexão: handshake (3),
+// ACK dos dados (1) e fechamento (4), cada segmento com cabeçalhos
+// IP (20) + TCP (20) + 802.11/LLC (34)
+#define SEGMENT_OVERHEAD (20 + 20 + 34)
+#define CONNECTION_SEGMENTS 8
+
+typedef struct {
+    int value;
+    TickType_t tick;
+} SAMPLE_T;
+
+// Buffer circular de amostras; quando enche, a mais antiga é descartada
+typedef struct {
+    SAMPLE_T samples[SAMPLE_RING_SIZE];
+    int head; // mais antiga
+    int count;
+    int dropped;
+} SAMPLE_RING_T;
+
+static void sample_ring_push(SAMPLE_RING_T *ring, int value, TickType_t tick) {
+    if (ring->count == SAMPLE_RING_SIZE) {
+        ring->head = (ring->head + 1) % SAMPLE_RING_SIZE;
+        ring->count--;
+        ring->dropped++;
     }
-    return err;
+    SAMPLE_T *sample = &ring->samples[(ring->head + ring->count) % SAMPLE_RING_SIZE];
+    sample->value = value;
+    sample->tick = tick;
+    ring->count++;
 }
 
-// Called with results of operation
-static err_t tcp_result(void *arg, int status) {
-    TCP_CLIENT_T *state = (TCP_CLIENT_T *)arg;
-    if (status == 0) {
-        DEBUG_printf("test success\n");
-    } else {
-        DEBUG_printf("test failed %d\n", status);
-    }
-    state->complete = true;
-    return tcp_client_close(arg);
+static void sample_ring_pop(SAMPLE_RING_T *ring, int n) {
+    ring->head = (ring->head + n) % SAMPLE_RING_SIZE;
+    ring->count -= n;
 }
 
-static err_t tcp_client_sent(void *arg, struct tcp_pcb *tpcb, u16_t len) {
-    TCP_CLIENT_T *state = (TCP_CLIENT_T *)arg;
-    DEBUG_printf("tcp_client_sent %u\n", len);
-    state->sent_len += len;
-
-    if (state->sent_len >= BUF_SIZE) {
-
-        state->run_count++;
-        if (state->run_count >= TEST_ITERATIONS) {
-            tcp_result(arg, 0);
-            return ERR_OK;
-        }
-
-        // We should receive a new buffer from the server
-        state->buffer_len = 0;
-        state->sent_len = 0;
-        DEBUG_printf("Waiting for buffer from server\n");
+static bool sample_ring_should_flush(const SAMPLE_RING_T *ring, TickType_t now) {
+    if (ring->count == 0) {
+        return false;
     }
-
-    return ERR_OK;
+    return ring->count >= BATCH_FLUSH_COUNT ||
+           now - ring->samples[ring->head].tick >= pdMS_TO_TICKS(BATCH_MAX_AGE_MS);
 }
 
-static err_t tcp_client_connected(void *arg, struct tcp_pcb *tpcb, err_t err) {
-    TCP_CLIENT_T *state = (TCP_CLIENT_T *)arg;
-    if (err != ERR_OK) {
-        printf("connect failed %d\n", err);
-        return tcp_result(arg, err);
+// Monta "v1,v2,..." (sem '\0'), na ordem de chegada. Retorna o tamanho e em
+// *n quantas amostras couberam
+static int sample_ring_format(const SAMPLE_RING_T *ring, char *buf, int size, int *n) {
+    int len = 0;
+    *n = 0;
+    for (int i = 0; i < ring->count; i++) {
+        const SAMPLE_T *sample = &ring->samples[(ring->head + i) % SAMPLE_RING_SIZE];
+        if (len + 12 > size) {
+            break;
+        }
+        if (i) {
+            buf[len++] = ',';
+        }
+        len += http_format_int(buf + len, sample->value);
+        (*n)++;
     }
-    state->connected = true;
-    DEBUG_printf("Waiting for buffer from server\n");
-    return ERR_OK;
+    return len;
 }
 
-static err_t tcp_client_poll(void *arg, struct tcp_pcb *tpcb) {
-    DEBUG_printf("tcp_client_poll\n");
-    return tcp_result(arg, -1); // no response is an error?
+static void print_bytes_on_air(int request_length, int n) {
+    int segments = CONNECTION_SEGMENTS + (request_length + TCP_MSS - 1) / TCP_MSS;
+    int total = request_length + segments * SEGMENT_OVERHEAD;
+    printf("POST: %d amostra(s), %d bytes no ar (%d bytes/amostra)\n", n, total, total / n);
 }
 
-static void tcp_client_err(void *arg, err_t err) {
-    if (err != ERR_ABRT) {
-        DEBUG_printf("tcp_client_err %d\n", err);
-        tcp_result(arg, err);
-    }
-}
-
-err_t tcp_client_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err) {
-    TCP_CLIENT_T *state = (TCP_CLIENT_T *)arg;
-    if (!p) {
-        return tcp_result(arg, -1);
-    }
-    // this method is callback from lwIP, so cyw43_arch_lwip_begin is not required, however you
-    // can use this method to cause an assertion in debug mode, if this method is called when
-    // cyw43_arch_lwip_begin IS needed
-    cyw43_arch_lwip_check();
-    if (p->tot_len > 0) {
-        DEBUG_printf("recv %d err %d\n", p->tot_len, err);
-        for (struct pbuf *q = p; q != NULL; q = q->next) {
-            DUMP_BYTES(q->payload, q->len);
-        }
-        // Receive the buffer
-        const uint16_t buffer_left = BUF_SIZE - state->buffer_len;
-        state->buffer_len += pbuf_copy_partial(p, state->buffer + state->buffer_len,
-                                               p->tot_len > buffer_left ? buffer_left : p->tot_len, 0);
-        tcp_recved(tpcb, p->tot_len);
-    }
-    pbuf_free(p);
-
-    // If we have received the whole buffer, send it back to the server
-    if (state->buffer_len == BUF_SIZE) {
-        DEBUG_printf("Writing %d bytes to server\n", state->buffer_len);
-        err_t error = tcp_write(tpcb, state->buffer, state->buffer_len, TCP_WRITE_FLAG_COPY);
-        if (error != ERR_OK) {
-            DEBUG_printf("Failed to write data %d\n", err);
-            return tcp_result(arg, -1);
-        }
+// Envia a requisição numa conexão nova e espera a resposta do servidor
+static bool send_request(const http_template_t *request) {
+    http_request_t req = {
+        .host = SERVER_IP,
+        .port = TCP_PORT,
+    };
+    http_result_t result;
+    http_client_stats_t before, after;
+
+    http_template_request(request, &req);
+
+    http_client_get_stats(&before);
+    size_t heap_before = xPortGetHeapOperations();
+    err_t err = http_client_request_sync(&req, &result);
+    printf("HEAP: %zu operacoes na requisicao\n", xPortGetHeapOperations() - heap_before);
+    http_client_get_stats(&after);
+    printf("TCP: %lu bytes enviados por referencia, %lu copiados\n",
+           after.tx_bytes_referenced - before.tx_bytes_referenced, after.tx_bytes_copied - before.tx_bytes_copied);
+    if (err != ERR_OK) {
+        printf("TCP: Falha ao enviar dados\n");
+        printf("TCP: Servidor está rodando? Porta e IP corretos?\n");
+        printf("\nerrno: %d \n", err);
+        return false;
     }
-    return ERR_OK;
-}
-
-static bool tcp_client_open(void *arg) {
-    TCP_CLIENT_T *state = (TCP_CLIENT_T *)arg;
-    DEBUG_printf("Connecting to %s port %u\n", ip4addr_ntoa(&state->remote_addr), TCP_PORT);
-    state->tcp_pcb = tcp_new_ip_type(IP_GET_TYPE(&state->remote_addr));
-    if (!state->tcp_pcb) {
-        DEBUG_printf("failed to create pcb\n");
+    if (result.status != 200) {
+        printf("HTTP: resposta %d do servidor\n", result.status);
         return false;
     }
 
-    tcp_arg(state->tcp_pcb, state);
-    tcp_poll(state->tcp_pcb, tcp_client_poll, POLL_TIME_S * 2);
-    tcp_sent(state->tcp_pcb, tcp_client_sent);
-    tcp_recv(state->tcp_pcb, tcp_client_recv);
-    tcp_err(state->tcp_pcb, tcp_client_err);
-
-    state->buffer_len = 0;
-
-    // cyw43_arch_lwip_begin/end should be used around calls into lwIP to ensure correct locking.
-    // You can omit them if you are in a callback from lwIP. Note that when using pico_cyw_arch_poll
-    // these calls are a no-op and can be omitted, but it is a good practice to use them in
-    // case you switch the cyw43_arch type later.
-    cyw43_arch_lwip_begin();
-    err_t err = tcp_connect(state->tcp_pcb, &state->remote_addr, TCP_PORT, tcp_client_connected);
-    cyw43_arch_lwip_end();
-
-    return err == ERR_OK;
-}
-
-// Perform initialisation
-static TCP_CLIENT_T *tcp_client_init(void) {
-    TCP_CLIENT_T *state = calloc(1, sizeof(TCP_CLIENT_T));
-    if (!state) {
-        DEBUG_printf("failed to allocate state\n");
-        return NULL;
-    }
-    ip4addr_aton(SERVER_IP, &state->remote_addr);
-    return state;
+    printf("TCP: Dados enviados com sucesso\n");
+    return true;
 }
 
 void wifi_task(void *p) {
@@ -210,47 +140,75 @@ void wifi_task(void *p) {
     // Contador
     int cnt = 0;
 
+    // Template montado uma vez, na partida da tarefa: os cabeçalhos são
+    // literais e vão para o lwIP sem cópia; a cada envio só o corpo e o
+    // Content-Length são reescritos no lugar
+    static http_template_t request;
+    http_template_init(&request);
+
+#if POST_BATCH
+    static SAMPLE_RING_T ring;
+    static char payload_content[PAYLOAD_SIZE];
+    TickType_t last_wake = xTaskGetTickCount();
+
+    http_template_literal(&request, "POST /post_batch HTTP/1.1\r\n"
+                                    "Host: " SERVER_IP "\r\n"
+                                    "Content-Type: application/x-www-form-urlencoded\r\n"
+                                    "Connection: close\r\n"
+                                    "Content-Length: ");
+    http_template_content_length(&request);
+    http_template_literal(&request, "\r\n\r\n");
+    http_template_begin_body(&request);
+    http_template_literal(&request, "dados=");
+    int payload = http_template_buffer(&request);
+
     while (1) {
-        char payload_content[64];
-        int payload_length = 0;
-        payload_length = sprintf(payload_content, "dado=%d", cnt);
-
-        const char *http_request = "POST /post_data HTTP/1.1\r\n"
-                                   "Content-Type: application/x-www-form-urlencoded\r\n"
-                                   "Content-Length: %d\r\n"
-                                   "\r\n"
-                                   "%s";
-
-        char request_new[255];
-        sprintf(request_new, http_request, payload_length, payload_content);
-        printf("%s\n", request_new);
-
-        TCP_CLIENT_T *state = tcp_client_init();
-
-        if (state && tcp_client_open(state)) {
-            printf("SOCKET: Conectado ao servidor\n");
-            cyw43_arch_lwip_begin();
-            int err = tcp_write(state->tcp_pcb, request_new, strlen(request_new), 0);
-            cyw43_arch_lwip_end();
-
-            if (err != ERR_OK) {
-                printf("TCP: Falha ao enviar dados\n");
-                printf("TCP: Servidor está rodando? Porta e IP corretos?\n");
-                printf("\nerrno: %d \n", err);
-            } else {
-                printf("TCP: Dados enviados com sucesso\n");
-                cnt++;
+        sample_ring_push(&ring, cnt++, xTaskGetTickCount());
+
+        if (sample_ring_should_flush(&ring, xTaskGetTickCount())) {
+            int n;
+            int payload_length = sample_ring_format(&ring, payload_content, sizeof(payload_content), &n);
+            http_template_set_buffer(&request, payload, payload_content, payload_length);
+            int request_length = http_template_finish(&request);
+            printf("POST /post_batch: dados=%.*s\n", payload_length, payload_content);
+
+            // Em caso de falha as amostras ficam no buffer para o próximo envio
+            if (send_request(&request)) {
+                sample_ring_pop(&ring, n);
+                print_bytes_on_air(request_length, n);
+            }
+            if (ring.dropped) {
+                printf("POST: %d amostra(s) descartada(s) com o buffer cheio\n", ring.dropped);
             }
+        }
+
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(SAMPLE_PERIOD_MS));
+    }
+#else
+    http_template_literal(&request, "POST /post_data HTTP/1.1\r\n"
+                                    "Host: " SERVER_IP "\r\n"
+                                    "Content-Type: application/x-www-form-urlencoded\r\n"
+                                    "Connection: close\r\n"
+                                    "Content-Length: ");
+    http_template_content_length(&request);
+    http_template_literal(&request, "\r\n\r\n");
+    http_template_begin_body(&request);
+    http_template_literal(&request, "dado=");
+    int dado = http_template_field(&request);
 
-            vTaskDelay(pdMS_TO_TICKS(500));
-        } else {
-            printf("SOCKET: Falha ao conectar ao servidor\n");
-            printf("SOCKET: Verifique IP, porta e rede wifi\n");
+    while (1) {
+        http_template_set_int(&request, dado, cnt);
+        int request_length = http_template_finish(&request);
+        printf("POST /post_data: dado=%d\n", cnt);
+
+        if (send_request(&request)) {
+            print_bytes_on_air(request_length, 1);
+            cnt++;
         }
 
-        tcp_client_close(state);
-        free(state);
+        vTaskDelay(pdMS_TO_TICKS(500));
     }
+#endif
 }
 
 int main() {
@@ -284,7 +242,7 @@ int main() {
     strcpy(sIP, ip4addr_ntoa(netif_ip4_addr(netif_list)));
     printf("Conectado, IP %s\n", sIP);
 
-    xTaskCreate(wifi_task, "wifi task", 4095, NULL, 1, NULL);
+    TASK_CREATE(wifi_task, "wifi task", 4095, NULL, 1, NULL);
 
     vTaskStartScheduler();
 
@@ -0,0 +1,61 @@
+#include "adc_stats.h"
+
+void adc_window_reset(adc_window_t *window) {
+    window->min = UINT16_MAX;
+    window->max = 0;
+    window->sum = 0;
+    window->count = 0;
+}
+
+void adc_window_add(adc_window_t *window, const uint16_t *samples, size_t count) {
+    uint16_t min = window->min;
+    uint16_t max = window->max;
+    uint32_t sum = window->sum;
+
+    // Em variáveis locais: o compilador mantém tudo em registradores
+    for (size_t i = 0; i < count; i++) {
+        uint16_t s = samples[i];
+        sum += s;
+        if (s < min) {
+            min = s;
+        }
+        if (s > max) {
+            max = s;
+        }
+    }
+    window->min = min;
+    window->max = max;
+    window->sum = sum;
+    window->count += count;
+}
+
+uint32_t adc_window_mean_q8(const adc_window_t *window) {
+    if (window->count == 0) {
+        return 0;
+    }
+    // Arredondado
+    return ((window->sum << 8) + window->count / 2) / window->count;
+}
+
+void adc_ema_init(adc_ema_t *ema, uint8_t shift) {
+    ema->value_q16 = 0;
+    ema->shift = shift;
+    ema->primed = false;
+}
+
+void adc_ema_add(adc_ema_t *ema, const uint16_t *samples, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    if (!ema->primed) {
+        ema->value_q16 = (int32_t)samples[0] << 16;
+        ema->primed = true;
+    }
+
+    int32_t y = ema->value_q16;
+    uint8_t shift = ema->shift;
+    for (size_t i = 0; i < count; i++) {
+        y += (((int32_t)samples[i] << 16) - y) >> shift;
+    }
+    ema->value_q16 = y;
+}
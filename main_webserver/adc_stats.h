@@ -0,0 +1,40 @@
+#ifndef ADC_STATS_H
+#define ADC_STATS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Agregação de amostras do ADC em inteiros (o M0+ não tem FPU), sem
+// dependência do SDK: roda no computador em bench/adc_stats_bench.c.
+//
+// Uma janela acumula mínimo, máximo e soma; a média sai em Q8 (contagens
+// * 256). A EMA (média móvel exponencial) fica em Q16 e atravessa as
+// janelas: y += (x - y) / 2^shift a cada amostra.
+
+// A média em Q8 é calculada em 32 bits: 4095 * 256 * amostras < 2^32
+#define ADC_WINDOW_MAX_SAMPLES 4096
+
+typedef struct {
+    uint16_t min;
+    uint16_t max;
+    uint32_t sum;
+    uint32_t count;
+} adc_window_t;
+
+typedef struct {
+    int32_t value_q16;
+    uint8_t shift; // alfa = 1 / 2^shift
+    bool primed;   // a primeira amostra inicia a média
+} adc_ema_t;
+
+void adc_window_reset(adc_window_t *window);
+void adc_window_add(adc_window_t *window, const uint16_t *samples, size_t count);
+
+// Média da janela em Q8; 0 se a janela está vazia
+uint32_t adc_window_mean_q8(const adc_window_t *window);
+
+void adc_ema_init(adc_ema_t *ema, uint8_t shift);
+void adc_ema_add(adc_ema_t *ema, const uint16_t *samples, size_t count);
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef ASSETS_H
+#define ASSETS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Arquivos estáticos de www/, gerados em tempo de compilação por
+// gen_assets.py (www_assets.c). Tudo fica na flash: os bytes e o cabeçalho
+// HTTP de cada versão (original e gzip) já com Content-Length.
+
+typedef struct {
+    const char *path; // "/style.css"
+    const char *header;
+    uint16_t header_len;
+    const uint8_t *data;
+    uint16_t len;
+    const char *gzip_header;
+    uint16_t gzip_header_len;
+    const uint8_t *gzip_data;
+    uint16_t gzip_len;
+} asset_t;
+
+extern const asset_t assets[];
+extern const size_t asset_count;
+
+#endif
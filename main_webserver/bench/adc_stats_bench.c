@@ -0,0 +1,129 @@
+// Confere e mede as agregações do adc_stats.c no computador (não roda na
+// Pico). As amostras são sintéticas: um valor de base com ruído, como o
+// sensor de temperatura interno.
+//
+//   cc -O2 -I. adc_stats.c bench/adc_stats_bench.c -o build/adc_stats_bench -lm
+//   ./build/adc_stats_bench
+//
+// No computador há FPU; os tempos servem para comparar versões dos kernels,
+// não para estimar os ciclos do M0+.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "adc_stats.h"
+
+#define WINDOW 1000
+#define ROUNDS 20000
+#define EMA_SHIFT 8
+
+static uint16_t samples[WINDOW];
+
+static uint32_t lcg(void) {
+    static uint32_t state = 12345;
+    state = state * 1664525u + 1013904223u;
+    return state >> 16;
+}
+
+static void generate(uint16_t base) {
+    for (int i = 0; i < WINDOW; i++) {
+        int v = base + (int)(lcg() % 41) - 20; // +-20 contagens
+        samples[i] = (uint16_t)(v < 0 ? 0 : v > 4095 ? 4095 : v);
+    }
+}
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static bool check(void) {
+    adc_window_t window;
+    adc_ema_t ema;
+    bool ok = true;
+
+    adc_ema_init(&ema, EMA_SHIFT);
+    double ema_ref = 0;
+    bool ema_primed = false;
+
+    for (int round = 0; round < 50; round++) {
+        generate((uint16_t)(800 + round * 3));
+        adc_window_reset(&window);
+        // Em pedaços, como a tarefa lê o anel
+        for (int i = 0; i < WINDOW; i += 100) {
+            adc_window_add(&window, samples + i, 100);
+            adc_ema_add(&ema, samples + i, 100);
+        }
+
+        uint16_t min = UINT16_MAX, max = 0;
+        double sum = 0;
+        for (int i = 0; i < WINDOW; i++) {
+            min = samples[i] < min ? samples[i] : min;
+            max = samples[i] > max ? samples[i] : max;
+            sum += samples[i];
+            if (!ema_primed) {
+                ema_ref = samples[i];
+                ema_primed = true;
+            }
+            ema_ref += (samples[i] - ema_ref) / (1 << EMA_SHIFT);
+        }
+        double mean = adc_window_mean_q8(&window) / 256.0;
+        double ema_value = ema.value_q16 / 65536.0;
+
+        if (window.min != min || window.max != max || fabs(mean - sum / WINDOW) > 1.0 / 256 ||
+            fabs(ema_value - ema_ref) > 0.05) {
+            printf("janela %d: min %u/%u max %u/%u media %.4f/%.4f ema %.4f/%.4f\n", round, window.min, min,
+                   window.max, max, mean, sum / WINDOW, ema_value, ema_ref);
+            ok = false;
+        }
+    }
+    printf("conferencia: %s\n", ok ? "ok" : "FALHOU");
+    return ok;
+}
+
+int main(void) {
+    if (!check()) {
+        return 1;
+    }
+
+    generate(850);
+    adc_window_t window;
+    adc_ema_t ema;
+    adc_ema_init(&ema, EMA_SHIFT);
+    volatile uint32_t sink = 0;
+
+    double start = now_ns();
+    for (int r = 0; r < ROUNDS; r++) {
+        adc_window_reset(&window);
+        adc_window_add(&window, samples, WINDOW);
+        sink += adc_window_mean_q8(&window);
+    }
+    double window_ns = (now_ns() - start) / ((double)ROUNDS * WINDOW);
+
+    start = now_ns();
+    for (int r = 0; r < ROUNDS; r++) {
+        adc_ema_add(&ema, samples, WINDOW);
+    }
+    sink += ema.value_q16;
+    double ema_ns = (now_ns() - start) / ((double)ROUNDS * WINDOW);
+
+    // Mesma EMA em float, para comparar
+    volatile float ema_float = samples[0];
+    start = now_ns();
+    for (int r = 0; r < ROUNDS; r++) {
+        float y = ema_float;
+        for (int i = 0; i < WINDOW; i++) {
+            y += (samples[i] - y) * (1.0f / (1 << EMA_SHIFT));
+        }
+        ema_float = y;
+    }
+    double ema_float_ns = (now_ns() - start) / ((double)ROUNDS * WINDOW);
+
+    printf("janela (min/max/soma): %.2f ns por amostra\n", window_ns);
+    printf("EMA Q16:               %.2f ns por amostra\n", ema_ns);
+    printf("EMA float:             %.2f ns por amostra\n", ema_float_ns);
+    return 0;
+}
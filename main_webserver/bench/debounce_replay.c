@@ -0,0 +1,145 @@
+// Reproduz sequências de bordas no input.c, no computador (não roda na Pico),
+// e confere os eventos que saem da fila. Faz o papel da interrupção de GPIO
+// (input_edge) e do alarme (input_poll no prazo devolvido).
+//
+//   cc -O2 -I. input.c bench/debounce_replay.c -o build/debounce_replay
+//   ./build/debounce_replay
+
+#include <stdio.h>
+#include <string.h>
+
+#include "input.h"
+
+#define DEBOUNCE_US 20000
+
+typedef struct {
+    uint32_t time_us;
+    uint8_t gpio;
+    bool level;
+} edge_t;
+
+typedef struct {
+    uint8_t gpio;
+    bool pressed;
+    uint32_t time_us;
+} expected_t;
+
+typedef struct {
+    const char *name;
+    const edge_t *edges;
+    size_t edge_count;
+    const expected_t *expected;
+    size_t expected_count;
+} scenario_t;
+
+// Dois botões com pull-up: nível 0 = pressionado
+static input_pin_t pins[] = {{.gpio = 5, .active_low = true}, {.gpio = 6, .active_low = true}};
+static const bool idle_levels[] = {true, true};
+
+// Roda as bordas em ordem e chama input_poll() sempre que o prazo vence,
+// como o alarme faria
+static size_t replay(input_t *in, const edge_t *edges, size_t count, input_event_t *out, size_t max) {
+    uint32_t deadline = 0; // 0: sem alarme
+    size_t n = 0;
+    input_event_t event;
+
+    for (size_t i = 0; i <= count; i++) {
+        // Depois da última borda, deixa o alarme correr até acabar
+        uint32_t next_edge = i < count ? edges[i].time_us : UINT32_MAX;
+        while (deadline && deadline <= next_edge) {
+            uint32_t next = input_poll(in, deadline);
+            deadline = next ? deadline + next : 0;
+        }
+        if (i == count) {
+            break;
+        }
+        input_edge(in, input_find(in, edges[i].gpio), edges[i].level, edges[i].time_us);
+        if (!deadline) {
+            deadline = edges[i].time_us + DEBOUNCE_US;
+        }
+    }
+    while (n < max && input_pop(in, &event)) {
+        out[n++] = event;
+    }
+    return n;
+}
+
+#define SCENARIO(name, edges, expected) {name, edges, sizeof(edges) / sizeof(edges[0]), expected, sizeof(expected) / sizeof(expected[0])}
+
+// Aperto com repique nas duas bordas
+static const edge_t bounce_edges[] = {
+    {1000, 5, 0}, {1300, 5, 1}, {1800, 5, 0}, {2500, 5, 1}, {3100, 5, 0},
+    {200000, 5, 1}, {200400, 5, 0}, {201000, 5, 1},
+};
+static const expected_t bounce_expected[] = {{5, true, 1000}, {5, false, 200000}};
+
+// Pulso mais curto que o debounce: ruído, nenhum evento
+static const edge_t glitch_edges[] = {{1000, 5, 0}, {6000, 5, 1}};
+
+// Dois botões ao mesmo tempo, cada um com seu prazo
+static const edge_t two_pins_edges[] = {
+    {1000, 5, 0}, {5000, 6, 0}, {5200, 6, 1}, {5400, 6, 0}, {90000, 6, 1}, {95000, 5, 1},
+};
+static const expected_t two_pins_expected[] = {{5, true, 1000}, {6, true, 5000}, {6, false, 90000}, {5, false, 95000}};
+
+// Aperto de 40 ms: mais longo que o debounce, mas o polling de 100 ms de
+// antes podia não ver
+static const edge_t short_press_edges[] = {{1000, 6, 0}, {41000, 6, 1}};
+static const expected_t short_press_expected[] = {{6, true, 1000}, {6, false, 41000}};
+
+static const scenario_t scenarios[] = {
+    SCENARIO("repique", bounce_edges, bounce_expected),
+    {"pulso curto", glitch_edges, sizeof(glitch_edges) / sizeof(glitch_edges[0]), NULL, 0},
+    SCENARIO("dois botoes", two_pins_edges, two_pins_expected),
+    SCENARIO("aperto de 40 ms", short_press_edges, short_press_expected),
+};
+
+static bool run(const scenario_t *s) {
+    input_t in;
+    input_event_t events[INPUT_QUEUE_SIZE];
+
+    input_init(&in, pins, 2, DEBOUNCE_US, idle_levels);
+    size_t n = replay(&in, s->edges, s->edge_count, events, INPUT_QUEUE_SIZE);
+
+    bool ok = n == s->expected_count;
+    for (size_t i = 0; ok && i < n; i++) {
+        ok = events[i].gpio == s->expected[i].gpio && events[i].pressed == s->expected[i].pressed &&
+             events[i].time_us == s->expected[i].time_us;
+    }
+    printf("%-16s %s (%zu eventos)\n", s->name, ok ? "ok" : "FALHOU", n);
+    for (size_t i = 0; !ok && i < n; i++) {
+        printf("    gpio %u %s em %u us\n", events[i].gpio, events[i].pressed ? "pressionado" : "solto",
+               events[i].time_us);
+    }
+    return ok;
+}
+
+// Fila cheia: os eventos além de INPUT_QUEUE_SIZE são contados e descartados
+static bool run_overflow(void) {
+    input_t in;
+    input_init(&in, pins, 2, DEBOUNCE_US, idle_levels);
+
+    uint32_t t = 0;
+    for (int i = 0; i < INPUT_QUEUE_SIZE + 4; i++) {
+        input_edge(&in, 0, i % 2 == 0 ? 0 : 1, t);
+        t += DEBOUNCE_US;
+        input_poll(&in, t);
+    }
+    input_event_t event;
+    size_t n = 0;
+    while (input_pop(&in, &event)) {
+        n++;
+    }
+    bool ok = n == INPUT_QUEUE_SIZE && in.dropped == 4;
+    printf("%-16s %s (%zu na fila, %u perdidos)\n", "fila cheia", ok ? "ok" : "FALHOU", n, in.dropped);
+    return ok;
+}
+
+int main(void) {
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+        ok &= run(&scenarios[i]);
+    }
+    ok &= run_overflow();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,93 @@
+// Compara, no computador (não roda na Pico), a conversão e a formatação da
+// temperatura em ponto fixo (fixed_point.h) com o caminho em float de antes:
+// primeiro confere que os dois concordam em todas as contagens, depois mede.
+//
+//   cc -O2 -I. -I../http fixed_point.c ../http/http_format.c bench/fixed_point_bench.c -o build/fixed_point_bench
+//   ./build/fixed_point_bench
+//
+// O computador tem FPU e a Pico não: lá o float vira chamadas de biblioteca
+// (__aeabi_fmul, __aeabi_fdiv, e o printf de %f em double), então a
+// diferença na placa é maior. Com FIXED_POINT_BENCHMARK 1 no main.c a
+// mesma comparação roda na Pico e imprime os ciclos.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "fixed_point.h"
+
+#define ROUNDS 2000000
+
+static const fixed_linear_t temperature = FIXED_LINEAR(27.0 + 0.706 / 0.001721, -(3.3 / 4096) / 0.001721);
+
+// Como o main.c fazia antes
+static float converte_temperatura(float contagem) {
+    const float fator_conversao = 3.3f / (1 << 12);
+    float adc = contagem * fator_conversao;
+    return 27.0f - (adc - 0.706f) / 0.001721f;
+}
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int check(void) {
+    int worst_milli = 0;
+    int format_mismatches = 0;
+
+    // Todas as contagens, com fração de 1/16 (a EMA tem fração)
+    for (uint32_t q = 0; q <= 4095u << 16; q += 1u << 12) {
+        float reference = converte_temperatura(q / 65536.0f);
+        int32_t milli = fixed_linear_milli(&temperature, q);
+        int error = abs(milli - (int)(reference * 1000.0f + (reference >= 0 ? 0.5f : -0.5f)));
+        worst_milli = error > worst_milli ? error : worst_milli;
+
+        char fixed[16], printed[16];
+        fixed[fixed_format_milli(fixed, milli, 2)] = '\0';
+        snprintf(printed, sizeof(printed), "%.2f", milli / 1000.0);
+        // Só empates (x.xx5) podem arredondar diferente
+        if (strtod(fixed, NULL) - strtod(printed, NULL) > 0.0101 || strtod(printed, NULL) - strtod(fixed, NULL) > 0.0101) {
+            format_mismatches++;
+        }
+    }
+    printf("conversao: erro maximo %d m°C; formatacao: %d diferencas\n", worst_milli, format_mismatches);
+    return worst_milli <= 1 && format_mismatches == 0;
+}
+
+int main(void) {
+    if (!check()) {
+        printf("FALHOU\n");
+        return 1;
+    }
+
+    char buf[32];
+    volatile uint32_t sink = 0;
+    uint32_t q = 800u << 16;
+
+    double start = now_ns();
+    for (int i = 0; i < ROUNDS; i++) {
+        float t = converte_temperatura((q + (uint32_t)i * 97) / 65536.0f);
+        sink += (uint32_t)snprintf(buf, sizeof(buf), "%.2f", t);
+    }
+    double float_ns = (now_ns() - start) / ROUNDS;
+
+    start = now_ns();
+    for (int i = 0; i < ROUNDS; i++) {
+        int32_t milli = fixed_linear_milli(&temperature, q + (uint32_t)i * 97);
+        sink += (uint32_t)fixed_format_milli(buf, milli, 2);
+    }
+    double fixed_ns = (now_ns() - start) / ROUNDS;
+
+    start = now_ns();
+    for (int i = 0; i < ROUNDS; i++) {
+        sink += (uint32_t)fixed_linear_milli(&temperature, q + (uint32_t)i * 97);
+    }
+    double convert_ns = (now_ns() - start) / ROUNDS;
+
+    printf("float + snprintf %%.2f:     %7.1f ns\n", float_ns);
+    printf("ponto fixo + formatacao:  %7.1f ns (%.1fx)\n", fixed_ns, float_ns / fixed_ns);
+    printf("so a conversao em fixo:   %7.1f ns\n", convert_ns);
+    return 0;
+}
@@ -0,0 +1,283 @@
+// Simula no computador a divisão de trabalho do FREERTOS_SMP (não roda na
+// Pico): um núcleo atende requisições e o ADC é agregado no mesmo núcleo
+// (kernel de um núcleo, na tarefa de sensores) ou em outro (FREERTOS_SMP, a
+// tarefa do ADC presa ao core 1, aqui uma segunda thread).
+//
+//   python gen_routes.py routes.def build/bench routes
+//   cc -O2 -pthread -I. -I../http -Ibuild/bench router.c build/bench/routes.c adc_stats.c fixed_point.c ../http/http_format.c
+//      bench/multicore_bench.c -o build/multicore_bench
+//   ./build/multicore_bench
+//
+// Requisição: router_match() na linha de requisição e a página copiada para
+// um buffer com a temperatura formatada. Sensor: lotes de amostras passam
+// por adc_window_add/adc_ema_add e cada janela fechada vira o texto da
+// temperatura, entregue ao outro lado com um spinlock (na placa, a seção
+// crítica do kernel SMP, feita com os spinlocks do SIO).
+//
+// A carga do sensor é dada como fração de um núcleo: o custo por amostra é
+// medido antes e a taxa de amostras é escolhida para ocupar essa fração. No
+// computador o ADC de 1 kHz não pesaria nada; a fração representa o que o
+// núcleo da rede perde para o trabalho que sai dele. A thread do sensor
+// dorme PERIOD_US entre as agregações, como a adc_task().
+//
+// Com um núcleo só disponível no computador, as duas threads dividiriam a
+// mesma CPU e a comparação não mediria nada; o programa se recusa a rodar.
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "adc_stats.h"
+#include "fixed_point.h"
+#include "routes.h"
+
+#define DURATION_S 0.5
+#define BATCH 100
+#define WINDOW 1000
+#define EMA_SHIFT 8
+#define PAGE_SIZE 1200
+#define PERIOD_US 1000
+
+static const fixed_linear_t temperature_line = FIXED_LINEAR(27.0 + 0.706 / 0.001721, -(3.3 / 4096) / 0.001721);
+
+static const char *const requests[] = {
+    "GET / HTTP/1.1\r\nHost: 192.168.0.50\r\n\r\n",
+    "GET /led/on HTTP/1.1\r\nHost: 192.168.0.50\r\n\r\n",
+    "GET /style.css HTTP/1.1\r\nHost: 192.168.0.50\r\n\r\n",
+    "GET /events HTTP/1.1\r\nHost: 192.168.0.50\r\n\r\n",
+};
+#define REQUEST_COUNT (sizeof(requests) / sizeof(requests[0]))
+
+static char page[PAGE_SIZE];
+static volatile uint32_t sink;
+static uint16_t samples[WINDOW];
+
+// Leitura compartilhada, como temperature_shared no main.c
+typedef struct {
+    uint32_t seq;
+    char message[64];
+} reading_t;
+
+static reading_t shared;
+static volatile bool shared_lock;
+
+static void lock(void) {
+    while (__atomic_test_and_set(&shared_lock, __ATOMIC_ACQUIRE)) {
+    }
+}
+
+static void unlock(void) {
+    __atomic_clear(&shared_lock, __ATOMIC_RELEASE);
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// --- Trabalho do núcleo da rede ----------------------------------------------
+
+typedef struct {
+    char response[PAGE_SIZE + 64];
+    char temperature[64];
+    uint32_t seen;
+    uint32_t checksum; // para o compilador não descartar o trabalho
+} server_t;
+
+static void handle_request(server_t *server, uint32_t n) {
+    const char *request = requests[n % REQUEST_COUNT];
+    router_match_t match;
+
+    if (router_match(&routes_table, request, strlen(request), &match) == ROUTER_OK) {
+        size_t len = strlen(server->temperature);
+        memcpy(server->response, page, PAGE_SIZE);
+        memcpy(server->response + PAGE_SIZE, server->temperature, len);
+        server->checksum += match.route + (uint8_t)server->response[n % (PAGE_SIZE + len)];
+    }
+}
+
+// Como temperature_poll(): copia a leitura se o sensor deixou uma nova
+static void poll_reading(server_t *server) {
+    reading_t reading;
+    lock();
+    reading = shared;
+    unlock();
+    if (reading.seq != server->seen) {
+        server->seen = reading.seq;
+        memcpy(server->temperature, reading.message, sizeof(server->temperature));
+    }
+}
+
+// --- Trabalho do sensor ------------------------------------------------------
+
+typedef struct {
+    adc_window_t window;
+    adc_ema_t ema;
+    uint32_t offset;
+    uint64_t samples;
+    uint32_t windows;
+} sensor_t;
+
+static void sensor_init(sensor_t *sensor) {
+    memset(sensor, 0, sizeof(*sensor));
+    adc_window_reset(&sensor->window);
+    adc_ema_init(&sensor->ema, EMA_SHIFT);
+}
+
+// Um lote de BATCH amostras; fecha a janela e publica a cada WINDOW
+static void sensor_batch(sensor_t *sensor) {
+    adc_window_add(&sensor->window, samples + sensor->offset, BATCH);
+    adc_ema_add(&sensor->ema, samples + sensor->offset, BATCH);
+    sensor->offset = (sensor->offset + BATCH) % WINDOW;
+    sensor->samples += BATCH;
+
+    if (sensor->window.count == WINDOW) {
+        reading_t reading;
+        char atual[16];
+        int32_t milli = fixed_linear_milli(&temperature_line, sensor->ema.value_q16);
+        atual[fixed_format_milli(atual, milli, 2)] = '\0';
+        snprintf(reading.message, sizeof(reading.message), "Temperatura: %s°C", atual);
+        adc_window_reset(&sensor->window);
+        sensor->windows++;
+
+        lock();
+        reading.seq = shared.seq + 1;
+        shared = reading;
+        unlock();
+    }
+}
+
+// Lotes que já deveriam ter sido agregados a rate amostras/s
+static uint64_t batches_due(double start, double rate) {
+    return (uint64_t)((now_s() - start) * rate) / BATCH;
+}
+
+// --- Modos --------------------------------------------------------------------
+
+typedef struct {
+    double requests_per_s;
+    double samples_per_s;
+} result_t;
+
+// Um núcleo: o mesmo laço atende e agrega
+static result_t run_single(double rate) {
+    server_t server = {0};
+    sensor_t sensor;
+    sensor_init(&sensor);
+
+    uint32_t n = 0;
+    uint64_t done = 0;
+    double start = now_s();
+    double elapsed;
+    do {
+        for (int i = 0; i < 64; i++) {
+            handle_request(&server, n++);
+        }
+        for (uint64_t due = batches_due(start, rate); done < due; done++) {
+            sensor_batch(&sensor);
+        }
+        poll_reading(&server);
+        elapsed = now_s() - start;
+    } while (elapsed < DURATION_S);
+
+    sink += server.checksum;
+    return (result_t){n / elapsed, sensor.samples / elapsed};
+}
+
+typedef struct {
+    double rate;
+    double start;
+    volatile bool stop;
+    sensor_t sensor;
+} sensor_thread_t;
+
+// Tarefa do ADC: agrega no ritmo das amostras e espera entre os lotes
+static void *sensor_thread(void *arg) {
+    sensor_thread_t *t = arg;
+    uint64_t done = 0;
+
+    while (!t->stop) {
+        for (uint64_t due = batches_due(t->start, t->rate); done < due; done++) {
+            sensor_batch(&t->sensor);
+        }
+        usleep(PERIOD_US);
+    }
+    return NULL;
+}
+
+// FREERTOS_SMP: o sensor em outra thread
+static result_t run_dual(double rate) {
+    server_t server = {0};
+    sensor_thread_t t = {.rate = rate};
+    sensor_init(&t.sensor);
+
+    pthread_t thread;
+    t.start = now_s();
+    pthread_create(&thread, NULL, sensor_thread, &t);
+
+    uint32_t n = 0;
+    double elapsed;
+    do {
+        for (int i = 0; i < 64; i++) {
+            handle_request(&server, n++);
+        }
+        poll_reading(&server);
+        elapsed = now_s() - t.start;
+    } while (elapsed < DURATION_S);
+
+    t.stop = true;
+    pthread_join(thread, NULL);
+    sink += server.checksum;
+    return (result_t){n / elapsed, t.sensor.samples / elapsed};
+}
+
+// Custo de uma amostra do sensor, em segundos
+static double sample_cost(void) {
+    sensor_t sensor;
+    sensor_init(&sensor);
+    const int batches = 200000;
+
+    double start = now_s();
+    for (int i = 0; i < batches; i++) {
+        sensor_batch(&sensor);
+    }
+    return (now_s() - start) / ((double)batches * BATCH);
+}
+
+int main(void) {
+    for (int i = 0; i < PAGE_SIZE; i++) {
+        page[i] = (char)('a' + i % 26);
+    }
+    uint32_t state = 12345;
+    for (int i = 0; i < WINDOW; i++) {
+        state = state * 1664525u + 1013904223u;
+        samples[i] = (uint16_t)(800 + (state >> 16) % 41);
+    }
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus < 2) {
+        fprintf(stderr, "multicore_bench: precisa de 2 nucleos ou mais (disponiveis: %ld); "
+                        "com um so as duas threads dividem a mesma CPU e nao ha ganho a medir\n", cpus);
+        return 1;
+    }
+
+    double cost = sample_cost();
+    printf("sensor: %.2f ns por amostra\n\n", cost * 1e9);
+    printf("carga do sensor   1 nucleo (req/s)   2 nucleos (req/s)   ganho   amostras/s (1 / 2)\n");
+
+    static const double loads[] = {0.0, 0.10, 0.25, 0.50, 0.75};
+    for (size_t i = 0; i < sizeof(loads) / sizeof(loads[0]); i++) {
+        double rate = loads[i] / cost;
+        result_t single = run_single(rate);
+        result_t dual = run_dual(rate);
+        printf("%13.0f%%   %16.0f   %17.0f   %5.2fx   %.3g / %.3g\n", loads[i] * 100, single.requests_per_s,
+               dual.requests_per_s, dual.requests_per_s / single.requests_per_s, single.samples_per_s,
+               dual.samples_per_s);
+    }
+    return 0;
+}
@@ -0,0 +1,120 @@
+// Benchmark do roteador no computador (não roda na Pico).
+//
+// Compara router_match() com a busca antiga, um strstr() por rota sobre a
+// requisição inteira, para as 64 rotas de bench/routes.def:
+//
+//   python gen_routes.py bench/routes.def build/bench bench_routes
+//   cc -O2 -I. -Ibuild/bench router.c build/bench/bench_routes.c bench/router_bench.c -o build/router_bench
+//   ./build/router_bench
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "bench_routes.h"
+
+#define ITERATIONS 200000
+
+// Cabeçalhos típicos de um navegador: o strstr() percorre tudo isso
+#define HEADERS                                                                                       \
+    " HTTP/1.1\r\n"                                                                                   \
+    "Host: 192.168.0.50\r\n"                                                                          \
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:128.0) Gecko/20100101 Firefox/128.0\r\n"          \
+    "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"                    \
+    "Accept-Language: pt-BR,pt;q=0.8,en-US;q=0.5,en;q=0.3\r\n"                                        \
+    "Accept-Encoding: gzip, deflate\r\n"                                                              \
+    "Connection: keep-alive\r\n"                                                                      \
+    "\r\n"
+
+typedef struct {
+    const char *request;
+    int route;
+} bench_case_t;
+
+#define RESOURCE_CASES(r, R)                                                                          \
+    {"GET /api/" r HEADERS, ROUTE_##R##_LIST}, {"POST /api/" r HEADERS, ROUTE_##R##_CREATE},        \
+        {"GET /api/" r "/42" HEADERS, ROUTE_##R##_GET}, {"PUT /api/" r "/42" HEADERS, ROUTE_##R##_UPDATE}, \
+        {"DELETE /api/" r "/42" HEADERS, ROUTE_##R##_DELETE},                                         \
+        {"GET /api/" r "/42/history" HEADERS, ROUTE_##R##_HISTORY}
+
+static const bench_case_t cases[] = {
+    RESOURCE_CASES("sensors", SENSORS),     RESOURCE_CASES("actuators", ACTUATORS),
+    RESOURCE_CASES("users", USERS),         RESOURCE_CASES("devices", DEVICES),
+    RESOURCE_CASES("logs", LOGS),           RESOURCE_CASES("alarms", ALARMS),
+    RESOURCE_CASES("schedules", SCHEDULES), RESOURCE_CASES("scenes", SCENES),
+    RESOURCE_CASES("rooms", ROOMS),         RESOURCE_CASES("firmware", FIRMWARE),
+    {"GET /" HEADERS, ROUTE_INDEX},         {"GET /status" HEADERS, ROUTE_STATUS},
+    {"GET /led/on" HEADERS, ROUTE_LED},     {"GET /style.css" HEADERS, ROUTE_ASSET},
+};
+
+#define CASE_COUNT (sizeof(cases) / sizeof(cases[0]))
+
+// Como o http_callback fazia: um strstr() por rota, na ordem, até achar.
+// As agulhas são as linhas de requisição dos próprios casos (com o espaço
+// antes da versão, senão "/api/logs" acharia "/api/logs/42").
+static char needles[CASE_COUNT][64];
+
+static void build_needles(void) {
+    for (size_t i = 0; i < CASE_COUNT; i++) {
+        size_t len = strstr(cases[i].request, " HTTP/1.1") - cases[i].request + 1;
+        memcpy(needles[i], cases[i].request, len);
+        needles[i][len] = '\0';
+    }
+}
+
+static int strstr_match(const char *request) {
+    for (size_t i = 0; i < CASE_COUNT; i++) {
+        if (strstr(request, needles[i])) {
+            return cases[i].route;
+        }
+    }
+    return -1;
+}
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int main(void) {
+    build_needles();
+    size_t lengths[CASE_COUNT];
+    for (size_t i = 0; i < CASE_COUNT; i++) {
+        lengths[i] = strlen(cases[i].request);
+    }
+
+    // Confere antes de medir
+    for (size_t i = 0; i < CASE_COUNT; i++) {
+        router_match_t match;
+        router_result_t result = router_match(&bench_routes_table, cases[i].request, lengths[i], &match);
+        if (result != ROUTER_OK || match.route != cases[i].route || strstr_match(cases[i].request) != cases[i].route) {
+            printf("rota errada: %.40s\n", cases[i].request);
+            return 1;
+        }
+    }
+
+    volatile int sink = 0;
+    double start = now_ns();
+    for (int n = 0; n < ITERATIONS; n++) {
+        for (size_t i = 0; i < CASE_COUNT; i++) {
+            router_match_t match;
+            router_match(&bench_routes_table, cases[i].request, lengths[i], &match);
+            sink += match.route;
+        }
+    }
+    double router_ns = (now_ns() - start) / ((double)ITERATIONS * CASE_COUNT);
+
+    start = now_ns();
+    for (int n = 0; n < ITERATIONS / 10; n++) {
+        for (size_t i = 0; i < CASE_COUNT; i++) {
+            sink += strstr_match(cases[i].request);
+        }
+    }
+    double strstr_ns = (now_ns() - start) / ((double)(ITERATIONS / 10) * CASE_COUNT);
+
+    printf("%zu rotas, %u nós\n", CASE_COUNT, bench_routes_table.node_count);
+    printf("router_match: %8.1f ns por requisição\n", router_ns);
+    printf("strstr:       %8.1f ns por requisição (%.0fx)\n", strstr_ns, strstr_ns / router_ns);
+    return 0;
+}
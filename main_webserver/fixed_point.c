@@ -0,0 +1,31 @@
+#include "fixed_point.h"
+#include "http_format.h"
+
+static const uint32_t powers_of_10[] = {1, 10, 100, 1000};
+
+size_t fixed_format_milli(char *buf, int32_t value_milli, int decimals) {
+    size_t n = 0;
+    uint32_t magnitude = value_milli < 0 ? 0u - (uint32_t)value_milli : (uint32_t)value_milli;
+
+    // Arredonda para as casas pedidas (meio para longe do zero, como o printf
+    // faz na prática para esses valores)
+    uint32_t step = powers_of_10[3 - decimals];
+    magnitude = (magnitude + step / 2) / step;
+
+    uint32_t scale = powers_of_10[decimals];
+    uint32_t integer = magnitude / scale;
+    uint32_t fraction = magnitude % scale;
+
+    if (value_milli < 0 && magnitude != 0) {
+        buf[n++] = '-';
+    }
+    n += http_format_uint(buf + n, integer);
+    if (decimals > 0) {
+        buf[n++] = '.';
+        // Zeros à esquerda da fração
+        for (uint32_t p = scale / 10; p > 0; p /= 10) {
+            buf[n++] = (char)('0' + fraction / p % 10);
+        }
+    }
+    return n;
+}
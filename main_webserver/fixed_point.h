@@ -0,0 +1,41 @@
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Conversão de leituras do ADC para unidades físicas só com inteiros (o M0+
+// não tem FPU, e float aqui vira chamada de biblioteca).
+//
+// Cada canal é uma reta, valor = offset + gain * contagem, com offset e gain
+// escritos em ponto flutuante na macro FIXED_LINEAR. O compilador calcula as
+// constantes inteiras (milésimos da unidade; gain em Q16); em tempo de
+// execução sobra uma multiplicação e um shift. Exemplo, sensor interno de
+// temperatura (resultado em m°C):
+//
+//     static const fixed_linear_t temp = FIXED_LINEAR(27.0 + 0.706 / 0.001721,
+//                                                     -(3.3 / 4096) / 0.001721);
+//     int32_t mili = fixed_linear_milli(&temp, contagem_q16);
+//
+// |gain| precisa ficar abaixo de 32767 milésimos por contagem.
+
+typedef struct {
+    int32_t offset_milli;
+    int32_t gain_milli_q16; // milésimos por contagem, em Q16
+} fixed_linear_t;
+
+#define FIXED_ROUND(x) ((int32_t)((x) >= 0 ? (x) + 0.5 : (x) - 0.5))
+#define FIXED_LINEAR(offset, gain) {FIXED_ROUND((offset) * 1000.0), FIXED_ROUND((gain) * 1000.0 * 65536.0)}
+
+// Contagem em Q16 (a EMA já está nesse formato; contagem inteira: << 16)
+static inline int32_t fixed_linear_milli(const fixed_linear_t *line, uint32_t counts_q16) {
+    // Q16 * Q16 = Q32: os 32 bits de cima são a parte inteira, arredondada
+    int64_t product = (int64_t)counts_q16 * line->gain_milli_q16;
+    return line->offset_milli + (int32_t)((product + ((int64_t)1 << 31)) >> 32);
+}
+
+// Escreve value_milli / 1000 com decimals casas (0 a 3), arredondado, sem
+// '\0'. Retorna o número de caracteres (no máximo 12).
+size_t fixed_format_milli(char *buf, int32_t value_milli, int decimals);
+
+#endif
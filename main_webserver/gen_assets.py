@@ -0,0 +1,97 @@
+# Gera a tabela de arquivos estáticos do servidor (www_assets.c) a partir
+# dos arquivos de www/. Cada arquivo vai para a flash duas vezes, original e
+# comprimido com gzip, cada um com o cabeçalho HTTP já pronto.
+#
+#   python gen_assets.py saida.c www/style.css www/app.js ...
+
+import gzip
+import os
+import sys
+
+CONTENT_TYPES = {
+    ".html": "text/html; charset=UTF-8",
+    ".css": "text/css",
+    ".js": "application/javascript",
+    ".json": "application/json",
+    ".svg": "image/svg+xml",
+    ".png": "image/png",
+    ".ico": "image/x-icon",
+}
+
+# Os arquivos podem mudar a cada gravação; o navegador guarda por pouco tempo
+CACHE_CONTROL = "max-age=300"
+
+
+def header(content_type, length, gzipped):
+    lines = [
+        "HTTP/1.1 200 OK",
+        f"Content-Type: {content_type}",
+        f"Content-Length: {length}",
+        f"Cache-Control: {CACHE_CONTROL}",
+        "Vary: Accept-Encoding",
+    ]
+    if gzipped:
+        lines.append("Content-Encoding: gzip")
+    return "\r\n".join(lines) + "\r\n\r\n"
+
+
+def c_string(s):
+    return '"' + s.replace("\\", "\\\\").replace('"', '\\"').replace("\r", "\\r").replace("\n", "\\n") + '"'
+
+
+def c_bytes(data):
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append("    " + ", ".join(f"0x{b:02x}" for b in data[i : i + 16]) + ",")
+    return "\n".join(lines)
+
+
+def main():
+    output, files = sys.argv[1], sys.argv[2:]
+    out = ['// Gerado por gen_assets.py a partir de www/. Não editar.', "", '#include "assets.h"', ""]
+    entries = []
+
+    for i, path in enumerate(sorted(files, key=os.path.basename)):
+        name = os.path.basename(path)
+        content_type = CONTENT_TYPES.get(os.path.splitext(name)[1], "application/octet-stream")
+        with open(path, "rb") as f:
+            data = f.read()
+        # mtime=0: a mesma entrada gera sempre os mesmos bytes
+        compressed = gzip.compress(data, compresslevel=9, mtime=0)
+        if len(data) > 0xFFFF:
+            sys.exit(f"{path}: maior que 64 KB")
+
+        out.append(f"// {name}: {len(data)} bytes, {len(compressed)} com gzip")
+        out.append(f"static const uint8_t asset_{i}[] = {{\n{c_bytes(data)}\n}};")
+        out.append(f"static const uint8_t asset_{i}_gzip[] = {{\n{c_bytes(compressed)}\n}};")
+        out.append("")
+        plain_header = header(content_type, len(data), False)
+        gzip_header = header(content_type, len(compressed), True)
+        entries.append(
+            "    {\n"
+            f"        .path = {c_string('/' + name)},\n"
+            f"        .header = {c_string(plain_header)},\n"
+            f"        .header_len = {len(plain_header)},\n"
+            f"        .data = asset_{i},\n"
+            f"        .len = sizeof(asset_{i}),\n"
+            f"        .gzip_header = {c_string(gzip_header)},\n"
+            f"        .gzip_header_len = {len(gzip_header)},\n"
+            f"        .gzip_data = asset_{i}_gzip,\n"
+            f"        .gzip_len = sizeof(asset_{i}_gzip),\n"
+            "    },"
+        )
+        print(f"{name}: {len(data)} -> {len(compressed)} bytes")
+
+    out.append("const asset_t assets[] = {")
+    out.extend(entries)
+    out.append("};")
+    out.append("")
+    out.append("const size_t asset_count = sizeof(assets) / sizeof(assets[0]);")
+    out.append("")
+
+    with open(output, "w", encoding="utf-8") as f:
+        f.write("\n".join(out))
+
+
+if __name__ == "__main__":
+    main()
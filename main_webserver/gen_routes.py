@@ -0,0 +1,154 @@
+# Gera a árvore de rotas (router.h) a partir de um arquivo .def:
+#
+#   # método  caminho        id
+#   GET       /              PAGE
+#   GET       /led/:estado   LED
+#
+#   python gen_routes.py routes.def <diretório de saída> <nome>
+#
+# Escreve <nome>.h, com um ROUTE_<id> para cada id, e <nome>.c, com a tabela
+# <nome>_table.
+
+import os
+import sys
+
+METHODS = ["GET", "HEAD", "POST", "PUT", "DELETE", "PATCH", "OPTIONS"]
+NO_ROUTE = 0xFF
+NO_CHILD = 0xFFFF
+
+
+class Node:
+    def __init__(self, segment):
+        self.segment = segment  # None na raiz e em ":param"
+        self.children = {}
+        self.param = None
+        self.routes = {}
+
+
+def parse(path):
+    routes = []
+    with open(path, encoding="utf-8") as f:
+        for number, line in enumerate(f, 1):
+            line = line.split("#", 1)[0].strip()
+            if not line:
+                continue
+            fields = line.split()
+            if len(fields) != 3 or fields[0] not in METHODS or not fields[1].startswith("/"):
+                sys.exit(f"{path}:{number}: esperado '<método> /<caminho> <id>'")
+            routes.append((fields[0], fields[1], fields[2], number))
+    return routes
+
+
+def build(routes, def_path):
+    root = Node(None)
+    ids = []
+    for method, path, name, number in routes:
+        if name not in ids:
+            ids.append(name)
+        node = root
+        for segment in (s for s in path.split("/") if s):
+            if segment.startswith(":"):
+                if node.param is None:
+                    node.param = Node(None)
+                node = node.param
+            else:
+                if len(segment.encode()) > 255:
+                    sys.exit(f"{def_path}:{number}: segmento com mais de 255 bytes")
+                node = node.children.setdefault(segment, Node(segment))
+        if method in node.routes:
+            sys.exit(f"{def_path}:{number}: {method} {path} repetida")
+        node.routes[method] = ids.index(name)
+    if len(ids) >= NO_ROUTE:
+        sys.exit(f"{def_path}: rotas demais")
+    return root, ids
+
+
+def flatten(root):
+    # Em largura: os filhos literais de cada nó ficam contíguos e ordenados
+    # (bytes, mais curto antes), como router.c espera na busca binária
+    nodes = [root]
+    index = {id(root): 0}
+    queue = [root]
+    while queue:
+        node = queue.pop(0)
+        node.first_child = len(nodes)
+        node.literals = [node.children[k] for k in sorted(node.children, key=lambda s: s.encode())]
+        for child in node.literals:
+            index[id(child)] = len(nodes)
+            nodes.append(child)
+            queue.append(child)
+        if node.param is not None:
+            index[id(node.param)] = len(nodes)
+            nodes.append(node.param)
+            queue.append(node.param)
+    if len(nodes) >= NO_CHILD:
+        sys.exit("nós demais")
+    return nodes, index
+
+
+def c_string(s):
+    return '"' + s.replace("\\", "\\\\").replace('"', '\\"') + '"'
+
+
+def main():
+    def_path, out_dir, name = sys.argv[1], sys.argv[2], sys.argv[3]
+    routes = parse(def_path)
+    root, ids = build(routes, def_path)
+    nodes, index = flatten(root)
+    guard = name.upper() + "_H"
+    source = os.path.basename(def_path)
+
+    header = [
+        f"// Gerado por gen_routes.py a partir de {source}. Não editar.",
+        "",
+        f"#ifndef {guard}",
+        f"#define {guard}",
+        "",
+        '#include "router.h"',
+        "",
+        "enum {",
+    ]
+    header += [f"    ROUTE_{route_id}," for route_id in ids]
+    header += [
+        f"    {name.upper()}_COUNT,",
+        "};",
+        "",
+        f"extern const router_table_t {name}_table;",
+        "",
+        "#endif",
+        "",
+    ]
+
+    body = [
+        f"// Gerado por gen_routes.py a partir de {source}. Não editar.",
+        "",
+        f'#include "{name}.h"',
+        "",
+        "#define X ROUTER_NO_ROUTE",
+        "",
+        f"static const router_node_t nodes[{len(nodes)}] = {{",
+    ]
+    for i, node in enumerate(nodes):
+        segment = "NULL, 0" if node.segment is None else f"{c_string(node.segment)}, {len(node.segment.encode())}"
+        param = index[id(node.param)] if node.param is not None else "ROUTER_NO_CHILD"
+        route = ", ".join(f"ROUTE_{ids[node.routes[m]]}" if m in node.routes else "X" for m in METHODS)
+        label = "/" if i == 0 else (node.segment or ":param")
+        body.append(
+            f"    {{{segment}, {len(node.literals)}, {node.first_child}, {param}, {{{route}}}}}, // {i}: {label}"
+        )
+    body += [
+        "};",
+        "",
+        f"const router_table_t {name}_table = {{nodes, {len(nodes)}}};",
+        "",
+    ]
+
+    os.makedirs(out_dir, exist_ok=True)
+    with open(os.path.join(out_dir, name + ".h"), "w", encoding="utf-8") as f:
+        f.write("\n".join(header))
+    with open(os.path.join(out_dir, name + ".c"), "w", encoding="utf-8") as f:
+        f.write("\n".join(body))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,95 @@
+#include "input.h"
+
+static bool pressed(const input_pin_t *pin, bool level) {
+    return pin->active_low ? !level : level;
+}
+
+void input_init(input_t *in, input_pin_t *pins, size_t pin_count, uint32_t debounce_us, const bool *levels) {
+    in->pins = pins;
+    in->pin_count = pin_count;
+    in->debounce_us = debounce_us;
+    in->head = 0;
+    in->tail = 0;
+    in->dropped = 0;
+
+    for (size_t i = 0; i < pin_count; i++) {
+        pins[i].stable = pressed(&pins[i], levels[i]);
+        pins[i].raw = pins[i].stable;
+        pins[i].pending = false;
+    }
+}
+
+int input_find(const input_t *in, uint8_t gpio) {
+    for (size_t i = 0; i < in->pin_count; i++) {
+        if (in->pins[i].gpio == gpio) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+void input_edge(input_t *in, size_t index, bool level, uint32_t now_us) {
+    input_pin_t *pin = &in->pins[index];
+
+    if (!pin->pending) {
+        pin->pending = true;
+        pin->first_edge_us = now_us;
+    }
+    pin->last_edge_us = now_us;
+    pin->raw = pressed(pin, level);
+}
+
+static void push(input_t *in, const input_event_t *event) {
+    uint32_t head = in->head;
+    if (head - __atomic_load_n(&in->tail, __ATOMIC_ACQUIRE) == INPUT_QUEUE_SIZE) {
+        in->dropped++;
+        return;
+    }
+    in->queue[head % INPUT_QUEUE_SIZE] = *event;
+    // O evento fica visível antes do novo head
+    __atomic_store_n(&in->head, head + 1, __ATOMIC_RELEASE);
+}
+
+uint32_t input_poll(input_t *in, uint32_t now_us) {
+    uint32_t next_us = 0;
+
+    for (size_t i = 0; i < in->pin_count; i++) {
+        input_pin_t *pin = &in->pins[i];
+        if (!pin->pending) {
+            continue;
+        }
+
+        uint32_t quiet_us = now_us - pin->last_edge_us;
+        if (quiet_us < in->debounce_us) {
+            uint32_t remaining = in->debounce_us - quiet_us;
+            if (next_us == 0 || remaining < next_us) {
+                next_us = remaining;
+            }
+            continue;
+        }
+
+        pin->pending = false;
+        // Pulso mais curto que o debounce volta ao mesmo estado: nada muda
+        if (pin->raw != pin->stable) {
+            pin->stable = pin->raw;
+            input_event_t event = {
+                .index = (uint8_t)i,
+                .gpio = pin->gpio,
+                .pressed = pin->stable,
+                .time_us = pin->first_edge_us,
+            };
+            push(in, &event);
+        }
+    }
+    return next_us;
+}
+
+bool input_pop(input_t *in, input_event_t *event) {
+    uint32_t tail = in->tail;
+    if (__atomic_load_n(&in->head, __ATOMIC_ACQUIRE) == tail) {
+        return false;
+    }
+    *event = in->queue[tail % INPUT_QUEUE_SIZE];
+    __atomic_store_n(&in->tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
@@ -0,0 +1,71 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Entradas digitais com debounce por tempo, sem dependência do SDK (roda no
+// computador, ver bench/debounce_replay.c).
+//
+// Quem usa liga as duas pontas:
+// - interrupção de borda: input_edge() com o nível lido e o instante;
+// - timer: input_poll() quando passar o prazo devolvido pela última
+//   chamada (ou debounce_us depois da primeira borda).
+//
+// Um pino só muda de estado depois de debounce_us sem bordas. A mudança vai
+// para uma fila com o instante da primeira borda, lida com input_pop() por
+// outra tarefa. A fila é de um produtor e um consumidor e não usa trava:
+// input_edge() e input_poll() devem rodar no mesmo nível de interrupção (na
+// Pico, GPIO e timer têm a mesma prioridade por padrão) e input_pop() em um
+// só lugar.
+
+#ifndef INPUT_QUEUE_SIZE
+#define INPUT_QUEUE_SIZE 16 // potência de 2
+#endif
+
+typedef struct {
+    uint8_t gpio;
+    bool active_low; // pressionado = nível 0 (pull-up)
+
+    // Estado interno
+    bool stable;  // pressionado, depois do debounce
+    bool raw;     // pressionado, pela última borda
+    bool pending; // teve borda e ainda não estabilizou
+    uint32_t first_edge_us;
+    uint32_t last_edge_us;
+} input_pin_t;
+
+typedef struct {
+    uint8_t index; // posição em pins
+    uint8_t gpio;
+    bool pressed;
+    uint32_t time_us; // primeira borda da mudança
+} input_event_t;
+
+typedef struct {
+    input_pin_t *pins;
+    size_t pin_count;
+    uint32_t debounce_us;
+
+    input_event_t queue[INPUT_QUEUE_SIZE];
+    uint32_t head; // escrito só pelo produtor
+    uint32_t tail; // escrito só pelo consumidor
+    uint32_t dropped; // eventos perdidos com a fila cheia
+} input_t;
+
+// levels: nível atual de cada pino, usado como estado inicial
+void input_init(input_t *in, input_pin_t *pins, size_t pin_count, uint32_t debounce_us, const bool *levels);
+
+// Índice do pino com esse gpio, ou -1
+int input_find(const input_t *in, uint8_t gpio);
+
+void input_edge(input_t *in, size_t index, bool level, uint32_t now_us);
+
+// Confirma os pinos estáveis há debounce_us e enfileira as mudanças.
+// Retorna em quantos us chamar de novo, ou 0 se nenhum pino está pendente.
+uint32_t input_poll(input_t *in, uint32_t now_us);
+
+bool input_pop(input_t *in, input_event_t *event);
+
+#endif
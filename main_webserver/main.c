@@ -3,104 +3,1183 @@
 #include "lwip/tcp.h"
 #include <string.h>
 #include <stdio.h>
+#include <strings.h>
 #include <stdbool.h>
+#include <stdlib.h>
 #include "hardware/adc.h"
+#include "hardware/dma.h"
+#include "hardware/clocks.h"
+#include "pico/rand.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "static_alloc.h"
+
+#include "assets.h"
+#include "routes.h"
+#include "adc_stats.h"
+#include "fixed_point.h"
+#include "http_format.h"
+#include "input.h"
+#include "websocket.h"
 
 #define BUTTON1_PIN 5
 #define BUTTON2_PIN 6
-#define LIMIAR_VARIACAO_TEMPERATURA 0.5f
+// Tempo sem bordas para um botão mudar de estado
+#define BUTTON_DEBOUNCE_US 20000
+// Em m°C
+#define LIMIAR_VARIACAO_TEMPERATURA 500
 
 #define WIFI_SSID "Arnaldojr"
 #define WIFI_PASS "12345678"
 
+// 1: a página vai em fragmentos constantes, por referência (sem cópia), e só
+//    os trechos variáveis (estado dos botões e temperatura) são copiados.
+// 0: snprintf da página inteira no buffer da conexão, copiada de novo no tcp_write.
+#define PAGE_ZERO_COPY 1
+
+// A cada quantas respostas imprimir a média de ciclos
+#define RESPONSE_STATS_EVERY 10
+
+// Período em que a tarefa de sensores lê as amostras novas do ADC
+#define SAMPLE_PERIOD_MS 100
+
+// ADC contínuo no sensor de temperatura: taxa, janela das estatísticas
+// (mín/máx/média) e suavização da EMA (alfa = 1/2^ADC_EMA_SHIFT)
+#define ADC_SAMPLE_HZ 1000
+#define ADC_WINDOW_SAMPLES 1000
+#define ADC_EMA_SHIFT 8
+// Anel do DMA: 2^ADC_RING_BITS bytes (256 amostras, mais que um
+// SAMPLE_PERIOD_MS de folga)
+#define ADC_RING_BITS 9
+// Com FREERTOS_SMP (freertos/CMakeLists.txt) as tarefas que usam a rede
+// ficam no NETWORK_CORE, onde o cyw43_arch_init() deixou o cyw43 e o lwIP, e
+// a agregação do ADC vai para uma tarefa no ADC_CORE
+#define NETWORK_CORE 0
+#define ADC_CORE 1
+
+// A cada quantas medidas imprimir p50/p99 das latências
+#define LATENCY_REPORT_EVERY 20
+
+// Conexões HTTP comuns ao mesmo tempo; as demais recebem 503
+#define HTTP_MAX_CONNECTIONS 8
+// Conexão sem atividade por mais que isso é fechada
+#define HTTP_IDLE_TIMEOUT_S 10
+// Buffer de recepção de cada conexão: o cabeçalho de uma requisição tem que
+// caber inteiro; o que sobrar são as próximas requisições (pipeline)
+#define HTTP_REQUEST_SIZE 1024
+
+// Navegadores com /events aberto ao mesmo tempo
+#define SSE_MAX_CLIENTS 4
+// Comentário enviado quando não há eventos, para detectar cliente que sumiu
+#define SSE_PING_MS 15000
+
+// Conexões WebSocket (/ws) ao mesmo tempo
+#define WS_MAX_CLIENTS 4
+// A cada quantos comandos imprimir a latência comando -> LED
+#define WS_STATS_EVERY 20
+
 char button1_message[50] = "Nenhum evento no botão 1";
 char button2_message[50] = "Nenhum evento no botão 2";
-char temperature_message[50] = "Temperatura: 0.00 °C";
-char http_response[2024];
+char temperature_message[64] = "Temperatura: 0.00 °C";
 
 bool button1_pressed = false;
 bool button2_pressed = false;
 
+// Muda sempre que uma das mensagens muda; vira o ETag da página junto com um
+// número sorteado no boot (o contador recomeça do zero a cada boot)
+uint32_t page_version = 0;
+uint32_t page_boot_id;
 
-float ler_temperatura() {
-    /* Conversão de 12-bit, valor máximo = ADC_VREF = 3.3V */
-    const float fator_conversao = 3.3f / (1 << 12);
 
-    float adc = (float)adc_read() * fator_conversao;
-    float temperatura = 27.0f - (adc - 0.706f) / 0.001721f;
-    
-    return temperatura;
+// Sensor interno de temperatura (datasheet do RP2040): 0,706 V a 27 °C e
+// -1,721 mV/°C, lido pelo ADC de 12 bits com referência de 3,3 V. As
+// constantes viram inteiros em tempo de compilação (fixed_point.h).
+#define ADC_VREF 3.3
+#define TEMP_SENSOR_V27 0.706
+#define TEMP_SENSOR_SLOPE 0.001721
+
+static const fixed_linear_t temperature_line =
+    FIXED_LINEAR(27.0 + TEMP_SENSOR_V27 / TEMP_SENSOR_SLOPE, -(ADC_VREF / 4096) / TEMP_SENSOR_SLOPE);
+
+// 1: mede na inicialização os ciclos da conversão + formatação em float
+//    (como era antes) e em ponto fixo, e imprime no serial.
+#define FIXED_POINT_BENCHMARK 0
+
+// 1: ao iniciar o scheduler, mede os ciclos de uma troca de contexto entre
+//    uma tarefa na prioridade mais alta e outra na 1 e imprime no serial
+//    (comparar configMAX_PRIORITIES e configUSE_PORT_OPTIMISED_TASK_SELECTION)
+#define CONTEXT_SWITCH_BENCHMARK 0
+
+
+typedef struct {
+    const char *data;
+    uint16_t len;
+    bool copy; // trecho variável, copiado no tcp_write
+} page_part_t;
+
+#if PAGE_ZERO_COPY
+#define PAGE_PARTS 16
+#else
+#define PAGE_PARTS 3 // página inteira; cabeçalho + arquivo de www/; 304
+#endif
+
+// "\"xxxxxxxx-4294967295\""
+#define ETAG_SIZE 24
+
+// Últimas LATENCY_SAMPLES medidas de uma latência, para p50/p99
+#define LATENCY_SAMPLES 64
+
+typedef struct {
+    uint32_t samples[LATENCY_SAMPLES];
+    uint32_t count;
+} latency_t;
+
+static void latency_add(latency_t *latency, uint32_t us) {
+    latency->samples[latency->count++ % LATENCY_SAMPLES] = us;
 }
 
+static void latency_report(const latency_t *latency, const char *name) {
+    uint32_t sorted[LATENCY_SAMPLES];
+    uint32_t n = latency->count < LATENCY_SAMPLES ? latency->count : LATENCY_SAMPLES;
 
-void create_http_response() {
-    snprintf(http_response, sizeof(http_response),
-        "HTTP/1.1 200 OK\r\nContent-Type: text/html; charset=UTF-8\r\n\r\n"
+    // Inserção: poucas amostras, e só na hora de imprimir
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t v = latency->samples[i];
+        uint32_t j = i;
+        for (; j > 0 && sorted[j - 1] > v; j--) {
+            sorted[j] = sorted[j - 1];
+        }
+        sorted[j] = v;
+    }
+    if (n) {
+        printf("%s: p50 %lu us, p99 %lu us (%lu amostras)\n", name, sorted[n / 2], sorted[n * 99 / 100], n);
+    }
+}
+
+// --- Conexões HTTP --------------------------------------------------------
+//
+// Cada conexão tem um estado próprio, tirado de um pool fixo. A resposta é
+// uma lista de partes enviada aos poucos: só o que cabe em tcp_sndbuf() vai
+// para o lwIP, e o resto sai no tcp_sent() (ou no tcp_poll(), se o lwIP
+// ficou sem memória). Enquanto uma resposta não terminou, requisições novas
+// na mesma conexão ficam no lwIP (recv retorna ERR_MEM e ele entrega de novo
+// depois), o que também segura a janela TCP do cliente.
+
+typedef struct {
+    struct tcp_pcb *pcb;
+    page_part_t parts[PAGE_PARTS];
+    uint8_t count;   // partes da resposta atual
+    uint8_t next;    // próxima parte a enviar
+    uint16_t offset; // bytes já enviados da parte atual
+    uint8_t idle_s;
+    bool close_after;
+    uint32_t request_us; // chegada da requisição, para a latência
+    uint32_t rx_us;      // chegada do último segmento
+    char request[HTTP_REQUEST_SIZE]; // recebido e ainda não atendido, com '\0' no fim
+    uint16_t request_len;
+    char etag[ETAG_SIZE];
+    // Cópia do estado no momento da requisição: a resposta pode levar vários
+    // tcp_sent() para sair e as mensagens globais podem mudar no meio
+#if PAGE_ZERO_COPY
+    char content_length[10];
+    char button1_message[50];
+    char button2_message[50];
+    char temperature_message[64];
+#else
+    char response[2024];
+#endif
+} http_conn_t;
+
+static http_conn_t http_conns[HTTP_MAX_CONNECTIONS];
+static latency_t request_latency;
+
+#if PAGE_ZERO_COPY
+#define PAGE_STATIC(s) ((page_part_t){(s), sizeof(s) - 1, false})
+
+static const char page_header[] = "HTTP/1.1 200 OK\r\nContent-Type: text/html; charset=UTF-8\r\nContent-Length: ";
+static const char page_etag[] = "\r\nCache-Control: no-cache\r\nETag: ";
+static const char page_header_end[] = "\r\n\r\n";
+
+static const char page_begin[] =
+    "<!DOCTYPE html>"
+    "<html lang=\"pt\">"
+    "<head>"
+    "  <meta charset=\"UTF-8\">"
+    "  <meta name=\"viewport\" content=\"width=device-width, initial-scale=1.0\">"
+    "  <title>Pico W - Controle de LED</title>"
+    "  <link rel=\"stylesheet\" href=\"/style.css\">"
+    "</head>"
+    "<body>"
+    "  <h1>Interface WebServer - Pico W</h1>"
+    "  <a href=\"/led/on\" class=\"button\" onclick=\"return led(1)\">Ligar LED</a>"
+    "  <a href=\"/led/off\" class=\"button\" onclick=\"return led(0)\">Desligar LED</a>"
+    "  <div class=\"status\">"
+    "    <h2>Estado dos Botões:</h2>"
+    "    <p>Botão 1: <span id=\"b1\" class=\"";
+static const char page_class_end[] = "\">";
+static const char page_button2[] = "</span></p>"
+                                   "    <p>Botão 2: <span id=\"b2\" class=\"";
+static const char page_temperature[] = "</span></p>"
+                                       "    <h2>Temperatura Atual:</h2>"
+                                       "    <p id=\"temp\">";
+static const char page_end[] = "</p>"
+                               "  </div>"
+                               "  <script src=\"/app.js\"></script>"
+                               "</body>"
+                               "</html>\r\n";
+
+static const char class_on[] = "on";
+static const char class_off[] = "off";
+
+static page_part_t page_dynamic(char *copy, size_t size, const char *s) {
+    strncpy(copy, s, size - 1);
+    copy[size - 1] = '\0';
+    return (page_part_t){copy, strlen(copy), true};
+}
+
+// Monta a lista de fragmentos da resposta. Só o Content-Length é formatado;
+// as mensagens são copiadas para a conexão.
+static void create_http_response(http_conn_t *conn) {
+    page_part_t *parts = conn->parts;
+    int n = 0;
+    parts[n++] = PAGE_STATIC(page_header);
+    int length_part = n++;
+    parts[n++] = PAGE_STATIC(page_etag);
+    parts[n++] = (page_part_t){conn->etag, strlen(conn->etag), true};
+    parts[n++] = PAGE_STATIC(page_header_end);
+
+    int body = n;
+    parts[n++] = PAGE_STATIC(page_begin);
+    parts[n++] = button1_pressed ? PAGE_STATIC(class_on) : PAGE_STATIC(class_off);
+    parts[n++] = PAGE_STATIC(page_class_end);
+    parts[n++] = page_dynamic(conn->button1_message, sizeof(conn->button1_message), button1_message);
+    parts[n++] = PAGE_STATIC(page_button2);
+    parts[n++] = button2_pressed ? PAGE_STATIC(class_on) : PAGE_STATIC(class_off);
+    parts[n++] = PAGE_STATIC(page_class_end);
+    parts[n++] = page_dynamic(conn->button2_message, sizeof(conn->button2_message), button2_message);
+    parts[n++] = PAGE_STATIC(page_temperature);
+    parts[n++] = page_dynamic(conn->temperature_message, sizeof(conn->temperature_message), temperature_message);
+    parts[n++] = PAGE_STATIC(page_end);
+
+    uint32_t body_length = 0;
+    for (int i = body; i < n; i++) {
+        body_length += parts[i].len;
+    }
+    parts[length_part] =
+        (page_part_t){conn->content_length, http_format_uint(conn->content_length, body_length), true};
+    conn->count = n;
+}
+#else
+// Sem Content-Length: o fim da resposta é o fechamento da conexão
+static void create_http_response(http_conn_t *conn) {
+    int len = snprintf(conn->response, sizeof(conn->response),
+        "HTTP/1.1 200 OK\r\nContent-Type: text/html; charset=UTF-8\r\n"
+        "Cache-Control: no-cache\r\nETag: %s\r\n\r\n"
         "<!DOCTYPE html>"
         "<html lang=\"pt\">"
         "<head>"
-        "  <meta http-equiv=\"refresh\" content=\"1\">" 
         "  <meta charset=\"UTF-8\">"
         "  <meta name=\"viewport\" content=\"width=device-width, initial-scale=1.0\">"
         "  <title>Pico W - Controle de LED</title>"
-        "  <style>"
-        "    body { font-family: Arial, sans-serif; text-align: center; padding: 20px; background-color: #f0f0f0; }"
-        "    h1 { color: #333; }"
-        "    .button { display: inline-block; padding: 10px 20px; margin: 10px; font-size: 16px; color: white; background-color: #007BFF; border: none; border-radius: 5px; text-decoration: none; }"
-        "    .button:hover { background-color: #0056b3; }"
-        "    .status { margin-top: 20px; font-size: 18px; }"
-        "    .on { color: green; font-weight: bold; }"
-        "    .off { color: red; font-weight: bold; }"
-        "  </style>"
-        "  <script>"
-        "    setTimeout(() => { location.reload(); }, 1000);"
-        "  </script>"
+        "  <link rel=\"stylesheet\" href=\"/style.css\">"
         "</head>"
         "<body>"
         "  <h1>Interface WebServer - Pico W</h1>"
-        "  <a href=\"/led/on\" class=\"button\">Ligar LED</a>"
-        "  <a href=\"/led/off\" class=\"button\">Desligar LED</a>"
+        "  <a href=\"/led/on\" class=\"button\" onclick=\"return led(1)\">Ligar LED</a>"
+        "  <a href=\"/led/off\" class=\"button\" onclick=\"return led(0)\">Desligar LED</a>"
         "  <div class=\"status\">"
         "    <h2>Estado dos Botões:</h2>"
-        "    <p>Botão 1: <span class=\"%s\">%s</span></p>"
-        "    <p>Botão 2: <span class=\"%s\">%s</span></p>"
+        "    <p>Botão 1: <span id=\"b1\" class=\"%s\">%s</span></p>"
+        "    <p>Botão 2: <span id=\"b2\" class=\"%s\">%s</span></p>"
         "    <h2>Temperatura Atual:</h2>"
-        "    <p>%s</p>"
+        "    <p id=\"temp\">%s</p>"
         "  </div>"
+        "  <script src=\"/app.js\"></script>"
         "</body>"
         "</html>\r\n",
+        conn->etag,
         button1_pressed ? "on" : "off", button1_message,
         button2_pressed ? "on" : "off", button2_message,
         temperature_message);
+    if (len >= (int)sizeof(conn->response)) {
+        len = sizeof(conn->response) - 1;
+    }
+    conn->parts[0] = (page_part_t){conn->response, len, true};
+    conn->count = 1;
+    conn->close_after = true;
 }
+#endif
 
-static err_t http_callback(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err) {
+// Ciclos de CPU gastos montando e enfileirando cada resposta
+static void account_response(uint32_t elapsed_us, uint32_t copied) {
+    static uint64_t total_us;
+    static uint32_t total_copied;
+    static uint32_t responses;
+
+    total_us += elapsed_us;
+    total_copied += copied;
+    if (++responses == RESPONSE_STATS_EVERY) {
+        uint32_t mhz = clock_get_hz(clk_sys) / 1000000;
+        printf("Resposta: %lu ciclos em media, %lu bytes copiados (%s)\n",
+               (uint32_t)(total_us * mhz / responses), total_copied / responses,
+               PAGE_ZERO_COPY ? "fragmentos sem copia" : "snprintf + copia");
+        total_us = 0;
+        total_copied = 0;
+        responses = 0;
+    }
+}
+
+// Respostas da página: completas (200) ou só cabeçalho (304)
+static void account_page(bool not_modified) {
+    static uint32_t full, not_modified_count;
+
+    if (not_modified) {
+        not_modified_count++;
+    } else {
+        full++;
+    }
+    if ((full + not_modified_count) % RESPONSE_STATS_EVERY == 0) {
+        printf("Pagina: %lu respostas 200, %lu respostas 304\n", full, not_modified_count);
+    }
+}
+
+// --- Eventos --------------------------------------------------------------
+//
+// Cada mudança de botão ou temperatura vira um JSON de algumas dezenas de
+// bytes, {"e":"b1","c":"on","m":"..."}, enviado a todos os clientes de
+// /events (SSE) e de /ws (WebSocket).
+
+#define EVENT_BUTTON1 0
+#define EVENT_BUTTON2 1
+#define EVENT_TEMPERATURE 2
+#define EVENT_COUNT 3
+#define EVENT_SIZE 128
+
+static int format_event(char *buf, size_t size, int event) {
+    switch (event) {
+    case EVENT_BUTTON1:
+        return snprintf(buf, size, "{\"e\":\"b1\",\"c\":\"%s\",\"m\":\"%s\"}", button1_pressed ? "on" : "off",
+                        button1_message);
+    case EVENT_BUTTON2:
+        return snprintf(buf, size, "{\"e\":\"b2\",\"c\":\"%s\",\"m\":\"%s\"}", button2_pressed ? "on" : "off",
+                        button2_message);
+    default:
+        return snprintf(buf, size, "{\"e\":\"temp\",\"m\":\"%s\"}", temperature_message);
+    }
+}
+
+static const char http_busy[] = "HTTP/1.1 503 Service Unavailable\r\n"
+                                "Content-Length: 0\r\n"
+                                "Connection: close\r\n"
+                                "\r\n";
+
+// Responde 503 e fecha. Se o fechamento falhar, aborta: o pcb não tem mais
+// dono e ficaria aberto para sempre. ERR_ABRT deve ser devolvido ao lwIP
+// pelo callback que chamou.
+static err_t reject_busy(struct tcp_pcb *tpcb) {
+    if (tcp_write(tpcb, http_busy, sizeof(http_busy) - 1, 0) == ERR_OK) {
+        tcp_output(tpcb);
+    }
+    if (tcp_close(tpcb) != ERR_OK) {
+        tcp_abort(tpcb);
+        return ERR_ABRT;
+    }
+    return ERR_OK;
+}
+
+// --- Server-Sent Events ---------------------------------------------------
+//
+// GET /events fica aberto e recebe cada evento como "data: <json>\n\n".
+
+static struct tcp_pcb *sse_clients[SSE_MAX_CLIENTS];
+// O evento não coube no buffer de envio; manda o estado completo quando couber
+static bool sse_resync[SSE_MAX_CLIENTS];
+static uint32_t sse_last_send_ms;
+
+static const char sse_header[] = "HTTP/1.1 200 OK\r\n"
+                                 "Content-Type: text/event-stream\r\n"
+                                 "Cache-Control: no-cache\r\n"
+                                 "Connection: keep-alive\r\n"
+                                 "\r\n";
+
+static err_t sse_close(int i) {
+    struct tcp_pcb *pcb = sse_clients[i];
+    sse_clients[i] = NULL;
+    tcp_arg(pcb, NULL);
+    tcp_recv(pcb, NULL);
+    tcp_err(pcb, NULL);
+    if (tcp_close(pcb) != ERR_OK) {
+        tcp_abort(pcb);
+        return ERR_ABRT;
+    }
+    return ERR_OK;
+}
+
+static bool sse_send(int i, const char *data, int len) {
+    struct tcp_pcb *pcb = sse_clients[i];
+    if (len > tcp_sndbuf(pcb) || tcp_write(pcb, data, len, TCP_WRITE_FLAG_COPY) != ERR_OK) {
+        sse_resync[i] = true;
+        return false;
+    }
+    tcp_output(pcb);
+    return true;
+}
+
+static int sse_format(char *buf, size_t size, const char *json, int len) {
+    return snprintf(buf, size, "data: %.*s\n\n", len, json);
+}
+
+static void sse_send_state(int i) {
+    char json[EVENT_SIZE];
+    char buf[EVENT_SIZE + 8];
+
+    sse_resync[i] = false;
+    for (int event = 0; event < EVENT_COUNT; event++) {
+        int len = format_event(json, sizeof(json), event);
+        if (!sse_send(i, buf, sse_format(buf, sizeof(buf), json, len))) {
+            return;
+        }
+    }
+}
+
+static int sse_broadcast(const char *json, int len) {
+    char buf[EVENT_SIZE + 8];
+    int clients = 0;
+
+    len = sse_format(buf, sizeof(buf), json, len);
+    for (int i = 0; i < SSE_MAX_CLIENTS; i++) {
+        if (sse_clients[i] && !sse_resync[i]) {
+            sse_send(i, buf, len);
+            clients++;
+        }
+    }
+    sse_last_send_ms = to_ms_since_boot(get_absolute_time());
+    return clients;
+}
+
+// Chamado no laço principal: reenvia o estado a quem ficou para trás e
+// mantém as conexões ociosas vivas
+static void sse_poll(void) {
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    bool ping = now - sse_last_send_ms >= SSE_PING_MS;
+
+    for (int i = 0; i < SSE_MAX_CLIENTS; i++) {
+        if (!sse_clients[i]) {
+            continue;
+        }
+        if (sse_resync[i]) {
+            sse_send_state(i);
+        } else if (ping) {
+            sse_send(i, ":\n\n", 3);
+        }
+    }
+    if (ping) {
+        sse_last_send_ms = now;
+    }
+}
+
+static err_t sse_recv_callback(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err) {
+    int i = (struct tcp_pcb **)arg - sse_clients;
     if (p == NULL) {
-        tcp_close(tpcb);
-        return ERR_OK;
+        return sse_close(i);
+    }
+    // O navegador não manda nada depois do GET; descarta
+    tcp_recved(tpcb, p->tot_len);
+    pbuf_free(p);
+    return ERR_OK;
+}
+
+static void sse_err_callback(void *arg, err_t err) {
+    // O lwIP já liberou o pcb
+    *(struct tcp_pcb **)arg = NULL;
+}
+
+static err_t sse_accept(struct tcp_pcb *tpcb) {
+    for (int i = 0; i < SSE_MAX_CLIENTS; i++) {
+        if (!sse_clients[i]) {
+            sse_clients[i] = tpcb;
+            tcp_arg(tpcb, &sse_clients[i]);
+            tcp_recv(tpcb, sse_recv_callback);
+            tcp_err(tpcb, sse_err_callback);
+            tcp_write(tpcb, sse_header, sizeof(sse_header) - 1, 0);
+            sse_send_state(i);
+            printf("SSE: cliente %d conectado\n", i);
+            return ERR_OK;
+        }
+    }
+    return reject_busy(tpcb);
+}
+
+// --- WebSocket ------------------------------------------------------------
+//
+// GET /ws com "Upgrade: websocket" vira uma conexão WebSocket (RFC 6455).
+// O navegador manda "led:0" / "led:1" (opcionalmente ":<seq>") e recebe os
+// mesmos eventos do SSE como frames de texto. Cada comando é respondido com
+// {"e":"ack","seq":"<seq>","us":N}, onde N é o tempo entre a chegada do
+// frame e o LED mudar (python/ws_bench.py mede a ida e volta).
+
+typedef struct {
+    struct tcp_pcb *pcb;
+    ws_parser_t parser;
+    uint32_t rx_us; // chegada do segmento sendo processado
+    bool closing;
+} ws_client_t;
+
+static ws_client_t ws_clients[WS_MAX_CLIENTS];
+
+static err_t ws_close(ws_client_t *client) {
+    struct tcp_pcb *pcb = client->pcb;
+    client->pcb = NULL;
+    tcp_arg(pcb, NULL);
+    tcp_recv(pcb, NULL);
+    tcp_err(pcb, NULL);
+    if (tcp_close(pcb) != ERR_OK) {
+        tcp_abort(pcb);
+        return ERR_ABRT;
+    }
+    return ERR_OK;
+}
+
+static err_t ws_send(ws_client_t *client, uint8_t opcode, const void *data, size_t len) {
+    uint8_t header[WS_MAX_HEADER];
+    size_t header_len = ws_frame_header(header, opcode, len);
+
+    if (header_len + len > tcp_sndbuf(client->pcb)) {
+        return ERR_MEM;
+    }
+    err_t err = tcp_write(client->pcb, header, header_len, TCP_WRITE_FLAG_COPY | (len ? TCP_WRITE_FLAG_MORE : 0));
+    if (err == ERR_OK && len) {
+        err = tcp_write(client->pcb, data, len, TCP_WRITE_FLAG_COPY);
+    }
+    if (err == ERR_OK) {
+        err = tcp_output(client->pcb);
+    }
+    return err;
+}
+
+static int ws_broadcast(const char *json, int len) {
+    int clients = 0;
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+        if (ws_clients[i].pcb && !ws_clients[i].closing) {
+            ws_send(&ws_clients[i], WS_OPCODE_TEXT, json, len);
+            clients++;
+        }
     }
+    return clients;
+}
 
-    char *request = (char *)p->payload;
+// Latência comando -> LED (o LED da Pico W fica no chip Wi-Fi, então o
+// cyw43_arch_gpio_put inclui uma transação SPI)
+static void account_led_latency(uint32_t us) {
+    static uint32_t count, total, min_us = UINT32_MAX, max_us;
 
-    if (strstr(request, "GET /led/on")) {
-        cyw43_arch_gpio_put(CYW43_WL_GPIO_LED_PIN, 1);
-        printf("LED ligado\n");
-    } else if (strstr(request, "GET /led/off")) {
-        cyw43_arch_gpio_put(CYW43_WL_GPIO_LED_PIN, 0);
-        printf("LED desligado\n");
+    total += us;
+    min_us = us < min_us ? us : min_us;
+    max_us = us > max_us ? us : max_us;
+    if (++count == WS_STATS_EVERY) {
+        printf("WS: comando -> LED em %lu us (min %lu, max %lu)\n", total / count, min_us, max_us);
+        count = 0;
+        total = 0;
+        min_us = UINT32_MAX;
+        max_us = 0;
     }
+}
 
-    create_http_response();
-    tcp_write(tpcb, http_response, strlen(http_response), TCP_WRITE_FLAG_COPY);
+static void ws_command(ws_client_t *client, const char *cmd, size_t len) {
+    if (len < 5 || memcmp(cmd, "led:", 4) != 0 || (cmd[4] != '0' && cmd[4] != '1')) {
+        return;
+    }
+    cyw43_arch_gpio_put(CYW43_WL_GPIO_LED_PIN, cmd[4] == '1');
+    uint32_t latency = time_us_32() - client->rx_us;
+
+    const char *seq = len > 6 && cmd[5] == ':' ? cmd + 6 : cmd + len;
+    char ack[64];
+    int n = snprintf(ack, sizeof(ack), "{\"e\":\"ack\",\"seq\":\"%.*s\",\"us\":%lu}", (int)(cmd + len - seq), seq,
+                     latency);
+    ws_send(client, WS_OPCODE_TEXT, ack, n);
+    account_led_latency(latency);
+}
+
+static void ws_on_frame(ws_parser_t *parser, uint8_t opcode, const uint8_t *payload, size_t len) {
+    ws_client_t *client = (ws_client_t *)parser->arg;
+
+    switch (opcode) {
+    case WS_OPCODE_TEXT:
+        ws_command(client, (const char *)payload, len);
+        break;
+    case WS_OPCODE_PING:
+        ws_send(client, WS_OPCODE_PONG, payload, len);
+        break;
+    case WS_OPCODE_CLOSE:
+        // Devolve o código recebido e fecha depois deste segmento
+        ws_send(client, WS_OPCODE_CLOSE, payload, len >= 2 ? 2 : 0);
+        client->closing = true;
+        break;
+    default:
+        break;
+    }
+}
+
+static err_t ws_recv_callback(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err) {
+    ws_client_t *client = (ws_client_t *)arg;
+    if (p == NULL) {
+        return ws_close(client);
+    }
+
+    client->rx_us = time_us_32();
+    bool ok = true;
+    for (struct pbuf *q = p; q != NULL && ok && !client->closing; q = q->next) {
+        ok = ws_parser_execute(&client->parser, q->payload, q->len);
+    }
+    tcp_recved(tpcb, p->tot_len);
     pbuf_free(p);
+
+    if (!ok) {
+        uint8_t code[2] = {client->parser.close_code >> 8, client->parser.close_code & 0xff};
+        ws_send(client, WS_OPCODE_CLOSE, code, sizeof(code));
+        return ws_close(client);
+    }
+    if (client->closing) {
+        return ws_close(client);
+    }
     return ERR_OK;
 }
 
-static err_t connection_callback(void *arg, struct tcp_pcb *newpcb, err_t err) {
-    tcp_recv(newpcb, http_callback);
+static void ws_err_callback(void *arg, err_t err) {
+    // O lwIP já liberou o pcb
+    ((ws_client_t *)arg)->pcb = NULL;
+}
+
+// Valor de um cabeçalho (sem diferenciar maiúsculas no nome); *len recebe o
+// tamanho até o fim da linha
+static const char *find_header(const char *request, const char *name, size_t *len) {
+    size_t name_len = strlen(name);
+    for (const char *line = strchr(request, '\n'); line != NULL; line = strchr(line, '\n')) {
+        line++;
+        if (strncasecmp(line, name, name_len) == 0 && line[name_len] == ':') {
+            const char *value = line + name_len + 1;
+            while (*value == ' ') {
+                value++;
+            }
+            *len = strcspn(value, "\r\n");
+            return value;
+        }
+    }
+    return NULL;
+}
+
+// Procura token (sem diferenciar maiúsculas) no valor devolvido por find_header
+static bool value_contains(const char *value, size_t len, const char *token) {
+    size_t token_len = strlen(token);
+    for (size_t i = 0; value && i + token_len <= len; i++) {
+        if (strncasecmp(value + i, token, token_len) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static err_t ws_accept(struct tcp_pcb *tpcb, const char *request) {
+    size_t key_len;
+    const char *key = find_header(request, "Sec-WebSocket-Key", &key_len);
+    if (!key) {
+        return reject_busy(tpcb);
+    }
+
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+        ws_client_t *client = &ws_clients[i];
+        if (client->pcb) {
+            continue;
+        }
+
+        char accept[WS_ACCEPT_SIZE];
+        char response[160];
+        ws_accept_key(key, key_len, accept);
+        int len = snprintf(response, sizeof(response),
+                           "HTTP/1.1 101 Switching Protocols\r\n"
+                           "Upgrade: websocket\r\n"
+                           "Connection: Upgrade\r\n"
+                           "Sec-WebSocket-Accept: %s\r\n"
+                           "\r\n",
+                           accept);
+
+        client->pcb = tpcb;
+        client->closing = false;
+        ws_parser_init(&client->parser, ws_on_frame, client);
+        tcp_arg(tpcb, client);
+        tcp_recv(tpcb, ws_recv_callback);
+        tcp_err(tpcb, ws_err_callback);
+        tcp_nagle_disable(tpcb); // frames pequenos, latência importa
+        tcp_write(tpcb, response, len, TCP_WRITE_FLAG_COPY);
+
+        char json[EVENT_SIZE];
+        for (int event = 0; event < EVENT_COUNT; event++) {
+            ws_send(client, WS_OPCODE_TEXT, json, format_event(json, sizeof(json), event));
+        }
+        printf("WS: cliente %d conectado\n", i);
+        return ERR_OK;
+    }
+    return reject_busy(tpcb);
+}
+
+// Manda o evento para os clientes de /events e de /ws
+static void publish_event(int event) {
+    char json[EVENT_SIZE];
+    int len = format_event(json, sizeof(json), event);
+    int clients = sse_broadcast(json, len) + ws_broadcast(json, len);
+    if (clients) {
+        printf("Evento de %d bytes para %d cliente(s)\n", len, clients);
+    }
+}
+
+static err_t http_conn_close(http_conn_t *conn) {
+    struct tcp_pcb *pcb = conn->pcb;
+    conn->pcb = NULL;
+    tcp_arg(pcb, NULL);
+    tcp_recv(pcb, NULL);
+    tcp_sent(pcb, NULL);
+    tcp_poll(pcb, NULL, 0);
+    tcp_err(pcb, NULL);
+    if (tcp_close(pcb) != ERR_OK) {
+        tcp_abort(pcb);
+        return ERR_ABRT;
+    }
     return ERR_OK;
 }
 
+// A conexão passa para /events ou /ws, que registram os próprios callbacks.
+// Todos os callbacks saem daqui: se /events ou /ws recusar o pcb, ele fecha
+// sem apontar para este slot, que já pode ter outro cliente.
+static void http_conn_release(http_conn_t *conn) {
+    struct tcp_pcb *pcb = conn->pcb;
+    conn->pcb = NULL;
+    conn->request_len = 0;
+    tcp_arg(pcb, NULL);
+    tcp_recv(pcb, NULL);
+    tcp_sent(pcb, NULL);
+    tcp_poll(pcb, NULL, 0);
+    tcp_err(pcb, NULL);
+}
+
+static bool http_conn_busy(const http_conn_t *conn) {
+    return conn->next < conn->count;
+}
+
+// Enfileira o que couber da resposta. Sem espaço (ou sem memória no lwIP),
+// para e continua no próximo tcp_sent()/tcp_poll().
+static err_t http_conn_send(http_conn_t *conn) {
+    struct tcp_pcb *pcb = conn->pcb;
+    bool queued = false;
+
+    while (http_conn_busy(conn)) {
+        const page_part_t *part = &conn->parts[conn->next];
+        uint16_t len = part->len - conn->offset;
+        uint16_t space = tcp_sndbuf(pcb);
+        if (space == 0 || tcp_sndqueuelen(pcb) >= TCP_SND_QUEUELEN) {
+            break;
+        }
+        if (len > space) {
+            len = space;
+        }
+
+        u8_t flags = part->copy ? TCP_WRITE_FLAG_COPY : 0;
+        if (conn->offset + len < part->len || conn->next + 1 < conn->count) {
+            flags |= TCP_WRITE_FLAG_MORE;
+        }
+        err_t err = tcp_write(pcb, part->data + conn->offset, len, flags);
+        if (err == ERR_MEM) {
+            break;
+        }
+        if (err != ERR_OK) {
+            return err;
+        }
+
+        queued = true;
+        conn->offset += len;
+        if (conn->offset == part->len) {
+            conn->next++;
+            conn->offset = 0;
+        }
+    }
+
+    if (queued) {
+        tcp_output(pcb);
+        if (!http_conn_busy(conn)) {
+            // Resposta inteira entregue ao lwIP
+            latency_add(&request_latency, time_us_32() - conn->request_us);
+            if (request_latency.count % LATENCY_REPORT_EVERY == 0) {
+                latency_report(&request_latency, "Requisicao -> resposta");
+            }
+        }
+    }
+    if (!http_conn_busy(conn) && conn->close_after) {
+        // Os dados já enfileirados saem antes do FIN
+        return http_conn_close(conn);
+    }
+    return ERR_OK;
+}
+
+static err_t http_conn_process(http_conn_t *conn);
+
+// Continua a resposta atual e, quando ela termina, atende a próxima
+// requisição que já estiver no buffer
+static err_t http_conn_continue(http_conn_t *conn) {
+    err_t err = http_conn_send(conn);
+    if (err != ERR_OK || conn->pcb == NULL) {
+        return err;
+    }
+    return http_conn_process(conn);
+}
+
+static err_t http_sent_callback(void *arg, struct tcp_pcb *tpcb, u16_t len) {
+    http_conn_t *conn = (http_conn_t *)arg;
+    conn->idle_s = 0;
+    return http_conn_continue(conn);
+}
+
+// Chamado pelo lwIP a cada segundo (tcp_poll com intervalo 2)
+static err_t http_poll_callback(void *arg, struct tcp_pcb *tpcb) {
+    http_conn_t *conn = (http_conn_t *)arg;
+    if (http_conn_busy(conn)) {
+        return http_conn_continue(conn);
+    }
+    if (++conn->idle_s >= HTTP_IDLE_TIMEOUT_S) {
+        return http_conn_close(conn);
+    }
+    return ERR_OK;
+}
+
+static void http_err_callback(void *arg, err_t err) {
+    // O lwIP já liberou o pcb
+    ((http_conn_t *)arg)->pcb = NULL;
+}
+
+// --- Arquivos estáticos ---------------------------------------------------
+//
+// CSS e JS da página vêm de www/ (assets.h). Quem manda "Accept-Encoding:
+// gzip" recebe os bytes comprimidos direto da flash; os outros, o original.
+
+static const asset_t *find_asset(const char *path, size_t len) {
+    for (size_t i = 0; i < asset_count; i++) {
+        if (strlen(assets[i].path) == len && memcmp(assets[i].path, path, len) == 0) {
+            return &assets[i];
+        }
+    }
+    return NULL;
+}
+
+// Parâmetros de um item de Accept-Encoding (o que vem depois da codificação,
+// ";q=0.5"): falso só com q=0 (0, 0.0, 0.00, 0.000), que é uma recusa
+static bool coding_accepted(const char *p, const char *end) {
+    while (p < end) {
+        if (*p++ != ';') {
+            continue;
+        }
+        while (p < end && (*p == ' ' || *p == '\t')) {
+            p++;
+        }
+        if (end - p < 2 || (*p != 'q' && *p != 'Q') || p[1] != '=') {
+            continue;
+        }
+        p += 2;
+        if (p == end || *p != '0') {
+            return true;
+        }
+        p++;
+        if (p < end && *p == '.') {
+            p++;
+        }
+        for (; p < end && *p >= '0' && *p <= '9'; p++) {
+            if (*p != '0') {
+                return true;
+            }
+        }
+        return false;
+    }
+    return true;
+}
+
+// "gzip, deflate;q=0.5, *;q=0": um item gzip (ou x-gzip) decide; sem ele,
+// vale o "*". Sem o cabeçalho, nada de gzip.
+static bool accepts_gzip(const char *request) {
+    size_t len;
+    const char *value = find_header(request, "Accept-Encoding", &len);
+    if (!value) {
+        return false;
+    }
+
+    const char *end = value + len;
+    int gzip = -1, any = -1;
+    for (const char *item = value; item < end;) {
+        const char *item_end = memchr(item, ',', end - item);
+        if (!item_end) {
+            item_end = end;
+        }
+        while (item < item_end && (*item == ' ' || *item == '\t')) {
+            item++;
+        }
+        const char *coding_end = item;
+        while (coding_end < item_end && *coding_end != ';' && *coding_end != ' ' && *coding_end != '\t') {
+            coding_end++;
+        }
+
+        size_t coding_len = coding_end - item;
+        bool accepted = coding_accepted(coding_end, item_end);
+        if ((coding_len == 4 && strncasecmp(item, "gzip", 4) == 0) ||
+            (coding_len == 6 && strncasecmp(item, "x-gzip", 6) == 0)) {
+            gzip = accepted;
+        } else if (coding_len == 1 && *item == '*') {
+            any = accepted;
+        }
+        item = item_end + 1;
+    }
+    return gzip >= 0 ? gzip : any == 1;
+}
+
+static void create_asset_response(http_conn_t *conn, const asset_t *asset, bool gzip) {
+    if (gzip) {
+        conn->parts[0] = (page_part_t){asset->gzip_header, asset->gzip_header_len, false};
+        conn->parts[1] = (page_part_t){(const char *)asset->gzip_data, asset->gzip_len, false};
+    } else {
+        conn->parts[0] = (page_part_t){asset->header, asset->header_len, false};
+        conn->parts[1] = (page_part_t){(const char *)asset->data, asset->len, false};
+    }
+    conn->count = 2;
+    printf("%s: %u bytes%s\n", asset->path, conn->parts[1].len, gzip ? " (gzip)" : "");
+}
+
+// --- Requisição condicional ------------------------------------------------
+//
+// A página leva ETag e "Cache-Control: no-cache": o navegador guarda a cópia
+// e pergunta com If-None-Match antes de usar. Se nada mudou desde então, a
+// resposta é só o cabeçalho 304.
+
+static const char not_modified_header[] = "HTTP/1.1 304 Not Modified\r\n"
+                                          "Cache-Control: no-cache\r\n"
+                                          "ETag: ";
+static const char not_modified_end[] = "\r\n\r\n";
+
+static bool not_modified(const char *request, const char *etag) {
+    size_t len;
+    const char *value = find_header(request, "If-None-Match", &len);
+    return value_contains(value, len, etag);
+}
+
+static void create_not_modified_response(http_conn_t *conn) {
+    conn->parts[0] = (page_part_t){not_modified_header, sizeof(not_modified_header) - 1, false};
+    conn->parts[1] = (page_part_t){conn->etag, strlen(conn->etag), true};
+    conn->parts[2] = (page_part_t){not_modified_end, sizeof(not_modified_end) - 1, false};
+    conn->count = 3;
+}
+
+// Respostas sem corpo para requisições que não viram página
+static const char http_bad_request[] = "HTTP/1.1 400 Bad Request\r\n"
+                                       "Content-Length: 0\r\n"
+                                       "Connection: close\r\n"
+                                       "\r\n";
+static const char http_not_found[] = "HTTP/1.1 404 Not Found\r\n"
+                                     "Content-Length: 0\r\n"
+                                     "\r\n";
+static const char http_method_not_allowed[] = "HTTP/1.1 405 Method Not Allowed\r\n"
+                                              "Allow: GET\r\n"
+                                              "Content-Length: 0\r\n"
+                                              "\r\n";
+
+static err_t send_status(http_conn_t *conn, const char *response, uint16_t len) {
+    conn->parts[0] = (page_part_t){response, len, false};
+    conn->count = 1;
+    return http_conn_send(conn);
+}
+
+// Atende uma requisição: request é o cabeçalho inteiro, até a linha vazia,
+// terminado em '\0'
+static err_t http_handle_request(http_conn_t *conn, const char *request, uint16_t request_len) {
+    struct tcp_pcb *tpcb = conn->pcb;
+    conn->request_us = conn->rx_us;
+
+    // Só a linha de requisição é lida; rotas em routes.def
+    router_match_t match;
+    router_result_t routed = router_match(&routes_table, request, request_len, &match);
+
+    // HTTP/1.1 mantém a conexão salvo "Connection: close"; HTTP/1.0 fecha
+    // salvo "Connection: keep-alive". A versão vem da linha de requisição.
+    size_t connection_len;
+    const char *connection = find_header(request, "Connection", &connection_len);
+    conn->close_after = match.version_minor == 0 ? !(connection && strncasecmp(connection, "keep-alive", 10) == 0)
+                                                 : (connection && strncasecmp(connection, "close", 5) == 0);
+    conn->next = 0;
+    conn->offset = 0;
+
+    switch (routed) {
+    case ROUTER_OK:
+        break;
+    case ROUTER_BAD_REQUEST:
+        conn->close_after = true;
+        return send_status(conn, http_bad_request, sizeof(http_bad_request) - 1);
+    case ROUTER_METHOD_NOT_ALLOWED:
+        // Um corpo que viesse depois do cabeçalho seria lido como a próxima
+        // requisição
+        conn->close_after = true;
+        return send_status(conn, http_method_not_allowed, sizeof(http_method_not_allowed) - 1);
+    default:
+        return send_status(conn, http_not_found, sizeof(http_not_found) - 1);
+    }
+
+    switch (match.route) {
+    case ROUTE_EVENTS:
+        http_conn_release(conn);
+        return sse_accept(tpcb);
+
+    case ROUTE_WS: {
+        size_t upgrade_len;
+        const char *upgrade = find_header(request, "Upgrade", &upgrade_len);
+        if (!upgrade || strncasecmp(upgrade, "websocket", 9) != 0) {
+            conn->close_after = true;
+            return send_status(conn, http_bad_request, sizeof(http_bad_request) - 1);
+        }
+        http_conn_release(conn);
+        return ws_accept(tpcb, request);
+    }
+
+    case ROUTE_ASSET: {
+        const asset_t *asset = find_asset(match.path, match.path_len);
+        if (!asset) {
+            return send_status(conn, http_not_found, sizeof(http_not_found) - 1);
+        }
+        create_asset_response(conn, asset, accepts_gzip(request));
+        return http_conn_send(conn);
+    }
+
+    case ROUTE_LED: {
+        const router_param_t *state = &match.params[0];
+        if (state->len == 2 && memcmp(state->data, "on", 2) == 0) {
+            cyw43_arch_gpio_put(CYW43_WL_GPIO_LED_PIN, 1);
+            printf("LED ligado\n");
+        } else if (state->len == 3 && memcmp(state->data, "off", 3) == 0) {
+            cyw43_arch_gpio_put(CYW43_WL_GPIO_LED_PIN, 0);
+            printf("LED desligado\n");
+        } else {
+            return send_status(conn, http_not_found, sizeof(http_not_found) - 1);
+        }
+        break; // responde com a página
+    }
+
+    default:
+        break;
+    }
+
+    snprintf(conn->etag, sizeof(conn->etag), "\"%08lx-%lu\"", page_boot_id, page_version);
+    if (not_modified(request, conn->etag)) {
+        create_not_modified_response(conn);
+        account_page(true);
+        return http_conn_send(conn);
+    }
+
+    uint32_t start = time_us_32();
+    create_http_response(conn);
+    uint32_t copied = 0;
+    for (int i = 0; i < conn->count; i++) {
+        copied += conn->parts[i].copy ? conn->parts[i].len : 0;
+    }
+    err_t result = http_conn_send(conn);
+    account_response(time_us_32() - start, copied);
+    account_page(false);
+    return result;
+}
+
+// Tamanho da primeira requisição completa do buffer (até "\r\n\r\n"), 0 se
+// o cabeçalho ainda não chegou inteiro
+static uint16_t http_request_size(const http_conn_t *conn) {
+    const char *end = strstr(conn->request, "\r\n\r\n");
+    return end ? (uint16_t)(end + 4 - conn->request) : 0;
+}
+
+// Atende as requisições completas do buffer, uma de cada vez: a próxima só
+// começa quando a resposta da anterior foi toda para o lwIP. Chamado quando
+// chegam dados e quando uma resposta termina de sair.
+static err_t http_conn_process(http_conn_t *conn) {
+    uint16_t size;
+    while (conn->pcb && !http_conn_busy(conn) && !conn->close_after && (size = http_request_size(conn)) > 0) {
+        // Termina a requisição no fim do cabeçalho para find_header() não
+        // ler os cabeçalhos da seguinte
+        char next = conn->request[size];
+        conn->request[size] = '\0';
+        err_t err = http_handle_request(conn, conn->request, size);
+        if (conn->pcb == NULL) {
+            // Fechada ou passada para /events ou /ws
+            return err;
+        }
+        if (err != ERR_OK) {
+            return http_conn_close(conn);
+        }
+        conn->request[size] = next;
+        conn->request_len -= size;
+        memmove(conn->request, conn->request + size, conn->request_len + 1);
+    }
+    return ERR_OK;
+}
+
+static err_t http_callback(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err) {
+    http_conn_t *conn = (http_conn_t *)arg;
+    if (p == NULL) {
+        return http_conn_close(conn);
+    }
+
+    if (p->tot_len > sizeof(conn->request) - 1 - conn->request_len) {
+        if (http_request_size(conn) > 0) {
+            // Buffer ocupado por requisições em pipeline ainda não atendidas;
+            // o lwIP guarda p e tenta de novo
+            return ERR_MEM;
+        }
+        // O cabeçalho não cabe no buffer
+        tcp_recved(tpcb, p->tot_len);
+        pbuf_free(p);
+        conn->request_len = 0;
+        conn->close_after = true;
+        if (http_conn_busy(conn)) {
+            return ERR_OK; // fecha quando a resposta atual terminar
+        }
+        return send_status(conn, http_bad_request, sizeof(http_bad_request) - 1);
+    }
+
+    // O payload não é terminado e pode vir em mais de um pbuf; o cabeçalho
+    // pode vir em mais de um segmento
+    pbuf_copy_partial(p, conn->request + conn->request_len, p->tot_len, 0);
+    conn->request_len += p->tot_len;
+    conn->request[conn->request_len] = '\0';
+    conn->rx_us = time_us_32();
+    conn->idle_s = 0;
+    tcp_recved(tpcb, p->tot_len);
+    pbuf_free(p);
+
+    return http_conn_process(conn);
+}
+
+static err_t connection_callback(void *arg, struct tcp_pcb *newpcb, err_t err) {
+    if (err != ERR_OK || newpcb == NULL) {
+        return ERR_VAL;
+    }
+
+    for (int i = 0; i < HTTP_MAX_CONNECTIONS; i++) {
+        http_conn_t *conn = &http_conns[i];
+        if (conn->pcb) {
+            continue;
+        }
+        memset(conn, 0, sizeof(*conn));
+        conn->pcb = newpcb;
+        tcp_arg(newpcb, conn);
+        tcp_recv(newpcb, http_callback);
+        tcp_sent(newpcb, http_sent_callback);
+        tcp_poll(newpcb, http_poll_callback, 2);
+        tcp_err(newpcb, http_err_callback);
+        return ERR_OK;
+    }
+
+    printf("Limite de %d conexões HTTP, recusando\n", HTTP_MAX_CONNECTIONS);
+    return reject_busy(newpcb);
+}
+
 static void start_http_server(void) {
     struct tcp_pcb *pcb = tcp_new();
     if (!pcb) {
@@ -119,12 +1198,368 @@ static void start_http_server(void) {
     printf("Servidor HTTP iniciado na porta 80...\n");
 }
 
-int main() {
-    stdio_init_all();
+// --- Amostragem -----------------------------------------------------------
+//
+// Os callbacks do lwIP rodam em segundo plano (cyw43_arch threadsafe
+// background), fora das tarefas, então uma requisição é atendida assim que
+// chega, sem esperar a amostragem. A tarefa de sensores acorda quando há
+// eventos de botão na fila ou a cada SAMPLE_PERIOD_MS para agregar as
+// amostras do ADC (com FREERTOS_SMP, quem agrega é a tarefa do ADC no outro
+// núcleo e a tarefa de sensores só publica). Tudo que ela muda e que os callbacks leem (mensagens,
+// page_version, envio dos eventos) fica entre cyw43_arch_lwip_begin()/end().
+//
+// Botões (input.h): a interrupção de borda só anota o nível e arma um
+// alarme; o alarme confirma os pinos estáveis há BUTTON_DEBOUNCE_US, põe as
+// mudanças na fila e acorda a tarefa.
+
+static TaskHandle_t sensor_task_handle;
+static latency_t button_latency;
+
+static input_pin_t button_pins[] = {
+    {.gpio = BUTTON1_PIN, .active_low = true},
+    {.gpio = BUTTON2_PIN, .active_low = true},
+};
+static input_t buttons;
+static alarm_id_t debounce_alarm; // 0: nenhum armado
+
+static int64_t debounce_alarm_callback(alarm_id_t id, void *user_data) {
+    uint32_t head = buttons.head;
+    uint32_t next_us = input_poll(&buttons, time_us_32());
+
+    debounce_alarm = 0;
+    if (next_us) {
+        alarm_id_t alarm = add_alarm_in_us(next_us, debounce_alarm_callback, NULL, true);
+        debounce_alarm = alarm > 0 ? alarm : 0;
+    }
+    if (buttons.head != head) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(sensor_task_handle, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+    return 0;
+}
+
+static void gpio_callback(uint gpio, uint32_t events) {
+    int index = input_find(&buttons, gpio);
+    if (index < 0) {
+        return;
+    }
+    input_edge(&buttons, index, gpio_get(gpio), time_us_32());
+    if (!debounce_alarm) {
+        alarm_id_t alarm = add_alarm_in_us(BUTTON_DEBOUNCE_US, debounce_alarm_callback, NULL, true);
+        debounce_alarm = alarm > 0 ? alarm : 0;
+    }
+}
+
+static void button_changed(int n, bool pressed, uint32_t edge_us) {
+    char *message = n == 1 ? button1_message : button2_message;
+
+    cyw43_arch_lwip_begin();
+    if (n == 1) {
+        button1_pressed = pressed;
+    } else {
+        button2_pressed = pressed;
+    }
+    snprintf(message, sizeof(button1_message), "Botão %d foi %s!", n, pressed ? "pressionado" : "solto");
+    page_version++;
+    publish_event(n == 1 ? EVENT_BUTTON1 : EVENT_BUTTON2);
+    cyw43_arch_lwip_end();
 
+    printf("%s\n", message);
+    // Desde a primeira borda, incluindo o debounce
+    latency_add(&button_latency, time_us_32() - edge_us);
+    if (button_latency.count % LATENCY_REPORT_EVERY == 0) {
+        latency_report(&button_latency, "Botao -> evento");
+    }
+}
+
+// --- ADC contínuo ---------------------------------------------------------
+//
+// O ADC converte sem parar a ADC_SAMPLE_HZ e um canal de DMA copia cada
+// resultado do FIFO para adc_ring, voltando ao começo sozinho (ring no
+// endereço de escrita). Não há interrupção por amostra: a tarefa de sensores
+// lê o que chegou desde a última vez pela posição de escrita do DMA e
+// agrega em inteiros (adc_stats.h).
+
+#define ADC_RING_SAMPLES ((1u << ADC_RING_BITS) / sizeof(uint16_t))
+
+static uint16_t adc_ring[ADC_RING_SAMPLES] __attribute__((aligned(1u << ADC_RING_BITS)));
+static int adc_dma_channel;
+static uint32_t adc_read_index;
+static adc_window_t adc_window;
+static adc_ema_t adc_ema;
+
+_Static_assert(ADC_WINDOW_SAMPLES <= ADC_WINDOW_MAX_SAMPLES, "janela grande demais para a média em Q8");
+
+static void adc_sampler_start(void) {
     adc_init();
     adc_set_temp_sensor_enabled(true);
     adc_select_input(4);
+    // FIFO com DREQ a cada amostra, sem bit de erro, 12 bits
+    adc_fifo_setup(true, true, 1, false, false);
+    // Uma conversão a cada (1 + div) ciclos do clock de 48 MHz do ADC
+    adc_set_clkdiv(48000000.0f / ADC_SAMPLE_HZ - 1);
+
+    adc_dma_channel = dma_claim_unused_channel(true);
+    dma_channel_config config = dma_channel_get_default_config(adc_dma_channel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_16);
+    channel_config_set_read_increment(&config, false);
+    channel_config_set_write_increment(&config, true);
+    channel_config_set_ring(&config, true, ADC_RING_BITS);
+    channel_config_set_dreq(&config, DREQ_ADC);
+    dma_channel_configure(adc_dma_channel, &config, adc_ring, &adc_hw->fifo, UINT32_MAX, true);
+
+    adc_window_reset(&adc_window);
+    adc_ema_init(&adc_ema, ADC_EMA_SHIFT);
+    adc_run(true);
+}
+
+// Temperatura em m°C como texto com duas casas, com '\0'
+static void format_temperature(char *buf, int32_t milli) {
+    buf[fixed_format_milli(buf, milli, 2)] = '\0';
+}
+
+// Temperatura pronta para publicar, já no texto da página
+typedef struct {
+    uint32_t seq; // conta as leituras (FREERTOS_SMP)
+    char message[sizeof(temperature_message)];
+    char media[16];
+} temperature_reading_t;
+
+// Converte a janela e a EMA e formata; false se a variação foi pequena
+static bool format_temperature_reading(const adc_window_t *window, const adc_ema_t *ema,
+                                       temperature_reading_t *reading) {
+    static int32_t temperatura_anterior = 0;
+
+    // Mais tensão, menos temperatura: o máximo em contagens é o mínimo em °C
+    int32_t temperatura = fixed_linear_milli(&temperature_line, ema->value_q16);
+    int32_t minima = fixed_linear_milli(&temperature_line, (uint32_t)window->max << 16);
+    int32_t maxima = fixed_linear_milli(&temperature_line, (uint32_t)window->min << 16);
+
+    if (abs(temperatura - temperatura_anterior) < LIMIAR_VARIACAO_TEMPERATURA) {
+        return false;
+    }
+    temperatura_anterior = temperatura;
+
+    char atual[16], min[16], max[16];
+    format_temperature(atual, temperatura);
+    format_temperature(min, minima);
+    format_temperature(max, maxima);
+    format_temperature(reading->media, fixed_linear_milli(&temperature_line, adc_window_mean_q8(window) << 8));
+    snprintf(reading->message, sizeof(reading->message), "Temperatura: %s°C (min %s, max %s)", atual, min, max);
+    return true;
+}
+
+static void publish_temperature(const temperature_reading_t *reading) {
+    cyw43_arch_lwip_begin();
+    memcpy(temperature_message, reading->message, sizeof(temperature_message));
+    page_version++;
+    publish_event(EVENT_TEMPERATURE);
+    cyw43_arch_lwip_end();
+
+    printf("%s, media %s°C\n", temperature_message, reading->media);
+}
+
+#if configNUMBER_OF_CORES > 1
+// --- Tarefa do ADC -------------------------------------------------------
+//
+// Com FREERTOS_SMP o kernel escala nos dois núcleos. A tarefa do ADC, presa
+// ao ADC_CORE, não chama nada do lwIP: a cada SAMPLE_PERIOD_MS agrega o anel
+// do ADC e, quando uma janela fecha, deixa a leitura formatada em
+// temperature_shared e notifica a tarefa de sensores, presa ao NETWORK_CORE,
+// que publica. A cópia fica numa seção crítica do kernel, que no SMP segura
+// os spinlocks do RTOS e vale para os dois núcleos.
+
+static TaskHandle_t adc_task_handle;
+static temperature_reading_t temperature_shared; // em seção crítica
+static uint32_t temperature_seen; // última seq publicada (tarefa de sensores)
+
+// Tarefa do ADC
+static void temperature_ready(const temperature_reading_t *reading) {
+    taskENTER_CRITICAL();
+    uint32_t seq = temperature_shared.seq + 1;
+    temperature_shared = *reading;
+    temperature_shared.seq = seq;
+    taskEXIT_CRITICAL();
+
+    xTaskNotifyGive(sensor_task_handle);
+}
+
+// Tarefa de sensores: publica se a tarefa do ADC deixou leitura nova
+static void temperature_poll(void) {
+    temperature_reading_t reading;
+
+    taskENTER_CRITICAL();
+    reading = temperature_shared;
+    taskEXIT_CRITICAL();
+
+    if (reading.seq != temperature_seen) {
+        temperature_seen = reading.seq;
+        publish_temperature(&reading);
+    }
+}
+#else
+static void temperature_ready(const temperature_reading_t *reading) {
+    publish_temperature(reading);
+}
+#endif
+
+#if FIXED_POINT_BENCHMARK
+// Caminho antigo, só para comparar
+static float converte_temperatura(float contagem) {
+    /* Conversão de 12-bit, valor máximo = ADC_VREF = 3.3V */
+    const float fator_conversao = 3.3f / (1 << 12);
+
+    float adc = contagem * fator_conversao;
+    return 27.0f - (adc - 0.706f) / 0.001721f;
+}
+
+static void fixed_point_benchmark(void) {
+    const int iterations = 1000;
+    uint32_t mhz = clock_get_hz(clk_sys) / 1000000;
+    char buf[32];
+    volatile uint32_t sink = 0;
+
+    uint32_t start = time_us_32();
+    for (int i = 0; i < iterations; i++) {
+        float t = converte_temperatura((800 + i % 64) + (i % 16) / 16.0f);
+        sink += snprintf(buf, sizeof(buf), "%.2f", t);
+    }
+    uint32_t float_cycles = (time_us_32() - start) * mhz / iterations;
+
+    start = time_us_32();
+    for (int i = 0; i < iterations; i++) {
+        int32_t t = fixed_linear_milli(&temperature_line, ((800u + i % 64) << 16) + ((i % 16u) << 12));
+        sink += fixed_format_milli(buf, t, 2);
+    }
+    uint32_t fixed_cycles = (time_us_32() - start) * mhz / iterations;
+
+    printf("Conversao + formatacao: float %lu ciclos, ponto fixo %lu ciclos\n", float_cycles, fixed_cycles);
+}
+#endif
+
+// Agrega as amostras novas do anel; fecha a janela a cada ADC_WINDOW_SAMPLES
+static void adc_sampler_update(void) {
+    // Com UINT32_MAX transferências isso leva semanas, mas o canal para
+    // quando a contagem acaba
+    if (!dma_channel_is_busy(adc_dma_channel)) {
+        dma_channel_set_trans_count(adc_dma_channel, UINT32_MAX, true);
+    }
+
+    uintptr_t write_addr = dma_channel_hw_addr(adc_dma_channel)->write_addr;
+    uint32_t write_index = (uint32_t)((uint16_t *)write_addr - adc_ring);
+
+    while (adc_read_index != write_index) {
+        // Até o fim do anel ou até a posição de escrita, sem passar da janela
+        uint32_t end = write_index > adc_read_index ? write_index : ADC_RING_SAMPLES;
+        uint32_t count = end - adc_read_index;
+        if (count > ADC_WINDOW_SAMPLES - adc_window.count) {
+            count = ADC_WINDOW_SAMPLES - adc_window.count;
+        }
+
+        adc_window_add(&adc_window, &adc_ring[adc_read_index], count);
+        adc_ema_add(&adc_ema, &adc_ring[adc_read_index], count);
+        adc_read_index = (adc_read_index + count) % ADC_RING_SAMPLES;
+
+        if (adc_window.count == ADC_WINDOW_SAMPLES) {
+            temperature_reading_t reading;
+            if (format_temperature_reading(&adc_window, &adc_ema, &reading)) {
+                temperature_ready(&reading);
+            }
+            adc_window_reset(&adc_window);
+        }
+    }
+}
+
+static void sensor_task(void *arg) {
+    TickType_t next_sample = xTaskGetTickCount();
+
+    bool levels[2];
+    for (size_t i = 0; i < 2; i++) {
+        levels[i] = gpio_get(button_pins[i].gpio);
+    }
+    input_init(&buttons, button_pins, 2, BUTTON_DEBOUNCE_US, levels);
+    gpio_set_irq_enabled_with_callback(BUTTON1_PIN, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true, gpio_callback);
+    gpio_set_irq_enabled(BUTTON2_PIN, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true);
+
+    while (true) {
+        TickType_t now = xTaskGetTickCount();
+        TickType_t wait = (int32_t)(next_sample - now) > 0 ? next_sample - now : 0;
+        ulTaskNotifyTake(pdTRUE, wait);
+
+        input_event_t event;
+        while (input_pop(&buttons, &event)) {
+            button_changed(event.index + 1, event.pressed, event.time_us);
+        }
+#if configNUMBER_OF_CORES > 1
+        temperature_poll();
+#endif
+
+        if ((int32_t)(xTaskGetTickCount() - next_sample) >= 0) {
+            next_sample += pdMS_TO_TICKS(SAMPLE_PERIOD_MS);
+#if configNUMBER_OF_CORES == 1
+            adc_sampler_update();
+#endif
+
+            cyw43_arch_lwip_begin();
+            sse_poll();
+            cyw43_arch_lwip_end();
+        }
+    }
+}
+
+#if CONTEXT_SWITCH_BENCHMARK
+#define CONTEXT_SWITCH_ROUNDS 10000
+
+static TaskHandle_t switch_high_handle;
+static TaskHandle_t switch_low_handle;
+
+// Prioridade mais alta: só acorda e volta a esperar
+static void switch_high_task(void *arg) {
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+}
+
+// Prioridade 1: cada notificação põe a tarefa alta para rodar e, quando ela
+// bloqueia, o scheduler procura a próxima pronta a partir do topo. São duas
+// trocas por volta, com a notificação incluída.
+static void switch_low_task(void *arg) {
+    uint32_t mhz = clock_get_hz(clk_sys) / 1000000;
+
+    uint32_t start = time_us_32();
+    for (int i = 0; i < CONTEXT_SWITCH_ROUNDS; i++) {
+        xTaskNotifyGive(switch_high_handle);
+    }
+    uint32_t elapsed = time_us_32() - start;
+
+    printf("Troca de contexto: %lu ciclos (configMAX_PRIORITIES %d, selecao %s)\n",
+           elapsed * mhz / (2 * CONTEXT_SWITCH_ROUNDS), configMAX_PRIORITIES,
+           configUSE_PORT_OPTIMISED_TASK_SELECTION ? "por mapa de bits" : "linear");
+
+    vTaskDelete(switch_high_handle);
+    vTaskDelete(NULL);
+}
+#endif
+
+#if configNUMBER_OF_CORES > 1
+static void adc_task(void *arg) {
+    TickType_t last_wake = xTaskGetTickCount();
+
+    while (true) {
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(SAMPLE_PERIOD_MS));
+        adc_sampler_update();
+    }
+}
+#endif
+
+int main() {
+    stdio_init_all();
+
+    adc_sampler_start();
+#if FIXED_POINT_BENCHMARK
+    fixed_point_benchmark();
+#endif
 
     printf("Iniciando servidor HTTP\n");
 
@@ -152,51 +1587,33 @@ int main() {
     gpio_set_dir(BUTTON2_PIN, GPIO_IN);
     gpio_pull_up(BUTTON2_PIN);
 
+    page_boot_id = get_rand_32();
+    cyw43_arch_lwip_begin();
     start_http_server();
+    cyw43_arch_lwip_end();
 
-    static bool button1_last_state = false;
-    static bool button2_last_state = false;
-    static float temperatura_anterior = 0;
+    // Acima da idle: os botões não esperam nada além dos callbacks de rede
+    TASK_CREATE(sensor_task, "sensor task", 2048, NULL, 2, &sensor_task_handle);
+#if configNUMBER_OF_CORES > 1
+    // A tarefa de sensores usa o lwIP e liga as interrupções dos botões e o
+    // alarme do debounce no núcleo em que roda, que tem de ser o da rede
+    vTaskCoreAffinitySet(sensor_task_handle, 1 << NETWORK_CORE);
+    TASK_CREATE(adc_task, "adc task", 1024, NULL, 2, &adc_task_handle);
+    vTaskCoreAffinitySet(adc_task_handle, 1 << ADC_CORE);
+#endif
+#if CONTEXT_SWITCH_BENCHMARK
+    TASK_CREATE(switch_high_task, "switch high", 256, NULL, configMAX_PRIORITIES - 1, &switch_high_handle);
+    TASK_CREATE(switch_low_task, "switch low", 512, NULL, 1, &switch_low_handle);
+#if configNUMBER_OF_CORES > 1
+    // As duas no mesmo núcleo, senão a alta roda no outro sem troca nenhuma
+    vTaskCoreAffinitySet(switch_high_handle, 1 << NETWORK_CORE);
+    vTaskCoreAffinitySet(switch_low_handle, 1 << NETWORK_CORE);
+#endif
+#endif
 
-    while (true) {
-        cyw43_arch_poll();
-
-        bool button1_state = !gpio_get(BUTTON1_PIN);
-        bool button2_state = !gpio_get(BUTTON2_PIN);
-        float temperatura = ler_temperatura();
-
-        if (button1_state != button1_last_state) {
-            button1_last_state = button1_state;
-            button1_pressed = button1_state;
-            if (button1_state) {
-                snprintf(button1_message, sizeof(button1_message), "Botão 1 foi pressionado!");
-            } else {
-                snprintf(button1_message, sizeof(button1_message), "Botão 1 foi solto!");
-            }
-            printf("%s\n", button1_message);
-        }
-
-        if (button2_state != button2_last_state) {
-            button2_last_state = button2_state;
-            button2_pressed = button2_state;
-            if (button2_state) {
-                snprintf(button2_message, sizeof(button2_message), "Botão 2 foi pressionado!");
-            } else {
-                snprintf(button2_message, sizeof(button2_message), "Botão 2 foi solto!");
-            }
-            printf("%s\n", button2_message);
-        }
+    vTaskStartScheduler();
 
-        if (temperatura - temperatura_anterior >= LIMIAR_VARIACAO_TEMPERATURA) {
-            temperatura_anterior = temperatura;
-            snprintf(temperature_message, sizeof(temperature_message), "Temperatura: %.2f°C", temperatura);
-            printf("Temperatura: %s °C\n", temperatura);
-        }
-
-
-        sleep_ms(100);
-    }
-
-    cyw43_arch_deinit();
-    return 0;
+    // Nunca alcançado
+    while (true)
+        ;
 }
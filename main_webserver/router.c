@@ -0,0 +1,144 @@
+#include <string.h>
+
+#include "router.h"
+
+typedef struct {
+    const char *name;
+    uint8_t len;
+} method_name_t;
+
+static const method_name_t method_names[HTTP_METHOD_COUNT] = {
+    [HTTP_METHOD_GET] = {"GET", 3},       [HTTP_METHOD_HEAD] = {"HEAD", 4},
+    [HTTP_METHOD_POST] = {"POST", 4},     [HTTP_METHOD_PUT] = {"PUT", 3},
+    [HTTP_METHOD_DELETE] = {"DELETE", 6}, [HTTP_METHOD_PATCH] = {"PATCH", 5},
+    [HTTP_METHOD_OPTIONS] = {"OPTIONS", 7},
+};
+
+static int parse_method(const char *s, size_t len) {
+    for (int i = 0; i < HTTP_METHOD_COUNT; i++) {
+        if (method_names[i].len == len && memcmp(method_names[i].name, s, len) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Mesma ordem usada por gen_routes.py para ordenar os filhos: bytes, e o
+// mais curto antes quando um é prefixo do outro
+static int compare_segment(const router_node_t *node, const char *s, size_t len) {
+    size_t n = node->segment_len < len ? node->segment_len : len;
+    int c = memcmp(node->segment, s, n);
+    if (c != 0) {
+        return c;
+    }
+    return (int)node->segment_len - (int)len;
+}
+
+static const router_node_t *find_child(const router_table_t *table, const router_node_t *node, const char *s,
+                                       size_t len) {
+    int lo = node->first_child;
+    int hi = node->first_child + node->child_count - 1;
+
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        int c = compare_segment(&table->nodes[mid], s, len);
+        if (c == 0) {
+            return &table->nodes[mid];
+        }
+        if (c < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    if (node->param_child != ROUTER_NO_CHILD) {
+        return &table->nodes[node->param_child];
+    }
+    return NULL;
+}
+
+router_result_t router_match(const router_table_t *table, const char *request, size_t len, router_match_t *match) {
+    const char *end = request + len;
+    const char *p = request;
+
+    match->param_count = 0;
+    match->query = NULL;
+    match->query_len = 0;
+    match->route = ROUTER_NO_ROUTE;
+    match->version_minor = 0;
+
+    // Método
+    while (p < end && *p != ' ') {
+        p++;
+    }
+    int method = parse_method(request, p - request);
+    if (method < 0 || p == end) {
+        return ROUTER_BAD_REQUEST;
+    }
+    match->method = (http_method_t)method;
+
+    // Caminho, até o espaço antes da versão
+    const char *path = ++p;
+    if (p == end || *p != '/') {
+        return ROUTER_BAD_REQUEST;
+    }
+    while (p < end && *p != ' ' && *p != '?' && *p != '\r' && *p != '\n') {
+        p++;
+    }
+    const char *path_end = p;
+    match->path = path;
+    match->path_len = path_end - path;
+    if (p < end && *p == '?') {
+        match->query = ++p;
+        while (p < end && *p != ' ' && *p != '\r' && *p != '\n') {
+            p++;
+        }
+        match->query_len = p - match->query;
+    }
+
+    // Versão: só o token depois do caminho, nunca o resto do cabeçalho
+    if (end - p >= 9 && memcmp(p, " HTTP/1.", 8) == 0 && p[8] >= '0' && p[8] <= '9') {
+        match->version_minor = p[8] - '0';
+    }
+
+    // Um segmento por nível da árvore; barras repetidas ou no fim são ignoradas
+    const router_node_t *node = &table->nodes[0];
+    for (const char *s = path; node != NULL && s < path_end;) {
+        while (s < path_end && *s == '/') {
+            s++;
+        }
+        if (s == path_end) {
+            break;
+        }
+        const char *segment_end = s;
+        while (segment_end < path_end && *segment_end != '/') {
+            segment_end++;
+        }
+
+        node = find_child(table, node, s, segment_end - s);
+        if (node != NULL && node->segment == NULL) {
+            // Filho ":param"
+            if (match->param_count == ROUTER_MAX_PARAMS) {
+                return ROUTER_NOT_FOUND;
+            }
+            match->params[match->param_count].data = s;
+            match->params[match->param_count].len = segment_end - s;
+            match->param_count++;
+        }
+        s = segment_end;
+    }
+    if (node == NULL) {
+        return ROUTER_NOT_FOUND;
+    }
+
+    match->route = node->route[method];
+    if (match->route != ROUTER_NO_ROUTE) {
+        return ROUTER_OK;
+    }
+    for (int i = 0; i < HTTP_METHOD_COUNT; i++) {
+        if (node->route[i] != ROUTER_NO_ROUTE) {
+            return ROUTER_METHOD_NOT_ALLOWED;
+        }
+    }
+    return ROUTER_NOT_FOUND;
+}
@@ -0,0 +1,83 @@
+#ifndef ROUTER_H
+#define ROUTER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Roteamento pela linha de requisição ("GET /led/on HTTP/1.1").
+//
+// As rotas ficam em um arquivo .def (método, caminho, id) e gen_routes.py
+// transforma esse arquivo, na compilação, em uma árvore constante por
+// segmento do caminho: cada nó tem os filhos literais ordenados (busca
+// binária) e, opcionalmente, um filho ":param" que aceita qualquer
+// segmento. Um segmento literal tem prioridade sobre ":param" e a busca não
+// volta atrás: com "/led/on" e "/:x/y", "/led/y" não é encontrado. Só a
+// primeira linha da requisição é lida; cabeçalhos e corpo
+// nunca são percorridos.
+//
+//     GET  /led/:estado  LED
+//
+// vira ROUTE_LED no routes.h gerado, e "GET /led/on" devolve ROUTE_LED com
+// params[0] = "on".
+
+typedef enum {
+    HTTP_METHOD_GET,
+    HTTP_METHOD_HEAD,
+    HTTP_METHOD_POST,
+    HTTP_METHOD_PUT,
+    HTTP_METHOD_DELETE,
+    HTTP_METHOD_PATCH,
+    HTTP_METHOD_OPTIONS,
+    HTTP_METHOD_COUNT,
+} http_method_t;
+
+#define ROUTER_NO_ROUTE 0xff
+#define ROUTER_NO_CHILD 0xffff
+
+#ifndef ROUTER_MAX_PARAMS
+#define ROUTER_MAX_PARAMS 4
+#endif
+
+typedef struct {
+    const char *segment; // NULL na raiz e nos nós ":param"
+    uint8_t segment_len;
+    uint8_t child_count;     // filhos literais em [first_child, first_child + child_count)
+    uint16_t first_child;
+    uint16_t param_child;    // ROUTER_NO_CHILD se não tem
+    uint8_t route[HTTP_METHOD_COUNT]; // id da rota por método, ROUTER_NO_ROUTE se não tem
+} router_node_t;
+
+typedef struct {
+    const router_node_t *nodes; // nodes[0] é a raiz ("/")
+    uint16_t node_count;
+} router_table_t;
+
+typedef enum {
+    ROUTER_OK,
+    ROUTER_BAD_REQUEST,        // linha de requisição inválida
+    ROUTER_NOT_FOUND,          // 404
+    ROUTER_METHOD_NOT_ALLOWED, // 405: o caminho existe com outro método
+} router_result_t;
+
+typedef struct {
+    const char *data;
+    uint16_t len;
+} router_param_t;
+
+typedef struct {
+    http_method_t method;
+    uint8_t route; // id da rota (ROUTE_* do .h gerado)
+    const char *path;
+    uint16_t path_len;
+    const char *query; // depois do '?', sem ele; NULL se não tem
+    uint16_t query_len;
+    router_param_t params[ROUTER_MAX_PARAMS]; // na ordem em que aparecem no caminho
+    uint8_t param_count;
+    uint8_t version_minor; // x de "HTTP/1.x" no fim da linha; 0 sem versão reconhecida
+} router_match_t;
+
+// Lê a linha de requisição de request (len bytes, não precisa de '\0') e
+// procura a rota. Os ponteiros de match apontam para dentro de request.
+router_result_t router_match(const router_table_t *table, const char *request, size_t len, router_match_t *match);
+
+#endif
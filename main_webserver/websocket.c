@@ -0,0 +1,241 @@
+#include <string.h>
+
+#include "websocket.h"
+
+// GUID fixo da RFC 6455, concatenado à chave do cliente antes do SHA-1
+static const char ws_guid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+// --- SHA-1 ---------------------------------------------------------------
+//
+// Só é usado no handshake, uma vez por conexão.
+
+typedef struct {
+    uint32_t h[5];
+    uint8_t block[64];
+    uint32_t block_len;
+    uint64_t total_len;
+} sha1_t;
+
+static inline uint32_t rol(uint32_t x, int n) {
+    return (x << n) | (x >> (32 - n));
+}
+
+static void sha1_block(sha1_t *ctx) {
+    uint32_t w[80];
+    for (int i = 0; i < 16; i++) {
+        w[i] = ((uint32_t)ctx->block[i * 4] << 24) | ((uint32_t)ctx->block[i * 4 + 1] << 16) |
+               ((uint32_t)ctx->block[i * 4 + 2] << 8) | ctx->block[i * 4 + 3];
+    }
+    for (int i = 16; i < 80; i++) {
+        w[i] = rol(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+    }
+
+    uint32_t a = ctx->h[0], b = ctx->h[1], c = ctx->h[2], d = ctx->h[3], e = ctx->h[4];
+    for (int i = 0; i < 80; i++) {
+        uint32_t f, k;
+        if (i < 20) {
+            f = (b & c) | (~b & d);
+            k = 0x5A827999;
+        } else if (i < 40) {
+            f = b ^ c ^ d;
+            k = 0x6ED9EBA1;
+        } else if (i < 60) {
+            f = (b & c) | (b & d) | (c & d);
+            k = 0x8F1BBCDC;
+        } else {
+            f = b ^ c ^ d;
+            k = 0xCA62C1D6;
+        }
+        uint32_t t = rol(a, 5) + f + e + k + w[i];
+        e = d;
+        d = c;
+        c = rol(b, 30);
+        b = a;
+        a = t;
+    }
+    ctx->h[0] += a;
+    ctx->h[1] += b;
+    ctx->h[2] += c;
+    ctx->h[3] += d;
+    ctx->h[4] += e;
+}
+
+static void sha1_init(sha1_t *ctx) {
+    ctx->h[0] = 0x67452301;
+    ctx->h[1] = 0xEFCDAB89;
+    ctx->h[2] = 0x98BADCFE;
+    ctx->h[3] = 0x10325476;
+    ctx->h[4] = 0xC3D2E1F0;
+    ctx->block_len = 0;
+    ctx->total_len = 0;
+}
+
+static void sha1_update(sha1_t *ctx, const void *data, size_t len) {
+    const uint8_t *p = data;
+    ctx->total_len += len;
+    while (len--) {
+        ctx->block[ctx->block_len++] = *p++;
+        if (ctx->block_len == 64) {
+            sha1_block(ctx);
+            ctx->block_len = 0;
+        }
+    }
+}
+
+static void sha1_final(sha1_t *ctx, uint8_t digest[20]) {
+    uint64_t bits = ctx->total_len * 8;
+    uint8_t pad = 0x80;
+    sha1_update(ctx, &pad, 1);
+    pad = 0;
+    while (ctx->block_len != 56) {
+        sha1_update(ctx, &pad, 1);
+    }
+    for (int i = 7; i >= 0; i--) {
+        uint8_t byte = (uint8_t)(bits >> (i * 8));
+        sha1_update(ctx, &byte, 1);
+    }
+    for (int i = 0; i < 20; i++) {
+        digest[i] = (uint8_t)(ctx->h[i / 4] >> (24 - (i % 4) * 8));
+    }
+}
+
+// --- Base64 --------------------------------------------------------------
+
+static size_t base64_encode(const uint8_t *in, size_t len, char *out) {
+    static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t o = 0;
+
+    for (size_t i = 0; i < len; i += 3) {
+        uint32_t v = (uint32_t)in[i] << 16;
+        if (i + 1 < len) v |= (uint32_t)in[i + 1] << 8;
+        if (i + 2 < len) v |= in[i + 2];
+        out[o++] = table[(v >> 18) & 0x3f];
+        out[o++] = table[(v >> 12) & 0x3f];
+        out[o++] = i + 1 < len ? table[(v >> 6) & 0x3f] : '=';
+        out[o++] = i + 2 < len ? table[v & 0x3f] : '=';
+    }
+    out[o] = '\0';
+    return o;
+}
+
+void ws_accept_key(const char *key, size_t key_len, char *accept) {
+    sha1_t ctx;
+    uint8_t digest[20];
+
+    sha1_init(&ctx);
+    sha1_update(&ctx, key, key_len);
+    sha1_update(&ctx, ws_guid, sizeof(ws_guid) - 1);
+    sha1_final(&ctx, digest);
+    base64_encode(digest, sizeof(digest), accept);
+}
+
+// --- Frames --------------------------------------------------------------
+
+void ws_parser_init(ws_parser_t *parser, ws_frame_fn on_frame, void *arg) {
+    memset(parser, 0, sizeof(*parser));
+    parser->on_frame = on_frame;
+    parser->arg = arg;
+    parser->state = WS_PARSER_HEADER;
+}
+
+static bool ws_fail(ws_parser_t *parser, uint16_t code) {
+    parser->state = WS_PARSER_ERROR;
+    parser->close_code = code;
+    return false;
+}
+
+static void ws_frame_done(ws_parser_t *parser) {
+    parser->on_frame(parser, parser->opcode, parser->payload, (size_t)parser->length);
+    parser->state = WS_PARSER_HEADER;
+    parser->pos = 0;
+}
+
+// Depois do tamanho: máscara (o cliente sempre mascara) e payload
+static bool ws_length_done(ws_parser_t *parser) {
+    if (parser->length > WS_MAX_PAYLOAD) {
+        return ws_fail(parser, 1009);
+    }
+    parser->pos = 0;
+    parser->state = WS_PARSER_MASK;
+    return true;
+}
+
+bool ws_parser_execute(ws_parser_t *parser, const uint8_t *data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        uint8_t c = data[i];
+
+        switch (parser->state) {
+        case WS_PARSER_HEADER:
+            if (parser->pos == 0) {
+                // Sem fragmentação nem extensões: FIN=1 e RSV=0
+                if ((c & 0xf0) != 0x80) {
+                    return ws_fail(parser, 1003);
+                }
+                parser->opcode = c & 0x0f;
+                parser->pos = 1;
+                break;
+            }
+            parser->masked = (c & 0x80) != 0;
+            if (!parser->masked) {
+                return ws_fail(parser, 1002);
+            }
+            parser->length = c & 0x7f;
+            if (parser->length == 126 || parser->length == 127) {
+                parser->length_bytes = parser->length == 126 ? 2 : 8;
+                parser->length = 0;
+                parser->state = WS_PARSER_LENGTH;
+            } else if (!ws_length_done(parser)) {
+                return false;
+            }
+            break;
+
+        case WS_PARSER_LENGTH:
+            parser->length = (parser->length << 8) | c;
+            if (--parser->length_bytes == 0 && !ws_length_done(parser)) {
+                return false;
+            }
+            break;
+
+        case WS_PARSER_MASK:
+            parser->mask[parser->pos++] = c;
+            if (parser->pos == 4) {
+                parser->pos = 0;
+                parser->state = WS_PARSER_PAYLOAD;
+                if (parser->length == 0) {
+                    ws_frame_done(parser);
+                }
+            }
+            break;
+
+        case WS_PARSER_PAYLOAD:
+            parser->payload[parser->pos] = c ^ parser->mask[parser->pos & 3];
+            if (++parser->pos == parser->length) {
+                ws_frame_done(parser);
+            }
+            break;
+
+        case WS_PARSER_ERROR:
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t ws_frame_header(uint8_t *buf, uint8_t opcode, size_t len) {
+    buf[0] = 0x80 | opcode;
+    if (len < 126) {
+        buf[1] = (uint8_t)len;
+        return 2;
+    }
+    if (len <= 0xffff) {
+        buf[1] = 126;
+        buf[2] = (uint8_t)(len >> 8);
+        buf[3] = (uint8_t)len;
+        return 4;
+    }
+    buf[1] = 127;
+    for (int i = 0; i < 8; i++) {
+        buf[2 + i] = (uint8_t)((uint64_t)len >> (56 - i * 8));
+    }
+    return 10;
+}
@@ -0,0 +1,68 @@
+#ifndef WEBSOCKET_H
+#define WEBSOCKET_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Partes do protocolo WebSocket (RFC 6455) usadas pelo servidor: o
+// handshake de upgrade e a leitura/escrita de frames. A parte de conexões
+// fica no main.c.
+
+#define WS_OPCODE_CONTINUATION 0x0
+#define WS_OPCODE_TEXT 0x1
+#define WS_OPCODE_BINARY 0x2
+#define WS_OPCODE_CLOSE 0x8
+#define WS_OPCODE_PING 0x9
+#define WS_OPCODE_PONG 0xA
+
+// Comandos do navegador são curtos; frames maiores fecham a conexão (1009)
+#define WS_MAX_PAYLOAD 125
+
+// Cabeçalho de frame do servidor: 2 bytes + até 8 de tamanho
+#define WS_MAX_HEADER 10
+
+// "Sec-WebSocket-Accept" tem sempre 28 caracteres
+#define WS_ACCEPT_SIZE 29
+
+typedef enum {
+    WS_PARSER_HEADER,
+    WS_PARSER_LENGTH,
+    WS_PARSER_MASK,
+    WS_PARSER_PAYLOAD,
+    WS_PARSER_ERROR,
+} ws_parser_state_t;
+
+typedef struct ws_parser_ ws_parser_t;
+
+// Frame completo (payload já sem a máscara)
+typedef void (*ws_frame_fn)(ws_parser_t *parser, uint8_t opcode, const uint8_t *payload, size_t len);
+
+struct ws_parser_ {
+    ws_frame_fn on_frame;
+    void *arg;
+
+    ws_parser_state_t state;
+    uint8_t opcode;
+    bool masked;
+    uint8_t length_bytes; // bytes de tamanho estendido que faltam
+    uint64_t length;
+    uint8_t mask[4];
+    uint8_t pos;
+    uint8_t payload[WS_MAX_PAYLOAD];
+    uint16_t close_code; // motivo do erro, para o frame de close
+};
+
+// Calcula o Sec-WebSocket-Accept (com '\0') a partir do Sec-WebSocket-Key
+void ws_accept_key(const char *key, size_t key_len, char *accept);
+
+void ws_parser_init(ws_parser_t *parser, ws_frame_fn on_frame, void *arg);
+
+// Consome bytes do cliente; retorna false se a conexão deve ser fechada
+// (ver close_code)
+bool ws_parser_execute(ws_parser_t *parser, const uint8_t *data, size_t len);
+
+// Escreve o cabeçalho de um frame do servidor (sem máscara) e retorna o tamanho
+size_t ws_frame_header(uint8_t *buf, uint8_t opcode, size_t len);
+
+#endif
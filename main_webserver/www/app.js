@@ -0,0 +1,21 @@
+// A página é carregada uma vez. Comandos do LED e atualizações passam pelo
+// WebSocket; sem ele, as atualizações vêm de /events e os links do LED
+// continuam funcionando como antes.
+function atualiza(v) {
+  const el = document.getElementById(v.e);
+  if (!el) return;
+  if (v.c) el.className = v.c;
+  el.textContent = v.m;
+}
+
+const ws = new WebSocket('ws://' + location.host + '/ws');
+ws.onmessage = m => atualiza(JSON.parse(m.data));
+ws.onclose = () => {
+  new EventSource('/events').onmessage = m => atualiza(JSON.parse(m.data));
+};
+
+function led(on) {
+  if (ws.readyState !== 1) return true;
+  ws.send('led:' + on);
+  return false;
+}
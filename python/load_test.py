@@ -0,0 +1,95 @@
+# Teste de carga do main_webserver: N clientes ao mesmo tempo, cada um com
+# uma conexão keep-alive fazendo GET / em sequência.
+#
+#   python load_test.py 192.168.0.50 -c 1,4,8,12 -t 10
+#
+# Só usa a biblioteca padrão. Com mais clientes que HTTP_MAX_CONNECTIONS os
+# excedentes recebem 503 (contados como recusados).
+
+import argparse
+import http.client
+import threading
+import time
+
+
+def client(host, port, deadline, stats, lock):
+    latencies = []
+    ok = refused = errors = 0
+    conn = None
+
+    while time.perf_counter() < deadline:
+        try:
+            if conn is None:
+                conn = http.client.HTTPConnection(host, port, timeout=5)
+            start = time.perf_counter()
+            conn.request("GET", "/")
+            response = conn.getresponse()
+            response.read()
+            if response.status == 200:
+                ok += 1
+                latencies.append((time.perf_counter() - start) * 1000)
+            else:
+                refused += 1
+            if response.status != 200 or response.will_close:
+                conn.close()
+                conn = None
+                if response.status == 503:
+                    time.sleep(0.1)
+        except (OSError, http.client.HTTPException):
+            errors += 1
+            if conn is not None:
+                conn.close()
+            conn = None
+            time.sleep(0.1)
+
+    if conn is not None:
+        conn.close()
+    with lock:
+        stats["ok"] += ok
+        stats["refused"] += refused
+        stats["errors"] += errors
+        stats["latencies"].extend(latencies)
+
+
+def percentile(values, p):
+    if not values:
+        return 0.0
+    values = sorted(values)
+    return values[min(len(values) - 1, int(len(values) * p / 100))]
+
+
+def run(host, port, clients, duration):
+    stats = {"ok": 0, "refused": 0, "errors": 0, "latencies": []}
+    lock = threading.Lock()
+    deadline = time.perf_counter() + duration
+    threads = [
+        threading.Thread(target=client, args=(host, port, deadline, stats, lock))
+        for _ in range(clients)
+    ]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+
+    lat = stats["latencies"]
+    print(
+        f"{clients:3d} clientes: {stats['ok'] / duration:7.1f} req/s, "
+        f"p50 {percentile(lat, 50):6.1f} ms, p99 {percentile(lat, 99):6.1f} ms, "
+        f"recusadas {stats['refused']}, erros {stats['errors']}"
+    )
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("host")
+    parser.add_argument("--port", type=int, default=80)
+    parser.add_argument("-c", "--clients", default="1,2,4,8,12", help="níveis de concorrência")
+    parser.add_argument("-t", "--duration", type=float, default=10, help="segundos por nível")
+    args = parser.parse_args()
+
+    for clients in (int(c) for c in args.clients.split(",")):
+        run(args.host, args.port, clients, args.duration)
+
+
+if __name__ == "__main__":
+    main()
@@ -1,4 +1,5 @@
 from flask import Flask, request, render_template_string
+from werkzeug.serving import WSGIRequestHandler
 
 app = Flask(__name__)
 
@@ -26,6 +27,19 @@ def post_data():
     received_data = request.form.get("dado", "No data received")  # Access "dado" from the form data
     return "Data received", 200
 
+# Route to handle a batch of samples sent in a single POST
+# corpo: dados=v1,v2,v3 (na ordem em que foram amostrados)
+@app.route("/post_batch", methods=["POST"])
+def post_batch():
+    global received_data
+    dados = request.form.get("dados", "")
+    try:
+        valores = [int(v) for v in dados.split(",") if v]
+    except ValueError:
+        return "Invalid batch", 400
+    if valores:
+        received_data = ", ".join(str(v) for v in valores)
+    return f"{len(valores)} samples received", 200
 
 # Route to handle the GET request
 # rota que retorna uma string
@@ -43,4 +57,7 @@ def get_counter():
     return {"counter": counter}, 200
 
 if __name__ == "__main__":
+    # HTTP/1.1 permite que a pico reaproveite a mesma conexao (keep-alive)
+    # em vez de abrir uma nova a cada requisicao
+    WSGIRequestHandler.protocol_version = "HTTP/1.1"
     app.run(host="0.0.0.0", port=5000, debug=True)
@@ -0,0 +1,119 @@
+# Mede a ida e volta de comandos do LED pelo WebSocket do main_webserver.
+#
+#   python ws_bench.py 192.168.0.50 -n 500
+#
+# Só usa a biblioteca padrão. Cada comando leva um número de sequência; a
+# resposta {"e":"ack","seq":..,"us":..} traz o tempo medido na Pico.
+
+import argparse
+import base64
+import hashlib
+import json
+import os
+import socket
+import struct
+import time
+
+GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+
+
+def connect(host, port):
+    sock = socket.create_connection((host, port))
+    sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+    key = base64.b64encode(os.urandom(16)).decode()
+    sock.sendall(
+        (
+            f"GET /ws HTTP/1.1\r\n"
+            f"Host: {host}\r\n"
+            f"Upgrade: websocket\r\n"
+            f"Connection: Upgrade\r\n"
+            f"Sec-WebSocket-Key: {key}\r\n"
+            f"Sec-WebSocket-Version: 13\r\n\r\n"
+        ).encode()
+    )
+
+    response = b""
+    while b"\r\n\r\n" not in response:
+        chunk = sock.recv(1024)
+        if not chunk:
+            raise ConnectionError("conexão fechada no handshake")
+        response += chunk
+    header, rest = response.split(b"\r\n\r\n", 1)
+    expected = base64.b64encode(hashlib.sha1((key + GUID).encode()).digest())
+    if b" 101 " not in header.split(b"\r\n")[0] or expected not in header:
+        raise ConnectionError(header.decode(errors="replace"))
+    return sock, rest
+
+
+def send_text(sock, text):
+    payload = text.encode()
+    mask = os.urandom(4)
+    masked = bytes(b ^ mask[i & 3] for i, b in enumerate(payload))
+    sock.sendall(struct.pack("!BB", 0x81, 0x80 | len(payload)) + mask + masked)
+
+
+class Reader:
+    def __init__(self, sock, buffered):
+        self.sock = sock
+        self.buf = buffered
+
+    def read(self, n):
+        while len(self.buf) < n:
+            chunk = self.sock.recv(4096)
+            if not chunk:
+                raise ConnectionError("conexão fechada")
+            self.buf += chunk
+        data, self.buf = self.buf[:n], self.buf[n:]
+        return data
+
+    def frame(self):
+        b0, b1 = self.read(2)
+        length = b1 & 0x7F
+        if length == 126:
+            (length,) = struct.unpack("!H", self.read(2))
+        elif length == 127:
+            (length,) = struct.unpack("!Q", self.read(8))
+        return b0 & 0x0F, self.read(length)
+
+
+def percentile(values, p):
+    values = sorted(values)
+    return values[min(len(values) - 1, int(len(values) * p / 100))]
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("host")
+    parser.add_argument("--port", type=int, default=80)
+    parser.add_argument("-n", type=int, default=200, help="número de comandos")
+    args = parser.parse_args()
+
+    sock, rest = connect(args.host, args.port)
+    reader = Reader(sock, rest)
+    rtt_ms = []
+    device_us = []
+
+    for seq in range(args.n):
+        start = time.perf_counter()
+        send_text(sock, f"led:{seq & 1}:{seq}")
+        while True:
+            opcode, payload = reader.frame()
+            if opcode == 0x8:
+                raise ConnectionError("servidor fechou o WebSocket")
+            if opcode != 0x1:
+                continue
+            msg = json.loads(payload)
+            # Eventos de botão/temperatura podem chegar no meio
+            if msg.get("e") == "ack" and msg.get("seq") == str(seq):
+                break
+        rtt_ms.append((time.perf_counter() - start) * 1000)
+        device_us.append(msg["us"])
+
+    sock.close()
+    print(f"{args.n} comandos")
+    print(f"ida e volta: p50 {percentile(rtt_ms, 50):.2f} ms, p99 {percentile(rtt_ms, 99):.2f} ms")
+    print(f"na Pico (frame -> LED): p50 {percentile(device_us, 50)} us, p99 {percentile(device_us, 99)} us")
+
+
+if __name__ == "__main__":
+    main()